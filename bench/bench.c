@@ -0,0 +1,505 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "hal.h"
+#include "neopixel.c"
+#include "ssd1306.h"
+#include "mic_dma.h"
+#include "mic_rms.h"
+#include "whistle.h"
+#include "noise_floor.h"
+#include "level_meter.h"
+#include "led_anim.h"
+#include "audio.h"
+#include "fft.h"
+#include "spectrum.h"
+#include "adpcm.h"
+#include "decimator.h"
+#include "anim.h"
+#include "splash_anim.h"
+
+// Microbenchmarks dos caminhos quentes (DSP, LEDs e display).
+// O mesmo código roda no host (TSC ou relógio monotônico) e na placa (SysTick, em ciclos);
+// a tabela sai em TSV pela stdio, sempre com os mesmos nomes e unidades, para que
+// tools/bench_compare.py compare execuções de commits diferentes. Os tempos saem em ns e o
+// custo por item (amostra, LED) na unidade do contador, que na placa são ciclos.
+// bench/host_x86.tsv guarda uma execução de referência no host, para comparação.
+
+#if PICO_ON_DEVICE
+#include "hardware/structs/systick.h"
+#else
+#include <time.h>
+#endif
+
+#define BENCH_MAX_REPS 1000
+#define BENCH_PASS_INTERVAL_MS 10000 // Na placa, a tabela é repetida para quem conectar depois
+
+#define LED_PIN 7
+#define LED_COUNT 25
+#define I2C_SDA 14
+#define I2C_SCL 15
+
+// Um caso: 'pre' prepara cada amostra fora da medição; 'run' é chamada 'inner' vezes por amostra
+// e trata 'items' itens por chamada (amostras do áudio, LEDs), para o custo por item
+typedef struct {
+    const char *name;
+    void (*pre)(void);
+    void (*run)(void);
+    uint inner;
+    uint items;
+    uint warmup;
+    uint reps;
+} bench_case_t;
+
+static uint32_t bench_samples[BENCH_MAX_REPS];
+
+// ---------------------------------------------------------------------------
+// Contador: ciclos do SysTick na placa (24 bits, decrescente); no host, o TSC nos x86
+// (ciclos na frequência nominal) ou, nos outros, ns
+
+#if PICO_ON_DEVICE
+#define BENCH_COUNTER "cycles"
+
+static void bench_ticks_init(void) {
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Liga, clock do processador, sem interrupção
+}
+
+static inline uint32_t bench_ticks(void) {
+    return (0x00FFFFFF - systick_hw->cvr) & 0x00FFFFFF;
+}
+
+static inline uint32_t bench_elapsed(uint32_t start, uint32_t end) {
+    return (end - start) & 0x00FFFFFF; // Até 2^24 ciclos (134 ms a 125 MHz)
+}
+
+static uint32_t bench_ticks_per_us(void) {
+    return hal_sys_clock_hz() / 1000000;
+}
+
+static const char *bench_platform(void) {
+    return "rp2040";
+}
+
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_COUNTER "tsc"
+
+static uint32_t bench_tsc_per_us;
+
+// Frequência do TSC medida contra o relógio monotônico (~20 ms)
+static void bench_ticks_init(void) {
+    struct timespec t0, t1;
+    uint64_t c0, c1;
+    int64_t ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    c0 = __rdtsc();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        ns = (t1.tv_sec - t0.tv_sec) * 1000000000ll + (t1.tv_nsec - t0.tv_nsec);
+    } while (ns < 20000000);
+    c1 = __rdtsc();
+    bench_tsc_per_us = (c1 - c0) * 1000 / ns;
+}
+
+static inline uint32_t bench_ticks(void) {
+    return (uint32_t)__rdtsc();
+}
+
+static inline uint32_t bench_elapsed(uint32_t start, uint32_t end) {
+    return end - start;
+}
+
+static uint32_t bench_ticks_per_us(void) {
+    return bench_tsc_per_us;
+}
+
+static const char *bench_platform(void) {
+    return "host";
+}
+
+#else
+#define BENCH_COUNTER "ns"
+
+static void bench_ticks_init(void) {
+}
+
+static inline uint32_t bench_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000000ull + ts.tv_nsec);
+}
+
+static inline uint32_t bench_elapsed(uint32_t start, uint32_t end) {
+    return end - start;
+}
+
+static uint32_t bench_ticks_per_us(void) {
+    return 1000;
+}
+
+static const char *bench_platform(void) {
+    return "host";
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Entradas determinísticas (a mesma sequência em todas as execuções)
+
+static uint16_t bench_block[MIC_DMA_BLOCK_SAMPLES];
+static mic_rms_acc_t bench_acc;
+static mic_rms_window_t bench_window;
+static whistle_detector_t bench_whistle;
+static noise_floor_t bench_floor;
+static level_meter_t bench_meter;
+static uint8_t bench_intensity;
+static volatile uint32_t bench_sink; // Impede que o compilador descarte os resultados
+static uint8_t ssd[ssd1306_buffer_length];
+static fft_complex_t bench_fft[FFT_SIZE];
+static uint8_t bench_bars[SPECTRUM_BARS];
+static spectrum_view_t bench_view;
+static adpcm_state_t bench_adpcm;
+static uint8_t bench_adpcm_out[MIC_DMA_BLOCK_SAMPLES / 2];
+static uint16_t bench_raw[MIC_DMA_BLOCK_SAMPLES * DECIMATOR_RATIO];
+static uint16_t bench_decimated[MIC_DMA_BLOCK_SAMPLES];
+static decimator_t bench_decimator;
+static uint bench_frame;
+static led_anim_frame_t bench_keyframes[2];
+static led_anim_t bench_led_anim;
+
+static uint32_t bench_rand_state = 0x2545F491;
+
+static uint32_t bench_rand(void) {
+    uint32_t x = bench_rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return bench_rand_state = x;
+}
+
+// Tom de 2 kHz com ruído, em torno do meio da escala do ADC, na taxa do áudio e sobreamostrado
+static void bench_fill_block(void) {
+    for (uint i = 0; i < MIC_DMA_BLOCK_SAMPLES; i++) {
+        int32_t v = 2048 + (int32_t)(600 * sinf(2 * (float)M_PI * 2000 * i / AUDIO_SAMPLE_RATE)) + (int32_t)(bench_rand() % 64) - 32;
+        bench_block[i] = v;
+    }
+    for (uint i = 0; i < count_of(bench_raw); i++) {
+        int32_t v = 2048 + (int32_t)(600 * sinf(2 * (float)M_PI * 2000 * i / (AUDIO_SAMPLE_RATE * DECIMATOR_RATIO))) + (int32_t)(bench_rand() % 64) - 32;
+        bench_raw[i] = v;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Kernels
+
+static void run_rms_accumulate(void) {
+    bench_acc.count = bench_acc.sum = 0;
+    bench_acc.sumsq = 0;
+    mic_rms_accumulate(&bench_acc, bench_block, MIC_DMA_BLOCK_SAMPLES);
+    bench_sink = bench_acc.sum;
+}
+
+static void run_rms_window_push(void) {
+    bench_sink = mic_rms_window_push(&bench_window, bench_block, MIC_DMA_BLOCK_SAMPLES);
+}
+
+static void run_whistle_process(void) {
+    bench_sink = whistle_process(&bench_whistle, bench_block, MIC_DMA_BLOCK_SAMPLES);
+}
+
+static void run_noise_floor(void) {
+    noise_floor_update(&bench_floor, bench_rand() & 0x3FF, 2048u << 4, false);
+    bench_sink = noise_floor_excess_q4(&bench_floor, bench_rand() & 0x3FF);
+}
+
+// Medidor de nível com a quantização dos LEDs, como no core de áudio (RMS Q4 de até 4095 contagens)
+static void run_level_meter(void) {
+    int32_t db = level_meter_update(&bench_meter, bench_rand() & 0xFFFF);
+    bench_intensity = level_meter_quantize_hysteresis(db, LEVEL_METER_DB(18), LEVEL_METER_DB(6), 5, bench_intensity, 384);
+    bench_sink = bench_intensity;
+}
+
+// A FFT trabalha no lugar: recarrega o bloco janelado antes de cada amostra
+static void pre_fft(void) {
+    fft_load_hann(bench_fft, bench_block, 2048);
+}
+
+static void run_fft(void) {
+    fft_q15(bench_fft, FFT_LOG2_SIZE);
+    bench_sink = bench_fft[8].re;
+}
+
+static void run_spectrum_compute(void) {
+    spectrum_compute(bench_fft, bench_bars);
+    bench_sink = bench_bars[0];
+}
+
+static void run_spectrum_render(void) {
+    spectrum_view_push(&bench_view, bench_bars);
+    spectrum_render(&bench_view, ssd);
+}
+
+// Um bloco do ADC sobreamostrado até as 256 amostras de áudio
+static void run_decimate(void) {
+    bench_sink = decimator_process(&bench_decimator, bench_raw, count_of(bench_raw), 1, bench_decimated);
+}
+
+static void run_adpcm_encode(void) {
+    adpcm_encode_adc(&bench_adpcm, bench_block, MIC_DMA_BLOCK_SAMPLES, bench_adpcm_out);
+    bench_sink = bench_adpcm_out[0];
+}
+
+// Um quadro inteiro da matriz: 25 chamadas
+static void run_np_set_frame(void) {
+    for (uint i = 0; i < LED_COUNT; i++) {
+        npSetLED(i, i, bench_frame, 255 - i);
+    }
+}
+
+// O npSetLED() anterior ao formato do fio (user-006), como referência: inverte os bits de cada
+// cor e guarda três bytes por pixel
+static uint8_t bench_legacy_leds[LED_COUNT][3];
+
+static void np_set_legacy(uint index, uint8_t r, uint8_t g, uint8_t b) {
+    r = ((r & 0xF0) >> 4) | ((r & 0x0F) << 4);
+    r = ((r & 0xCC) >> 2) | ((r & 0x33) << 2);
+    r = ((r & 0xAA) >> 1) | ((r & 0x55) << 1);
+    g = ((g & 0xF0) >> 4) | ((g & 0x0F) << 4);
+    g = ((g & 0xCC) >> 2) | ((g & 0x33) << 2);
+    g = ((g & 0xAA) >> 1) | ((g & 0x55) << 1);
+    b = ((b & 0xF0) >> 4) | ((b & 0x0F) << 4);
+    b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2);
+    b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1);
+    bench_legacy_leds[index][0] = g;
+    bench_legacy_leds[index][1] = r;
+    bench_legacy_leds[index][2] = b;
+}
+
+static void run_np_set_legacy(void) {
+    for (uint i = 0; i < LED_COUNT; i++) {
+        np_set_legacy(i, i, bench_frame, 255 - i);
+    }
+}
+
+// Quadro da animação dos LEDs no meio de uma transição (o custo não depende do desenho)
+static void run_led_anim(void) {
+    led_anim_set_level(&bench_led_anim, (bench_frame++ >> 4) & 1);
+    led_anim_render(&bench_led_anim, leds);
+}
+
+// Espera o envio anterior e troca o conteúdo, para que npWrite() não descarte o quadro
+static void pre_np_write_changed(void) {
+    while (npIsBusy()) {
+        hal_wait_for_event();
+    }
+    bench_frame++;
+    run_np_set_frame();
+}
+
+static void pre_np_wait(void) {
+    while (npIsBusy()) {
+        hal_wait_for_event();
+    }
+}
+
+static void run_np_write(void) {
+    npWrite();
+}
+
+static void run_draw_string(void) {
+    ssd1306_draw_string(ssd, 5, 24, "Pressao: 00:05");
+}
+
+// Mesmo texto com o layout pronto, e fora do alinhamento das páginas
+static ssd1306_text_t bench_text;
+
+static void pre_draw_text(void) {
+    ssd1306_text_layout(&bench_text, "Pressao: 00:05");
+}
+
+static void run_draw_text(void) {
+    ssd1306_draw_text(ssd, 5, 24, &bench_text);
+}
+
+static void run_draw_string_y27(void) {
+    ssd1306_draw_string(ssd, 5, 27, "Pressao: 00:05");
+}
+
+// Contagem em dígitos grandes, como em update_timer_display()
+static void run_draw_digits(void) {
+    ssd1306_draw_string_scaled(ssd, 19, 30, "02:59", 3);
+}
+
+// Um quadro da abertura decodificado no framebuffer (quase todos são deltas)
+static anim_player_t bench_anim;
+static uint32_t bench_anim_ms;
+
+static void run_anim_frame(void) {
+    if (!bench_anim.anim) {
+        anim_player_init(&bench_anim, &splash_anim, ssd, true);
+    }
+    bench_anim_ms += splash_anim.frame_ms;
+    anim_player_update(&bench_anim, bench_anim_ms);
+}
+
+// Quadro da tela do timer redesenhado do zero, como em update_timer_display()
+static void run_draw_screen(void) {
+    ssd1306_clear(ssd);
+    ssd1306_draw_string(ssd, 5, 0, "Press B Voltar");
+    ssd1306_draw_string(ssd, 5, 14, "Restam");
+    ssd1306_draw_string_scaled(ssd, 19, 30, "02:59", 3);
+}
+
+// Só os segundos mudam: o caso típico do tique da interface
+static void pre_flush_digit(void) {
+    char digit[2] = { '0' + bench_frame++ % 10, 0 };
+
+    ssd1306_flush_wait();
+    ssd1306_draw_string(ssd, 104, 24, digit);
+}
+
+static void pre_flush_full(void) {
+    ssd1306_flush_wait();
+    bench_frame++;
+    for (uint i = 0; i < ssd1306_buffer_length; i++) {
+        ssd[i] = bench_rand();
+    }
+    ssd1306_invalidate();
+}
+
+static void run_flush(void) {
+    ssd1306_flush(ssd);
+}
+
+static struct render_area bench_area = {
+    .start_column = 0,
+    .end_column = ssd1306_width - 1,
+    .start_page = 0,
+    .end_page = ssd1306_n_pages - 1,
+};
+
+static void run_render_on_display(void) {
+    render_on_display(ssd, &bench_area);
+}
+
+static const bench_case_t bench_cases[] = {
+    { "mic_rms_accumulate_256",  NULL,                 run_rms_accumulate,    1,  256,  20, 1000 },
+    { "mic_rms_window_push_256", NULL,                 run_rms_window_push,   1,  256,  20, 1000 },
+    { "whistle_process_256",     NULL,                 run_whistle_process,   1,  256,  20, 1000 },
+    { "fft_load_hann_256",       NULL,                 pre_fft,               1,  256,  20, 1000 },
+    { "fft_q15_256",             pre_fft,              run_fft,               1,  256,  20, 1000 },
+    { "spectrum_compute",        NULL,                 run_spectrum_compute,  1,  1,    20, 1000 },
+    { "spectrum_render",         NULL,                 run_spectrum_render,   1,  1,    20, 1000 },
+    { "decimate_2048",           NULL,                 run_decimate,          1,  2048, 20, 1000 },
+    { "adpcm_encode_256",        NULL,                 run_adpcm_encode,      1,  256,  20, 1000 },
+    { "noise_floor_update",      NULL,                 run_noise_floor,       16, 1,    20, 1000 },
+    { "level_meter_update",      NULL,                 run_level_meter,       16, 1,    20, 1000 },
+    { "npSetLED_x25",            NULL,                 run_np_set_frame,      1,  25,   20, 1000 },
+    { "npSetLED_x25_legacy",     NULL,                 run_np_set_legacy,     1,  25,   20, 1000 },
+    { "led_anim_render",         NULL,                 run_led_anim,          1,  25,   20, 1000 },
+    { "npWrite_changed",         pre_np_write_changed, run_np_write,          1,  1,    5,  200 },
+    { "npWrite_unchanged",       pre_np_wait,          run_np_write,          1,  1,    5,  200 },
+    { "ssd1306_draw_string_14",  NULL,                 run_draw_string,       1,  1,    20, 1000 },
+    { "ssd1306_draw_text_14",    pre_draw_text,        run_draw_text,         1,  1,    20, 1000 },
+    { "ssd1306_draw_string_y27", NULL,                 run_draw_string_y27,   1,  1,    20, 1000 },
+    { "ssd1306_draw_digits_3x",  NULL,                 run_draw_digits,       1,  1,    20, 1000 },
+    { "anim_splash_frame",       NULL,                 run_anim_frame,        1,  1,    20, 1000 },
+    { "ssd1306_draw_screen",     NULL,                 run_draw_screen,       1,  1,    20, 1000 },
+    { "ssd1306_flush_digit",     pre_flush_digit,      run_flush,             1,  1,    5,  200 },
+    { "ssd1306_flush_full",      pre_flush_full,       run_flush,             1,  1,    5,  200 },
+    { "render_on_display_full",  ssd1306_flush_wait,   run_render_on_display, 1,  1,    2,  20 },
+};
+
+// ---------------------------------------------------------------------------
+// Estatística
+
+static int bench_compare(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+// Converte contagens do contador por amostra em ns por chamada
+static uint32_t bench_ns(uint64_t ticks, uint inner) {
+    return ticks * 1000 / bench_ticks_per_us() / inner;
+}
+
+static void bench_run(const bench_case_t *c) {
+    uint reps = c->reps < BENCH_MAX_REPS ? c->reps : BENCH_MAX_REPS;
+    uint64_t total = 0;
+
+    for (uint i = 0; i < c->warmup; i++) {
+        if (c->pre) c->pre();
+        for (uint j = 0; j < c->inner; j++) c->run();
+    }
+
+    for (uint i = 0; i < reps; i++) {
+        if (c->pre) c->pre();
+
+        uint32_t start = bench_ticks();
+        for (uint j = 0; j < c->inner; j++) c->run();
+        bench_samples[i] = bench_elapsed(start, bench_ticks());
+        total += bench_samples[i];
+    }
+
+    qsort(bench_samples, reps, sizeof(bench_samples[0]), bench_compare);
+
+    // A última coluna fica na unidade do contador (counter= no cabeçalho): ciclos por amostra
+    printf("%s\t%u\t%u\t%lu\t%lu\t%lu\t%lu\t%.1f\n", c->name, reps, c->inner,
+           (unsigned long)bench_ns(bench_samples[reps / 2], c->inner),
+           (unsigned long)bench_ns(bench_samples[(reps * 99) / 100], c->inner),
+           (unsigned long)bench_ns(bench_samples[0], c->inner),
+           (unsigned long)bench_ns(total / reps, c->inner),
+           (double)bench_samples[reps / 2] / c->inner / c->items);
+}
+
+static void bench_run_all(uint pass) {
+    printf("# sacd-bench v2 platform=%s clock_hz=%lu counter=%s pass=%u\n", bench_platform(),
+           (unsigned long)hal_sys_clock_hz(), BENCH_COUNTER, pass);
+    printf("name\treps\tinner\tmedian_ns\tp99_ns\tmin_ns\tmean_ns\tmedian_per_item\n");
+
+    for (uint i = 0; i < count_of(bench_cases); i++) {
+        bench_run(&bench_cases[i]);
+    }
+    printf("# end\n");
+}
+
+int main() {
+#if !PICO_ON_DEVICE
+    // Simulador sem arquivos de saída e sem fim de tempo virtual
+    setenv("SACD_OUT", "", 0);
+    setenv("SACD_SIM_MS", "0", 0);
+#endif
+
+    hal_stdio_init();
+    hal_i2c_init(ssd1306_i2c_bus, I2C_SDA, I2C_SCL, ssd1306_i2c_clock * 1000);
+    ssd1306_init();
+    calculate_render_area_buffer_length(&bench_area);
+    npInit(LED_PIN, LED_COUNT);
+
+    mic_rms_window_init(&bench_window);
+    whistle_init(&bench_whistle, AUDIO_SAMPLE_RATE);
+    noise_floor_init(&bench_floor);
+    level_meter_init(&bench_meter, &(level_meter_config_t)LEVEL_METER_PPM);
+    for (uint i = 0; i < LED_ANIM_PIXELS; i++) {
+        bench_keyframes[1][i][0] = bench_keyframes[1][i][2] = i * 10;
+    }
+    led_anim_init(&bench_led_anim, bench_keyframes, 2, 24);
+    bench_fill_block();
+    bench_ticks_init();
+
+#if PICO_ON_DEVICE
+    // Repete a tabela: a USB só aparece alguns segundos depois do boot
+    for (uint pass = 0; ; pass++) {
+        hal_sleep_ms(BENCH_PASS_INTERVAL_MS);
+        bench_run_all(pass);
+    }
+#else
+    bench_run_all(0);
+#endif
+
+    return 0;
+}
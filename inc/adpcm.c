@@ -0,0 +1,91 @@
+#include "adpcm.h"
+
+#define ADPCM_ADC_MIDSCALE 2048 // Polarização do microfone (meio da escala de 12 bits)
+
+// Tabelas padrão do IMA-ADPCM
+static const int16_t adpcm_steps[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+    34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+};
+
+static const int8_t adpcm_index_change[8] = { -1, -1, -1, -1, 2, 4, 6, 8 };
+
+void adpcm_init(adpcm_state_t *state) {
+    state->predictor = 0;
+    state->index = 0;
+}
+
+// Reconstrói a amostra a partir do código, exatamente como o decodificador
+static int16_t adpcm_update(adpcm_state_t *state, uint8_t code) {
+    int32_t step = adpcm_steps[state->index];
+    int32_t diff = step >> 3;
+
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+
+    int32_t predictor = state->predictor + (code & 8 ? -diff : diff);
+    if (predictor > 32767) predictor = 32767;
+    if (predictor < -32768) predictor = -32768;
+
+    int32_t index = state->index + adpcm_index_change[code & 7];
+    if (index < 0) index = 0;
+    if (index > 88) index = 88;
+
+    state->predictor = predictor;
+    state->index = index;
+    return predictor;
+}
+
+/**
+ * Codifica uma amostra em 4 bits e atualiza o estado.
+ */
+uint8_t adpcm_encode_sample(adpcm_state_t *state, int16_t sample) {
+    int32_t step = adpcm_steps[state->index];
+    int32_t diff = sample - state->predictor;
+    uint8_t code = 0;
+
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) {
+        code |= 4;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 2;
+        diff -= step;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        code |= 1;
+    }
+
+    adpcm_update(state, code);
+    return code;
+}
+
+/**
+ * Decodifica um código de 4 bits e atualiza o estado.
+ */
+int16_t adpcm_decode_sample(adpcm_state_t *state, uint8_t code) {
+    return adpcm_update(state, code & 0xF);
+}
+
+/**
+ * Codifica amostras do ADC (12 bits em torno do meio da escala, levadas a 16 bits) em
+ * count / 2 bytes; a primeira amostra de cada par vai no nibble de baixo, como no WAV.
+ */
+void adpcm_encode_adc(adpcm_state_t *state, const uint16_t *samples, uint32_t count, uint8_t *out) {
+    for (uint32_t i = 0; i + 1 < count; i += 2) {
+        uint8_t low = adpcm_encode_sample(state, ((int32_t)samples[i] - ADPCM_ADC_MIDSCALE) * 16);
+        uint8_t high = adpcm_encode_sample(state, ((int32_t)samples[i + 1] - ADPCM_ADC_MIDSCALE) * 16);
+        *out++ = low | (high << 4);
+    }
+}
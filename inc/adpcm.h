@@ -0,0 +1,18 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef adpcm_inc_h
+#define adpcm_inc_h
+
+// IMA-ADPCM: 4 bits por amostra de 16 bits (4:1)
+typedef struct {
+    int16_t predictor; // Última amostra reconstruída
+    uint8_t index; // Posição na tabela de passos (0..88)
+} adpcm_state_t;
+
+void adpcm_init(adpcm_state_t *state);
+uint8_t adpcm_encode_sample(adpcm_state_t *state, int16_t sample);
+int16_t adpcm_decode_sample(adpcm_state_t *state, uint8_t code);
+void adpcm_encode_adc(adpcm_state_t *state, const uint16_t *samples, uint32_t count, uint8_t *out);
+
+#endif
@@ -0,0 +1,83 @@
+#include <string.h>
+#include "hal.h"
+#include "anim.h"
+
+// Decodifica um quadro sobre o anterior e retorna o início do seguinte. Nos deltas, as
+// repetições de zero (a parte que não mudou, quase tudo) só avançam a posição.
+static const uint8_t *anim_decode(const uint8_t *in, uint8_t *frame, uint length) {
+    bool delta = *in++ == ANIM_FRAME_DELTA;
+    uint8_t *out = frame;
+    uint8_t *end = frame + length;
+
+    while (out < end) {
+        uint code = *in++;
+        uint count = (code & 0x7F) + 1;
+
+        if (count > (uint)(end - out)) {
+            count = end - out; // Dados corrompidos: não escreve fora do quadro
+        }
+
+        if (code & 0x80) {
+            uint8_t value = *in++;
+            if (!delta) {
+                memset(out, value, count);
+            }
+            else if (value) {
+                for (uint i = 0; i < count; i++) out[i] ^= value;
+            }
+        }
+        else {
+            if (!delta) {
+                memcpy(out, in, count);
+            }
+            else {
+                for (uint i = 0; i < count; i++) out[i] ^= in[i];
+            }
+            in += (code & 0x7F) + 1;
+        }
+        out += count;
+    }
+    return in;
+}
+
+/**
+ * Prepara a reprodução; o primeiro quadro sai na primeira chamada de anim_player_update().
+ */
+void anim_player_init(anim_player_t *player, const anim_t *anim, uint8_t *frame, bool loop) {
+    player->anim = anim;
+    player->frame = frame;
+    player->next = anim->data;
+    player->index = 0;
+    player->due_ms = 0;
+    player->loop = loop;
+}
+
+/**
+ * Decodifica o próximo quadro em player->frame se já é hora (e se a animação não acabou);
+ * retorna true quando o quadro mudou e precisa ser enviado.
+ */
+bool anim_player_update(anim_player_t *player, uint32_t now_ms) {
+    const anim_t *anim = player->anim;
+
+    if (player->index > 0 && (int32_t)(now_ms - player->due_ms) < 0) {
+        return false;
+    }
+    if (player->index >= anim->frame_count) {
+        if (!player->loop) {
+            return false;
+        }
+        player->next = anim->data; // O primeiro quadro é chave: recomeça sem depender do último
+        player->index = 0;
+    }
+
+    player->next = anim_decode(player->next, player->frame, anim->width * anim->pages);
+    player->index++;
+    // Sem acumular atraso, a não ser que a chamada tenha perdido um quadro inteiro
+    player->due_ms = (int32_t)(now_ms - player->due_ms) < anim->frame_ms ? player->due_ms + anim->frame_ms : now_ms + anim->frame_ms;
+    return true;
+}
+
+// Verdadeiro quando uma animação sem repetição já mostrou o último quadro
+bool anim_player_done(const anim_player_t *player) {
+    return !player->loop && player->index >= player->anim->frame_count;
+}
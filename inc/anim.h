@@ -0,0 +1,37 @@
+#include "hal.h"
+
+#ifndef anim_inc_h
+#define anim_inc_h
+
+// Animações 1 bit para o OLED, geradas por tools/anim_convert.py a partir de PNG.
+// Cada quadro é um byte de tipo seguido de códigos RLE que, juntos, cobrem width * pages
+// bytes no formato de páginas do SSD1306: 0x00-0x7F são n + 1 bytes literais, 0x80-0xFF
+// repetem o byte seguinte (n & 0x7F) + 1 vezes. Um quadro-chave substitui o quadro anterior;
+// um delta é aplicado com XOR sobre ele. O primeiro quadro é sempre chave.
+#define ANIM_FRAME_KEY 0x00
+#define ANIM_FRAME_DELTA 0x01
+
+typedef struct {
+    const uint8_t *data; // Quadros codificados, um depois do outro
+    uint16_t frame_count;
+    uint16_t frame_ms; // Intervalo entre quadros
+    uint8_t width; // Em pixels
+    uint8_t pages; // Altura em páginas de 8 pixels
+} anim_t;
+
+// Reprodução: o quadro é decodificado no lugar em 'frame' (width * pages bytes), que guarda
+// o quadro atual entre as chamadas; pode ser o ram_buffer de um ssd1306_t (depois do byte 0x40)
+typedef struct {
+    const anim_t *anim;
+    uint8_t *frame;
+    const uint8_t *next; // Próximo quadro codificado
+    uint16_t index; // Índice do próximo quadro
+    uint32_t due_ms; // Quando o próximo quadro deve aparecer
+    bool loop;
+} anim_player_t;
+
+void anim_player_init(anim_player_t *player, const anim_t *anim, uint8_t *frame, bool loop);
+bool anim_player_update(anim_player_t *player, uint32_t now_ms);
+bool anim_player_done(const anim_player_t *player);
+
+#endif
@@ -0,0 +1,313 @@
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+#include "hal.h"
+#include "audio.h"
+#include "mic_dma.h"
+#include "mic_rms.h"
+#include "whistle.h"
+#include "noise_floor.h"
+#include "level_meter.h"
+#include "fft.h"
+#include "spectrum.h"
+#include "recorder.h"
+#include "spsc_queue.h"
+#include "trace.h"
+
+#define AUDIO_INTENSITY_LEVELS 5 // Níveis de intensidade para os LEDs (0 a 4)
+#define AUDIO_INTENSITY_MIN_DB 18 // Nível 1 a partir de 18 dB acima do piso (8 contagens de RMS)
+#define AUDIO_INTENSITY_STEP_DB 6 // Um nível a mais a cada vez que o RMS dobra
+#define AUDIO_INTENSITY_HYSTERESIS_Q8 384 // 1,5 dB de histerese entre os níveis
+#define AUDIO_WHISTLE_FLOOR_SHIFT 1 // O apito precisa de 2x a energia do piso de ruído (+3 dB)
+
+SPSC_QUEUE_DEFINE(audio_queue, audio_report_t, AUDIO_QUEUE_LENGTH)
+
+// Estado do produtor (core de áudio)
+static uint audio_mic_channel;
+static mic_rms_window_t audio_window;
+static whistle_detector_t audio_whistle;
+static noise_floor_t audio_floor;
+static level_meter_t audio_meter;
+static uint8_t audio_intensity;
+static const level_meter_config_t audio_meter_config = LEVEL_METER_PPM; // Sobe na hora, desce sem piscar
+static uint32_t audio_dropped;
+static fft_complex_t audio_fft[FFT_SIZE];
+
+_Static_assert(MIC_DMA_BLOCK_SAMPLES == FFT_SIZE, "a FFT usa um bloco do ADC inteiro");
+
+// Compartilhado entre os cores
+static audio_queue_t audio_queue;
+static volatile bool audio_reset_pending = false;
+static volatile bool audio_calibrate_pending = false;
+static volatile bool audio_spectrum_enabled = false;
+static volatile bool audio_capture_enabled = true;
+static volatile bool audio_capture_paused = false; // Pausa pedida pelo core0 para apagar a flash
+static uint32_t audio_saved_floor_q4, audio_saved_dc_q4; // Piso de uma execução anterior (0 = nenhum)
+
+// Estado da captura: só o core de áudio liga e desliga o DMA. O core0 lê audio_dma_stopped, que
+// só passa a true depois de mic_dma_stop() voltar e a false antes de mic_dma_start()
+static bool audio_capturing = false;
+static atomic_bool audio_dma_stopped = true;
+
+// Liga a captura contínua; roda no core que vai tratar a interrupção do DMA
+static void audio_setup(void) {
+    mic_rms_window_init(&audio_window);
+    whistle_init(&audio_whistle, AUDIO_SAMPLE_RATE);
+    noise_floor_init(&audio_floor);
+    if (audio_saved_floor_q4 != 0) {
+        audio_floor.floor_q4 = audio_saved_floor_q4;
+        audio_floor.dc_q4 = audio_saved_dc_q4;
+    }
+    level_meter_init(&audio_meter, &audio_meter_config);
+    mic_dma_init(audio_mic_channel, AUDIO_SAMPLE_RATE);
+    atomic_store_explicit(&audio_dma_stopped, false, memory_order_release);
+    mic_dma_start();
+    audio_capturing = true;
+}
+
+// O joystick é amostrado pelo DMA junto com o microfone; aqui só se lê a média do bloco
+static void audio_read_joystick(uint16_t *vrx, uint16_t *vry) {
+    *vrx = mic_dma_aux(0); // Canal do VRX
+    *vry = mic_dma_aux(1); // Canal do VRY
+}
+
+// Processa o bloco mais recente, se houver, e publica o relatório na fila
+static bool audio_process_block(void) {
+    // Pedido do core0: parar a captura deixa o core de áudio dormindo sem interrupções
+    bool capture = audio_capture_enabled && !audio_capture_paused;
+
+    // Parado só se publica com o DMA já desligado: antes disso o core0 poderia apagar a flash
+    // com o DMA ainda escrevendo
+    if (capture != audio_capturing) {
+        if (capture) {
+            atomic_store_explicit(&audio_dma_stopped, false, memory_order_release);
+            mic_dma_start();
+        }
+        else {
+            mic_dma_stop();
+            atomic_store_explicit(&audio_dma_stopped, true, memory_order_release);
+        }
+        audio_capturing = capture;
+    }
+
+    const uint16_t *block = mic_dma_get_block();
+
+    if (block == NULL) {
+        return false;
+    }
+
+    if (audio_reset_pending) {
+        whistle_reset(&audio_whistle);
+        audio_reset_pending = false;
+    }
+    if (audio_calibrate_pending) {
+        noise_floor_calibrate(&audio_floor);
+        audio_calibrate_pending = false;
+    }
+
+    audio_report_t report;
+    bool was_whistling = audio_whistle.detected;
+
+    TRACE_BEGIN(TRACE_AUDIO_BLOCK, 0);
+    recorder_push_block(block, MIC_DMA_BLOCK_SAMPLES); // Só codifica se houver gravação em andamento
+    TRACE_BEGIN(TRACE_RMS, 0);
+    report.rms_q4 = mic_rms_window_push(&audio_window, block, MIC_DMA_BLOCK_SAMPLES);
+    TRACE_END(TRACE_RMS, report.rms_q4);
+    TRACE_BEGIN(TRACE_WHISTLE, 0);
+    report.whistle = whistle_process(&audio_whistle, block, MIC_DMA_BLOCK_SAMPLES);
+    TRACE_END(TRACE_WHISTLE, report.whistle);
+    report.has_spectrum = audio_spectrum_enabled;
+    if (report.has_spectrum) {
+        // O bloco tem exatamente FFT_SIZE amostras; o DC vem da janela do RMS
+        TRACE_BEGIN(TRACE_FFT, 0);
+        fft_load_hann(audio_fft, block, mic_rms_dc(&audio_window.total));
+        fft_q15(audio_fft, FFT_LOG2_SIZE);
+        spectrum_compute(audio_fft, report.spectrum);
+        TRACE_END(TRACE_FFT, 0);
+    }
+    report.whistle_onset = report.whistle && !was_whistling;
+
+    // O piso só aprende com blocos sem tom; o detector passa a exigir energia acima dele
+    // (na escala do detector, amostras / 4, a energia por amostra do piso é floor_q4² / 4096)
+    uint32_t dc_q4 = mic_rms_dc(&audio_window.total) << MIC_RMS_FRAC_BITS;
+    noise_floor_update(&audio_floor, report.rms_q4, dc_q4, audio_whistle.last_bin >= 0);
+    whistle_set_min_energy(&audio_whistle,
+                           ((audio_floor.floor_q4 * audio_floor.floor_q4) >> 12) << AUDIO_WHISTLE_FLOOR_SHIFT);
+    report.floor_q4 = audio_floor.floor_q4;
+    report.dc_q4 = audio_floor.dc_q4;
+    report.calibrating = audio_floor.cal_remaining > 0;
+
+    // O RMS já vem sem o DC; o medidor vê só o que passa do piso
+    report.level_db_q8 = level_meter_update(&audio_meter, noise_floor_excess_q4(&audio_floor, report.rms_q4));
+    report.peak_db_q8 = audio_meter.peak_db_q8;
+    audio_intensity = level_meter_quantize_hysteresis(report.level_db_q8, LEVEL_METER_DB(AUDIO_INTENSITY_MIN_DB),
+                                                      LEVEL_METER_DB(AUDIO_INTENSITY_STEP_DB), AUDIO_INTENSITY_LEVELS,
+                                                      audio_intensity, AUDIO_INTENSITY_HYSTERESIS_Q8);
+    report.intensity = audio_intensity;
+    report.block = mic_dma_blocks_done();
+    audio_read_joystick(&report.vrx, &report.vry);
+    report.timestamp_us = hal_time_us();
+
+    if (!audio_queue_push(&audio_queue, &report)) {
+        audio_dropped++;
+    }
+    TRACE_END(TRACE_AUDIO_BLOCK, report.block);
+#if AUDIO_DUAL_CORE
+    hal_signal_event(); // Acorda o core0 se ele estiver dormindo em hal_wait_for_event()
+#endif
+
+    return true;
+}
+
+#if AUDIO_DUAL_CORE
+// Laço do core1: dorme até a interrupção do DMA e processa cada bloco
+static void audio_core1_main(void) {
+    audio_setup();
+
+    while (true) {
+        if (!audio_process_block()) {
+            hal_wait_for_event();
+        }
+    }
+}
+#endif
+
+/**
+ * Inicia a captura e o processamento de áudio (no core1, se AUDIO_DUAL_CORE).
+ */
+void audio_init(uint mic_channel) {
+    audio_mic_channel = mic_channel;
+    audio_queue_init(&audio_queue);
+
+#if AUDIO_DUAL_CORE
+    hal_launch_core1(audio_core1_main);
+#else
+    audio_setup();
+#endif
+}
+
+/**
+ * Consome os relatórios pendentes e devolve o mais recente; retorna false se não havia nenhum.
+ * Um início de apito em qualquer relatório consumido fica marcado no relatório devolvido, e o
+ * espectro devolvido é o máximo de todos eles.
+ */
+bool audio_update(audio_report_t *report) {
+    audio_report_t next;
+    bool updated = false;
+    bool onset = false;
+
+#if !AUDIO_DUAL_CORE
+    audio_process_block();
+#endif
+
+    uint8_t spectrum[SPECTRUM_BARS] = { 0 };
+    bool has_spectrum = false;
+
+    while (audio_queue_pop(&audio_queue, &next)) {
+        onset |= next.whistle_onset;
+        if (next.has_spectrum) {
+            // Máximo por barra, para não perder um pico entre dois relatórios consumidos
+            for (uint i = 0; i < SPECTRUM_BARS; i++) {
+                if (next.spectrum[i] > spectrum[i]) spectrum[i] = next.spectrum[i];
+            }
+            has_spectrum = true;
+        }
+        *report = next;
+        updated = true;
+    }
+
+    if (updated) {
+        report->whistle_onset = onset;
+        report->has_spectrum = has_spectrum;
+        memcpy(report->spectrum, spectrum, sizeof(spectrum));
+    }
+
+    return updated;
+}
+
+/**
+ * Indica, sem consumir, se há relatórios novos para audio_update().
+ */
+bool audio_available(void) {
+#if !AUDIO_DUAL_CORE
+    audio_process_block();
+#endif
+    return audio_queue_count(&audio_queue) != 0;
+}
+
+/**
+ * Instante em que o relatório mais antigo ainda não consumido ficou pronto (0 se não há nenhum).
+ */
+uint64_t audio_oldest_timestamp(void) {
+    const audio_report_t *report = audio_queue_front(&audio_queue);
+    return report ? report->timestamp_us : 0;
+}
+
+/**
+ * Liga ou desliga a captura do ADC (e com ela o joystick, que vem no mesmo DMA); desligada,
+ * o core de áudio dorme até ela voltar. Vale a partir do próximo despertar do core de áudio.
+ */
+void audio_set_capture(bool enabled) {
+    audio_capture_enabled = enabled;
+    hal_signal_event();
+}
+
+/**
+ * Pausa ou retoma a captura independentemente do modo de energia, para apagar a flash: um
+ * apagamento deixa as interrupções desligadas por mais tempo que o anel do ADC, e o DMA, sem
+ * ser rearmado, escreveria além dele. Só é seguro apagar depois de audio_capture_stopped().
+ */
+void audio_pause_capture(bool paused) {
+    if (paused != audio_capture_paused) {
+        audio_capture_paused = paused;
+        hal_signal_event();
+    }
+}
+
+/**
+ * Indica se o core de áudio já desligou o DMA do ADC (pausa ou modo sem captura).
+ */
+bool audio_capture_stopped(void) {
+#if !AUDIO_DUAL_CORE
+    audio_process_block();
+#endif
+    return atomic_load_explicit(&audio_dma_stopped, memory_order_acquire);
+}
+
+/**
+ * Pede ao core de áudio que esqueça o histórico do detector de apito.
+ */
+void audio_reset_detector(void) {
+    audio_reset_pending = true;
+}
+
+/**
+ * Pede ao core de áudio que meça de novo o piso de ruído e o DC (~0,5 s); até terminar, o
+ * piso anterior continua valendo.
+ */
+void audio_calibrate(void) {
+    audio_calibrate_pending = true;
+}
+
+/**
+ * Piso de ruído e DC salvos de uma execução anterior: valem enquanto a calibração do boot não
+ * termina (e depois dela, se ela foi toda tonal). Chamar antes de audio_init().
+ */
+void audio_restore_noise_floor(uint32_t floor_q4, uint32_t dc_q4) {
+    audio_saved_floor_q4 = floor_q4;
+    audio_saved_dc_q4 = dc_q4;
+}
+
+/**
+ * Liga ou desliga a FFT de cada bloco no core de áudio (só custa quando a tela de espectro está aberta).
+ */
+void audio_set_spectrum(bool enabled) {
+    audio_spectrum_enabled = enabled;
+}
+
+/**
+ * Relatórios descartados porque o core0 não esvaziou a fila a tempo.
+ */
+uint32_t audio_dropped_reports(void) {
+    return audio_dropped;
+}
@@ -0,0 +1,45 @@
+#include "hal.h"
+#include "spectrum.h"
+
+#ifndef audio_inc_h
+#define audio_inc_h
+
+#ifndef AUDIO_DUAL_CORE
+#define AUDIO_DUAL_CORE 1 // 1: captura e DSP no core1; 0: tudo no core0
+#endif
+
+#define AUDIO_SAMPLE_RATE 16000 // Taxa de amostragem contínua (Hz)
+#define AUDIO_QUEUE_LENGTH 16 // Relatórios pendentes entre core1 e core0 (potência de 2)
+
+// Resultado de um bloco de áudio, publicado pelo core de áudio
+typedef struct {
+    uint64_t timestamp_us; // Fim do processamento do bloco
+    uint32_t block; // Número do bloco desde o início da captura
+    uint32_t rms_q4; // RMS sem DC (Q4, contagens do ADC)
+    int32_t level_db_q8; // Nível acima do piso de ruído, com balística de PPM (dB em Q8)
+    int32_t peak_db_q8; // Pico retido do nível (dB em Q8)
+    uint8_t intensity; // Nível quantizado de 0 a 4 para os LEDs
+    uint32_t floor_q4; // Piso de ruído acompanhado (Q4, contagens do ADC)
+    uint32_t dc_q4; // Nível DC acompanhado (Q4, contagens do ADC)
+    bool calibrating; // Medindo o piso de ruído (audio_calibrate)
+    bool whistle; // Estado do detector de apito
+    bool whistle_onset; // Apito começou neste bloco
+    uint16_t vrx, vry; // Última leitura do joystick
+    bool has_spectrum; // spectrum é válido (modo espectro ligado)
+    uint8_t spectrum[SPECTRUM_BARS]; // Níveis das barras do espectro (3/8 dB)
+} audio_report_t;
+
+void audio_init(uint mic_channel);
+bool audio_update(audio_report_t *report);
+bool audio_available(void);
+uint64_t audio_oldest_timestamp(void);
+void audio_set_capture(bool enabled);
+void audio_pause_capture(bool paused);
+bool audio_capture_stopped(void);
+void audio_reset_detector(void);
+void audio_calibrate(void);
+void audio_restore_noise_floor(uint32_t floor_q4, uint32_t dc_q4);
+void audio_set_spectrum(bool enabled);
+uint32_t audio_dropped_reports(void);
+
+#endif
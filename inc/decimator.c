@@ -0,0 +1,112 @@
+#include "decimator.h"
+
+// Decimação do ADC sobreamostrado: um CIC de ordem 4 reduz a taxa por 4 ou 8 sem
+// multiplicações e um FIR de 31 taps, que decima por 2, corrige a queda do CIC até 6 kHz
+// (±0,02 dB) e rejeita em ~50 dB o que dobraria para dentro dela. O ruído do ADC fora da
+// banda é filtrado, o que dá os bits efetivos a mais; a saída continua na escala de 12 bits
+// do ADC (com arredondamento), pois a resolução efetiva depois do filtro ainda fica abaixo
+// disso e assim o resto do processamento não muda. Tabelas geradas por tools/decimator_design.py.
+
+#define DECIMATOR_ADC_MIDSCALE 2048
+#define DECIMATOR_CIC_GAIN_BITS (DECIMATOR_CIC_ORDER * DECIMATOR_CIC_LOG2_RATIO) // log2(R^N)
+#define DECIMATOR_FRAC_BITS 3 // Bits fracionários entre o CIC e o FIR (folga para o acumulador de 32 bits)
+
+_Static_assert(DECIMATOR_CIC_ORDER == 4, "regenere as tabelas do FIR e ajuste os integradores");
+
+// Q15, simétricos; um conjunto para cada decimação do CIC (ordem 4, FIR / 2 -> 16 kHz)
+#if DECIMATOR_CIC_RATIO == 4
+static const int16_t decimator_fir[DECIMATOR_FIR_TAPS] = { // ADC a 128 kHz
+    -19, 15, 92, -37, -258, 64, 583, -82, -1165, 56, 2204, 131,
+    -4326, -1159, 11082, 18414, 11082, -1159, -4326, 131, 2204, 56, -1165, -82,
+    583, 64, -258, -37, 92, 15, -19,
+};
+#elif DECIMATOR_CIC_RATIO == 8
+static const int16_t decimator_fir[DECIMATOR_FIR_TAPS] = { // ADC a 256 kHz
+    -19, 15, 93, -37, -263, 64, 594, -82, -1186, 51, 2243, 150,
+    -4393, -1235, 11123, 18537, 11123, -1235, -4393, 150, 2243, 51, -1186, -82,
+    594, 64, -263, -37, 93, 15, -19,
+};
+#else
+#error "gere a tabela com tools/decimator_design.py --ratio N"
+#endif
+
+void decimator_init(decimator_t *dec) {
+    for (uint32_t i = 0; i < DECIMATOR_CIC_ORDER; i++) {
+        dec->integrator[i] = 0;
+        dec->comb[i] = 0;
+    }
+    for (uint32_t i = 0; i < 2 * DECIMATOR_FIR_TAPS; i++) {
+        dec->history[i] = 0;
+    }
+    dec->phase = 0;
+    dec->history_pos = 0;
+    dec->odd = false;
+}
+
+// Saída do FIR para a linha de atraso atual (a amostra mais nova em history[pos])
+static uint16_t decimator_fir_output(const decimator_t *dec) {
+    const int16_t *x = &dec->history[dec->history_pos];
+    int32_t acc = decimator_fir[DECIMATOR_FIR_TAPS / 2] * x[DECIMATOR_FIR_TAPS / 2];
+
+    // Simetria: um produto para cada par de taps iguais
+    for (uint32_t k = 0; k < DECIMATOR_FIR_TAPS / 2; k++) {
+        acc += decimator_fir[k] * (x[k] + x[DECIMATOR_FIR_TAPS - 1 - k]);
+    }
+
+    int32_t v = DECIMATOR_ADC_MIDSCALE + ((acc + (1 << (14 + DECIMATOR_FRAC_BITS))) >> (15 + DECIMATOR_FRAC_BITS));
+    return v < 0 ? 0 : v > 4095 ? 4095 : v;
+}
+
+/**
+ * Decima 'count' amostras brutas do ADC (12 bits), lidas de 'stride' em 'stride' (para tirar
+ * um canal de uma captura intercalada sem copiar), e escreve as saídas em 'out'; retorna
+ * quantas saídas foram produzidas (count / DECIMATOR_RATIO quando count é múltiplo disso).
+ * O estado passa de um bloco para o outro, então os blocos podem ter qualquer tamanho.
+ */
+uint32_t decimator_process(decimator_t *dec, const uint16_t *in, uint32_t count, uint32_t stride, uint16_t *out) {
+    uint32_t i0 = dec->integrator[0], i1 = dec->integrator[1];
+    uint32_t i2 = dec->integrator[2], i3 = dec->integrator[3];
+    uint32_t produced = 0;
+
+    for (uint32_t n = 0; n < count; n++) {
+        // Integradores na taxa do ADC; o estouro é esperado e se cancela nos pentes
+        i0 += in[n * stride];
+        i1 += i0;
+        i2 += i1;
+        i3 += i2;
+
+        if (++dec->phase < DECIMATOR_CIC_RATIO) {
+            continue;
+        }
+        dec->phase = 0;
+
+        // Pentes na taxa de saída do CIC
+        uint32_t y = i3;
+        for (uint32_t s = 0; s < DECIMATOR_CIC_ORDER; s++) {
+            uint32_t t = y;
+            y -= dec->comb[s];
+            dec->comb[s] = t;
+        }
+
+        // Sem o meio da escala e com DECIMATOR_FRAC_BITS bits fracionários
+        int32_t v = ((int32_t)(y - ((uint32_t)DECIMATOR_ADC_MIDSCALE << DECIMATOR_CIC_GAIN_BITS)))
+                    >> (DECIMATOR_CIC_GAIN_BITS - DECIMATOR_FRAC_BITS);
+        if (v > 32767) v = 32767;
+        if (v < -32767) v = -32767;
+
+        dec->history_pos = dec->history_pos ? dec->history_pos - 1 : DECIMATOR_FIR_TAPS - 1;
+        dec->history[dec->history_pos] = v;
+        dec->history[dec->history_pos + DECIMATOR_FIR_TAPS] = v;
+
+        dec->odd = !dec->odd;
+        if (!dec->odd) {
+            out[produced++] = decimator_fir_output(dec);
+        }
+    }
+
+    dec->integrator[0] = i0;
+    dec->integrator[1] = i1;
+    dec->integrator[2] = i2;
+    dec->integrator[3] = i3;
+    return produced;
+}
@@ -0,0 +1,28 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef decimator_inc_h
+#define decimator_inc_h
+
+#define DECIMATOR_CIC_ORDER 4
+#ifndef DECIMATOR_CIC_LOG2_RATIO
+#define DECIMATOR_CIC_LOG2_RATIO 2 // Decimação do CIC: 4 (ADC a 8x a taxa do áudio) ou 8 (16x)
+#endif
+#define DECIMATOR_CIC_RATIO (1u << DECIMATOR_CIC_LOG2_RATIO)
+#define DECIMATOR_FIR_TAPS 31
+#define DECIMATOR_RATIO (DECIMATOR_CIC_RATIO * 2) // O FIR ainda decima por 2
+
+// Estado do decimador (CIC em aritmética modular seguido de FIR de compensação)
+typedef struct {
+    uint32_t integrator[DECIMATOR_CIC_ORDER];
+    uint32_t comb[DECIMATOR_CIC_ORDER];
+    uint32_t phase; // Amostras de entrada desde a última saída do CIC
+    int16_t history[2 * DECIMATOR_FIR_TAPS]; // Linha de atraso duplicada (sem módulo no laço)
+    uint32_t history_pos;
+    bool odd; // O FIR só calcula uma saída a cada duas do CIC
+} decimator_t;
+
+void decimator_init(decimator_t *dec);
+uint32_t decimator_process(decimator_t *dec, const uint16_t *in, uint32_t count, uint32_t stride, uint16_t *out);
+
+#endif
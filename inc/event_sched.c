@@ -0,0 +1,418 @@
+#include "hal.h"
+#include "event_sched.h"
+#include "trace.h"
+
+#define SCHED_LOCK() uint32_t sched_irq = hal_irq_save()
+#define SCHED_UNLOCK() hal_irq_restore(sched_irq)
+
+// Fila de eventos: vários produtores (interrupções do core0), um consumidor (laço principal)
+static event_t sched_queue[SCHED_QUEUE_LENGTH];
+static uint32_t sched_head;
+static uint32_t sched_tail;
+static uint32_t sched_dropped;
+
+static event_handler_t sched_handler;
+static sched_idle_hook_t sched_idle_hook;
+
+// Prazos: um heap mínimo ordenado pelo instante de disparo, servido por um único alarme armado
+// para o prazo da raiz. Armar e cancelar custam O(log n); o alarme dispara no instante exato do
+// prazo mais próximo e posta todos os que já venceram. A geração invalida eventos de um timer
+// cancelado ou reiniciado que já estavam na fila.
+typedef struct {
+    uint64_t deadline_us;
+    uint8_t id;
+} sched_deadline_t;
+
+_Static_assert(SCHED_MAX_TIMERS <= 32, "timer_expired tem um bit por prazo");
+
+static sched_deadline_t timer_heap[SCHED_MAX_TIMERS];
+static uint timer_heap_size;
+static int8_t timer_heap_pos[SCHED_MAX_TIMERS]; // Posição no heap (-1 = fora)
+static uint32_t timer_generation[SCHED_MAX_TIMERS];
+static bool timer_active[SCHED_MAX_TIMERS];
+static uint32_t timer_expired; // Prazos vencidos com a fila cheia (bit = id), à espera do laço
+static uint32_t timer_expired_us[SCHED_MAX_TIMERS]; // Quando venceram
+static hal_alarm_id_t timer_alarm; // O alarme do heap (0 = desarmado)
+static uint64_t timer_alarm_at; // Prazo para o qual ele está armado
+static volatile bool tick_pending = false;
+
+// Medidas (só o laço principal escreve)
+static uint64_t stats_start_us;
+static uint64_t stats_sleep_us;
+static uint32_t stats_wakeups;
+static uint32_t stats_latency_count;
+static uint32_t stats_latency_max_us;
+static uint64_t stats_latency_sum_us;
+static bool stats_woke = false; // O próximo evento tratado é o primeiro depois de acordar
+
+// Enfileira um evento com o dado interno e o instante em que aconteceu; seguro em interrupções
+static bool sched_push(uint16_t type, uint16_t arg, uint32_t data, uint32_t posted_us) {
+    bool ok = false;
+
+    SCHED_LOCK();
+    if (sched_head - sched_tail < SCHED_QUEUE_LENGTH) {
+        event_t *ev = &sched_queue[sched_head % SCHED_QUEUE_LENGTH];
+        ev->type = type;
+        ev->arg = arg;
+        ev->data = data;
+        ev->posted_us = posted_us;
+        sched_head++;
+        ok = true;
+    }
+    else {
+        sched_dropped++;
+    }
+    SCHED_UNLOCK();
+
+    return ok;
+}
+
+// Retira um prazo que venceu com a fila cheia, senão o evento mais antigo da fila
+static bool sched_pop(event_t *ev) {
+    bool ok = false;
+
+    SCHED_LOCK();
+    if (timer_expired) {
+        uint id = __builtin_ctz(timer_expired);
+        timer_expired &= ~(1u << id);
+        *ev = (event_t){ .type = EVENT_TIMER, .arg = id, .data = timer_generation[id], .posted_us = timer_expired_us[id] };
+        ok = true;
+    }
+    else if (sched_head != sched_tail) {
+        *ev = sched_queue[sched_tail % SCHED_QUEUE_LENGTH];
+        sched_tail++;
+        ok = true;
+    }
+    SCHED_UNLOCK();
+
+    return ok;
+}
+
+static hal_alarm_id_t tick_alarm;
+static uint64_t tick_period_us;
+
+// Operações do heap; todas rodam com as interrupções desligadas
+static void sched_heap_place(uint pos, sched_deadline_t entry) {
+    timer_heap[pos] = entry;
+    timer_heap_pos[entry.id] = pos;
+}
+
+static void sched_heap_sift_up(uint pos) {
+    sched_deadline_t entry = timer_heap[pos];
+
+    while (pos > 0) {
+        uint parent = (pos - 1) / 2;
+        if (timer_heap[parent].deadline_us <= entry.deadline_us) {
+            break;
+        }
+        sched_heap_place(pos, timer_heap[parent]);
+        pos = parent;
+    }
+    sched_heap_place(pos, entry);
+}
+
+static void sched_heap_sift_down(uint pos) {
+    sched_deadline_t entry = timer_heap[pos];
+
+    while (true) {
+        uint child = 2 * pos + 1;
+        if (child >= timer_heap_size) {
+            break;
+        }
+        if (child + 1 < timer_heap_size && timer_heap[child + 1].deadline_us < timer_heap[child].deadline_us) {
+            child++;
+        }
+        if (entry.deadline_us <= timer_heap[child].deadline_us) {
+            break;
+        }
+        sched_heap_place(pos, timer_heap[child]);
+        pos = child;
+    }
+    sched_heap_place(pos, entry);
+}
+
+// Tira o prazo 'id' do heap, se estiver nele
+static void sched_heap_remove(uint id) {
+    int pos = timer_heap_pos[id];
+
+    if (pos < 0) {
+        return;
+    }
+    timer_heap_pos[id] = -1;
+    timer_heap_size--;
+    if ((uint)pos == timer_heap_size) {
+        return;
+    }
+
+    // O último ocupa o lugar e desce ou sobe até a posição certa
+    sched_heap_place(pos, timer_heap[timer_heap_size]);
+    sched_heap_sift_down(pos);
+    sched_heap_sift_up(pos);
+}
+
+static int64_t sched_alarm_callback(hal_alarm_id_t alarm, void *user_data);
+
+// Mantém o alarme armado para a raiz do heap (só o refaz se a raiz mudou)
+static void sched_timer_rearm(void) {
+    uint64_t next = timer_heap_size ? timer_heap[0].deadline_us : 0;
+
+    if (next == timer_alarm_at) {
+        return;
+    }
+    if (timer_alarm > 0) {
+        hal_alarm_cancel(timer_alarm);
+    }
+    timer_alarm = 0;
+    timer_alarm_at = next;
+    if (next) {
+        uint64_t now = hal_time_us();
+        // Um prazo já vencido pode disparar aqui mesmo; o callback cuida do resto do heap
+        timer_alarm = hal_alarm_in_us(next > now ? next - now : 0, sched_alarm_callback, NULL);
+    }
+}
+
+// Alarme do heap: posta os prazos vencidos e se reagenda para o próximo
+static int64_t sched_alarm_callback(hal_alarm_id_t alarm, void *user_data) {
+    (void)alarm;
+    (void)user_data;
+    int64_t again = 0;
+    uint64_t now = hal_time_us();
+
+    SCHED_LOCK();
+    while (timer_heap_size && timer_heap[0].deadline_us <= now) {
+        uint id = timer_heap[0].id;
+        sched_heap_remove(id);
+        // Com a fila cheia o prazo não se perde: fica marcado e sched_dispatch o entrega
+        if (!sched_push(EVENT_TIMER, id, timer_generation[id], now)) {
+            timer_expired |= 1u << id;
+            timer_expired_us[id] = now;
+        }
+    }
+    if (timer_heap_size) {
+        uint64_t delay = timer_heap[0].deadline_us - now;
+        timer_alarm_at = timer_heap[0].deadline_us;
+        again = -(int64_t)delay; // Negativo: relativo a agora
+    }
+    else {
+        timer_alarm = 0;
+        timer_alarm_at = 0;
+    }
+    SCHED_UNLOCK();
+
+    return again;
+}
+
+// Tique periódico; não acumula tiques se o laço principal estiver atrasado.
+// Reagendar relativo ao disparo anterior mantém o intervalo entre inícios, sem deriva.
+static int64_t sched_tick_callback(hal_alarm_id_t alarm, void *user_data) {
+    (void)alarm;
+    (void)user_data;
+    if (!tick_pending) {
+        tick_pending = true;
+        sched_push(EVENT_TICK, 0, 0, hal_time_us());
+    }
+    return tick_period_us;
+}
+
+/**
+ * Tempo desde o boot em milissegundos.
+ */
+uint32_t sched_now_ms(void) {
+    return hal_time_ms();
+}
+
+/**
+ * Prepara a fila e define o tratador da máquina de estados.
+ */
+void sched_init(event_handler_t handler) {
+    sched_handler = handler;
+    sched_head = sched_tail = 0;
+    tick_pending = false;
+    timer_heap_size = 0;
+    timer_expired = 0;
+    for (uint i = 0; i < SCHED_MAX_TIMERS; i++) {
+        timer_heap_pos[i] = -1;
+    }
+    sched_get_stats(NULL, true);
+}
+
+/**
+ * Posta um evento para o laço principal; pode ser chamada de interrupções.
+ */
+bool sched_post(event_type_t type, uint16_t arg) {
+    return sched_push(type, arg, 0, hal_time_us());
+}
+
+/**
+ * Posta um evento que aconteceu antes, em since_us (p. ex. um bloco de áudio que o outro core
+ * terminou), para que a latência medida conte desde lá.
+ */
+bool sched_post_since(event_type_t type, uint16_t arg, uint64_t since_us) {
+    return sched_push(type, arg, 0, since_us);
+}
+
+/**
+ * Arma (ou rearma) o prazo 'id' para daqui a delay_ms; ao vencer gera EVENT_TIMER(id).
+ */
+bool sched_timer_start(uint id, uint32_t delay_ms) {
+    return sched_timer_start_at(id, hal_time_us() + (uint64_t)delay_ms * 1000);
+}
+
+/**
+ * Arma (ou rearma) o prazo 'id' para o instante absoluto deadline_us (na base de hal_time_us());
+ * um instante que já passou dispara logo.
+ */
+bool sched_timer_start_at(uint id, uint64_t deadline_us) {
+    if (id >= SCHED_MAX_TIMERS) {
+        return false;
+    }
+
+    sched_timer_cancel(id);
+
+    SCHED_LOCK();
+    timer_active[id] = true;
+    timer_heap_size++;
+    sched_heap_place(timer_heap_size - 1, (sched_deadline_t){ .deadline_us = deadline_us ? deadline_us : 1, .id = id });
+    sched_heap_sift_up(timer_heap_size - 1);
+    sched_timer_rearm();
+    bool ok = timer_alarm >= 0;
+    SCHED_UNLOCK();
+
+    return ok;
+}
+
+/**
+ * Cancela o prazo 'id'; um EVENT_TIMER dele que já esteja na fila é descartado.
+ */
+void sched_timer_cancel(uint id) {
+    if (id >= SCHED_MAX_TIMERS) {
+        return;
+    }
+
+    SCHED_LOCK();
+    sched_heap_remove(id);
+    sched_timer_rearm();
+    timer_expired &= ~(1u << id);
+    timer_generation[id]++;
+    timer_active[id] = false;
+    SCHED_UNLOCK();
+}
+
+/**
+ * Indica se o prazo 'id' está armado e ainda não foi tratado.
+ */
+bool sched_timer_active(uint id) {
+    return id < SCHED_MAX_TIMERS && timer_active[id];
+}
+
+/**
+ * Liga o tique periódico da interface (EVENT_TICK a cada period_ms); period_ms = 0 o desliga.
+ */
+bool sched_tick_start(int32_t period_ms) {
+    if (tick_alarm > 0) {
+        hal_alarm_cancel(tick_alarm);
+    }
+    tick_alarm = 0;
+    if (period_ms <= 0) {
+        return true;
+    }
+
+    tick_period_us = (uint64_t)period_ms * 1000;
+    tick_alarm = hal_alarm_in_us(tick_period_us, sched_tick_callback, NULL);
+    return tick_alarm >= 0;
+}
+
+/**
+ * Define a função consultada antes de dormir (p. ex. para checar a fila do core de áudio).
+ */
+void sched_set_idle_hook(sched_idle_hook_t hook) {
+    sched_idle_hook = hook;
+}
+
+/**
+ * Trata um evento da fila, se houver; retorna false se a fila estava vazia.
+ */
+bool sched_dispatch(void) {
+    event_t ev;
+
+    if (!sched_pop(&ev)) {
+        return false;
+    }
+
+    if (ev.type == EVENT_TICK) {
+        tick_pending = false;
+    }
+    else if (ev.type == EVENT_TIMER) {
+        // Prazo cancelado ou rearmado depois de vencer: evento obsoleto
+        if (ev.data != timer_generation[ev.arg] || !timer_active[ev.arg]) {
+            return true;
+        }
+        timer_active[ev.arg] = false;
+    }
+
+    if (stats_woke) {
+        uint32_t latency = (uint32_t)hal_time_us() - ev.posted_us;
+        stats_woke = false;
+        stats_latency_count++;
+        stats_latency_sum_us += latency;
+        if (latency > stats_latency_max_us) stats_latency_max_us = latency;
+    }
+
+    TRACE_BEGIN(TRACE_DISPATCH, ev.type);
+    sched_handler(&ev);
+    TRACE_END(TRACE_DISPATCH, ev.arg);
+    return true;
+}
+
+/**
+ * Laço principal: trata os eventos um a um e dorme quando não há nada a fazer.
+ * Qualquer interrupção, ou um sinal do outro core, acorda o laço.
+ */
+void sched_run(void) {
+    while (true) {
+        if (sched_dispatch()) {
+            continue;
+        }
+        if (sched_idle_hook && sched_idle_hook()) {
+            continue;
+        }
+
+        uint64_t start = hal_time_us();
+        hal_wait_for_event();
+        stats_sleep_us += hal_time_us() - start;
+        stats_wakeups++;
+        stats_woke = true;
+    }
+}
+
+/**
+ * Eventos descartados por falta de espaço na fila.
+ */
+uint32_t sched_dropped_events(void) {
+    return sched_dropped;
+}
+
+/**
+ * Copia as medidas acumuladas (se stats não é NULL) e, com reset, recomeça a contagem.
+ * O ciclo de trabalho é 1 - sleep_us / elapsed_us.
+ */
+void sched_get_stats(sched_stats_t *stats, bool reset) {
+    uint64_t now = hal_time_us();
+
+    if (stats) {
+        stats->elapsed_us = now - stats_start_us;
+        stats->sleep_us = stats_sleep_us;
+        stats->wakeups = stats_wakeups;
+        stats->latency_count = stats_latency_count;
+        stats->latency_max_us = stats_latency_max_us;
+        stats->latency_sum_us = stats_latency_sum_us;
+    }
+    if (reset) {
+        stats_start_us = now;
+        stats_sleep_us = 0;
+        stats_wakeups = 0;
+        stats_latency_count = 0;
+        stats_latency_max_us = 0;
+        stats_latency_sum_us = 0;
+    }
+}
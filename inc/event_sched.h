@@ -0,0 +1,57 @@
+#include "hal.h"
+
+#ifndef event_sched_inc_h
+#define event_sched_inc_h
+
+#define SCHED_QUEUE_LENGTH 32 // Eventos pendentes (potência de 2)
+#define SCHED_MAX_TIMERS 8 // Prazos de disparo único simultâneos (ids 0 a 7)
+
+// Tipos de evento que movem a máquina de estados
+typedef enum {
+    EVENT_NONE = 0,
+    EVENT_AUDIO_BLOCK, // Há relatórios novos do core de áudio
+    EVENT_BUTTON, // Borda de descida em um botão (arg = gpio)
+    EVENT_FLUSH_DONE, // O display terminou de receber um quadro
+    EVENT_TIMER, // Um prazo expirou (arg = id do timer)
+    EVENT_TICK, // Tique periódico da interface
+} event_type_t;
+
+typedef struct {
+    uint16_t type;
+    uint16_t arg;
+    uint32_t data; // Uso interno para EVENT_TIMER (geração do timer)
+    uint32_t posted_us; // Quando o evento aconteceu (32 bits de hal_time_us())
+} event_t;
+
+// Medidas do laço principal para avaliar a economia de energia: quanto tempo ele passa
+// dormindo e quanto demora, depois de acordar, para tratar o evento que o acordou
+typedef struct {
+    uint64_t elapsed_us; // Desde a última zeragem
+    uint64_t sleep_us; // Dentro de hal_wait_for_event()
+    uint32_t wakeups;
+    uint32_t latency_count; // Eventos tratados logo depois de acordar
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;
+} sched_stats_t;
+
+// Tratador de eventos: roda até o fim, sem bloquear
+typedef void (*event_handler_t)(const event_t *event);
+// Chamada antes de dormir; retorna true se postou algum evento
+typedef bool (*sched_idle_hook_t)(void);
+
+void sched_init(event_handler_t handler);
+bool sched_post(event_type_t type, uint16_t arg);
+bool sched_post_since(event_type_t type, uint16_t arg, uint64_t since_us);
+bool sched_timer_start(uint id, uint32_t delay_ms);
+bool sched_timer_start_at(uint id, uint64_t deadline_us);
+void sched_timer_cancel(uint id);
+bool sched_timer_active(uint id);
+bool sched_tick_start(int32_t period_ms);
+void sched_set_idle_hook(sched_idle_hook_t hook);
+bool sched_dispatch(void);
+void sched_run(void);
+uint32_t sched_now_ms(void);
+uint32_t sched_dropped_events(void);
+void sched_get_stats(sched_stats_t *stats, bool reset);
+
+#endif
@@ -0,0 +1,134 @@
+#include "fft.h"
+
+// Tabelas pré-calculadas para FFT_SIZE = 256, em Q15 (só inteiros em tempo de execução)
+
+// cos(2*pi*k/256) e sin(2*pi*k/256), k = 0..127
+static const int16_t fft_cos[FFT_SIZE / 2] = {
+    32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285, 32137, 31971, 31785, 31580,
+    31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268, 28898, 28510, 28105, 27683,
+    27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731, 23170, 22594, 22005, 21403,
+    20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151, 15446, 14732, 14010, 13279,
+    12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179, 6393, 5602, 4808, 4011,
+    3212, 2410, 1608, 804, 0, -804, -1608, -2410, -3212, -4011, -4808, -5602,
+    -6393, -7179, -7962, -8739, -9512, -10278, -11039, -11793, -12539, -13279, -14010, -14732,
+    -15446, -16151, -16846, -17530, -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790, -27245, -27683, -28105, -28510,
+    -28898, -29268, -29621, -29956, -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+};
+
+static const int16_t fft_sin[FFT_SIZE / 2] = {
+    0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+    9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+    18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594, 23170, 23731, 24279, 24811,
+    25329, 25832, 26319, 26790, 27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+    30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521,
+    32609, 32678, 32728, 32757, 32767, 32757, 32728, 32678, 32609, 32521, 32412, 32285,
+    32137, 31971, 31785, 31580, 31356, 31113, 30852, 30571, 30273, 29956, 29621, 29268,
+    28898, 28510, 28105, 27683, 27245, 26790, 26319, 25832, 25329, 24811, 24279, 23731,
+    23170, 22594, 22005, 21403, 20787, 20159, 19519, 18868, 18204, 17530, 16846, 16151,
+    15446, 14732, 14010, 13279, 12539, 11793, 11039, 10278, 9512, 8739, 7962, 7179,
+    6393, 5602, 4808, 4011, 3212, 2410, 1608, 804,
+};
+
+// Metade da janela de Hann simétrica: 0.5 * (1 - cos(2*pi*n/255)), n = 0..127
+static const int16_t fft_hann[FFT_SIZE / 2] = {
+    0, 5, 20, 45, 80, 124, 179, 243, 317, 401, 495, 598,
+    711, 833, 965, 1106, 1257, 1416, 1585, 1763, 1949, 2145, 2349, 2561,
+    2782, 3011, 3249, 3494, 3747, 4008, 4276, 4552, 4834, 5124, 5421, 5724,
+    6034, 6350, 6672, 7000, 7334, 7673, 8018, 8367, 8722, 9081, 9444, 9812,
+    10184, 10559, 10938, 11321, 11706, 12094, 12485, 12879, 13274, 13671, 14070, 14470,
+    14872, 15274, 15677, 16081, 16484, 16888, 17291, 17694, 18096, 18497, 18897, 19295,
+    19691, 20085, 20477, 20867, 21254, 21638, 22019, 22396, 22770, 23139, 23505, 23866,
+    24223, 24575, 24922, 25264, 25601, 25932, 26257, 26576, 26889, 27195, 27495, 27789,
+    28075, 28354, 28626, 28891, 29148, 29397, 29638, 29871, 30096, 30313, 30521, 30721,
+    30912, 31094, 31267, 31432, 31587, 31732, 31869, 31996, 32114, 32222, 32320, 32409,
+    32488, 32557, 32617, 32666, 32706, 32736, 32756, 32766,
+};
+
+/**
+ * FFT complexa radix-2 (dizimação no tempo), no lugar, para N = 2^log2n <= FFT_SIZE.
+ * Cada estágio divide por 2, então a saída é X[k] / N e nunca estoura, sem checagem.
+ * Só usa multiplicações 16x16 -> 32 bits (uma instrução no Cortex-M0+).
+ */
+void fft_q15(fft_complex_t *data, uint32_t log2n) {
+    uint32_t n = 1u << log2n;
+
+    // Permutação por inversão de bits
+    for (uint32_t i = 1, j = 0; i < n; i++) {
+        uint32_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+
+        if (i < j) {
+            fft_complex_t t = data[i];
+            data[i] = data[j];
+            data[j] = t;
+        }
+    }
+
+    for (uint32_t len = 2; len <= n; len <<= 1) {
+        uint32_t half = len >> 1;
+        uint32_t step = FFT_SIZE / len; // Passo na tabela de fatores
+
+        for (uint32_t k = 0; k < half; k++) {
+            // Fator e^(-j*2*pi*k/len)
+            int32_t wr = fft_cos[k * step];
+            int32_t wi = -fft_sin[k * step];
+
+            for (uint32_t i = k; i < n; i += len) {
+                fft_complex_t *a = &data[i];
+                fft_complex_t *b = &data[i + half];
+                int32_t tr = (b->re * wr - b->im * wi) >> 15;
+                int32_t ti = (b->re * wi + b->im * wr) >> 15;
+                int32_t ar = a->re;
+                int32_t ai = a->im;
+
+                a->re = (ar + tr) >> 1;
+                a->im = (ai + ti) >> 1;
+                b->re = (ar - tr) >> 1;
+                b->im = (ai - ti) >> 1;
+            }
+        }
+    }
+}
+
+/**
+ * Prepara FFT_SIZE amostras do ADC para a transformada: tira o DC, leva 12 bits para Q15 e
+ * aplica a janela de Hann. A parte imaginária fica zerada.
+ */
+void fft_load_hann(fft_complex_t *out, const uint16_t *samples, uint32_t dc) {
+    for (uint32_t i = 0; i < FFT_SIZE; i++) {
+        int32_t v = ((int32_t)samples[i] - (int32_t)dc) << 4;
+        uint32_t w = i < FFT_SIZE / 2 ? i : FFT_SIZE - 1 - i;
+
+        if (v > 32767) v = 32767;
+        if (v < -32767) v = -32767;
+
+        out[i].re = (v * fft_hann[w]) >> 15;
+        out[i].im = 0;
+    }
+}
+
+/**
+ * Potência de um ponto (re^2 + im^2); cabe em 32 bits para entradas em Q15.
+ */
+uint32_t fft_power(const fft_complex_t *x) {
+    return (uint32_t)(x->re * x->re) + (uint32_t)(x->im * x->im);
+}
+
+/**
+ * log2(x) em Q4 (1/16 de oitava, ~0,19 dB de potência), com a mantissa aproximada linearmente.
+ * Retorna 0 para x <= 1.
+ */
+uint16_t fft_log2_q4(uint32_t x) {
+    if (x <= 1) {
+        return 0;
+    }
+
+    uint32_t e = 31 - __builtin_clz(x);
+    uint32_t frac = e >= 4 ? (x >> (e - 4)) & 0xF : (x << (4 - e)) & 0xF;
+    return (e << 4) | frac;
+}
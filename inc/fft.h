@@ -0,0 +1,21 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef fft_inc_h
+#define fft_inc_h
+
+#define FFT_LOG2_SIZE 8
+#define FFT_SIZE (1u << FFT_LOG2_SIZE) // Maior transformada suportada (tamanho das tabelas)
+
+// Complexo em Q15
+typedef struct {
+    int16_t re;
+    int16_t im;
+} fft_complex_t;
+
+void fft_q15(fft_complex_t *data, uint32_t log2n);
+void fft_load_hann(fft_complex_t *out, const uint16_t *samples, uint32_t dc);
+uint32_t fft_power(const fft_complex_t *x);
+uint16_t fft_log2_q4(uint32_t x);
+
+#endif
@@ -0,0 +1,96 @@
+#ifndef hal_inc_h
+#define hal_inc_h
+
+// Camada fina entre a aplicação e o hardware. Os módulos da aplicação só usam estas funções;
+// hal_pico.c as implementa com o pico-sdk e hal_host.c com um simulador para Linux
+// (ADC lido de WAV, OLED salvo em PBM, LEDs em log, tempo virtual).
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef HAL_HOST
+#include <assert.h>
+typedef unsigned int uint;
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define _u(x) x##u
+#ifndef PICO_ON_DEVICE
+#define PICO_ON_DEVICE 0
+#endif
+#else
+#include "pico/stdlib.h"
+#endif
+
+// Tempo e alarmes (semântica dos alarmes do pico-sdk: retornar > 0 reagenda para tantos
+// microssegundos depois do disparo anterior, < 0 para tantos depois de agora, 0 encerra)
+typedef int32_t hal_alarm_id_t;
+typedef int64_t (*hal_alarm_cb_t)(hal_alarm_id_t id, void *user_data);
+
+uint64_t hal_time_us(void);
+uint32_t hal_time_ms(void);
+void hal_sleep_ms(uint32_t ms);
+hal_alarm_id_t hal_alarm_in_us(uint64_t delay_us, hal_alarm_cb_t callback, void *user_data);
+bool hal_alarm_cancel(hal_alarm_id_t id);
+
+// Interrupções e eventos entre cores
+uint32_t hal_irq_save(void);
+void hal_irq_restore(uint32_t state);
+void hal_wait_for_event(void);
+void hal_signal_event(void);
+void hal_launch_core1(void (*entry)(void));
+uint hal_core_num(void);
+void hal_stdio_init(void);
+int hal_stdio_getchar(void); // Próximo caractere recebido, ou -1 se não há nenhum (não bloqueia)
+
+// GPIO
+typedef void (*hal_gpio_cb_t)(uint gpio, uint32_t events);
+
+void hal_gpio_input_pullup(uint gpio);
+bool hal_gpio_get(uint gpio);
+void hal_gpio_on_falling_edge(uint gpio, hal_gpio_cb_t callback);
+
+// ADC: captura contínua por DMA num buffer em anel de 'blocks' blocos, mais leituras avulsas.
+// Com mais de um canal na máscara, o ADC alterna entre eles (round-robin) e as amostras
+// chegam intercaladas em ordem crescente de canal; 'sample_rate' é a taxa de cada canal e
+// 'block_samples' conta as amostras de todos (múltiplo do número de canais).
+typedef void (*hal_adc_block_cb_t)(uint block_index);
+
+void hal_adc_stream_init(uint channel_mask, uint32_t sample_rate, uint16_t *ring, uint block_samples, uint blocks, hal_adc_block_cb_t callback);
+void hal_adc_stream_start(void);
+void hal_adc_stream_stop(void);
+uint16_t hal_adc_read(uint channel);
+
+// I2C: escrita bloqueante e escrita assíncrona de palavras no formato de IC_DATA_CMD
+// (byte nos bits 7..0; HAL_I2C_STOP encerra a transação depois daquele byte)
+#define HAL_I2C_STOP (1u << 9)
+
+void hal_i2c_init(uint bus, uint sda, uint scl, uint32_t baud_hz);
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *data, size_t length);
+bool hal_i2c_write_async(uint bus, uint8_t address, const uint16_t *words, uint count, void (*done)(bool ok));
+
+// PIO: fita de LEDs WS2812 (palavras GRB alinhadas à esquerda); 'done' roda após o RESET
+void hal_leds_init(uint gpio, uint count);
+void hal_leds_write_async(const uint32_t *words, uint count, void (*done)(void));
+
+// Clock do sistema: trocá-lo reajusta o I2C e os LEDs (espera os envios em andamento); o ADC e
+// os alarmes têm clocks próprios. Divisores do PWM calculados antes da troca ficam errados.
+uint32_t hal_sys_clock_hz(void);
+bool hal_set_sys_clock_khz(uint32_t khz);
+
+// PWM
+void hal_pwm_start(uint gpio, uint8_t div_int, uint8_t div_frac, uint16_t wrap, uint16_t level);
+void hal_pwm_stop(uint gpio);
+
+// Flash: área de dados no fim da memória, fora do programa. Os offsets são relativos ao início
+// da área; apagar deixa os bytes em 0xFF e gravar só leva bits de 1 para 0 (NOR). As duas
+// operações param o outro core e as interrupções enquanto rodam.
+#define HAL_FLASH_SECTOR_SIZE 4096u // Menor unidade de apagamento
+#define HAL_FLASH_BLOCK_SIZE 65536u // Apagamento rápido (offset e tamanho múltiplos deste)
+#define HAL_FLASH_PAGE_SIZE 256u // Unidade de gravação
+#define HAL_FLASH_DATA_SIZE (1024u * 1024u) // Tamanho da área de dados
+
+void hal_flash_erase(uint32_t offset, uint32_t length);
+void hal_flash_program(uint32_t offset, const uint8_t *data, uint32_t length);
+const uint8_t *hal_flash_data(uint32_t offset);
+
+#endif
@@ -0,0 +1,1015 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "hal.h"
+
+// Implementação da HAL para Linux: o firmware roda inteiro num só thread, com tempo virtual.
+// As "interrupções" (alarmes, blocos do ADC, fim de envio no I2C/LEDs) rodam dentro de
+// hal_wait_for_event() e hal_sleep_ms(), que saltam o relógio direto para o próximo alarme;
+// por isso a simulação é determinística e roda muitas vezes mais rápido que o tempo real.
+//
+// Configuração por variáveis de ambiente:
+//   SACD_WAV     arquivos WAV (PCM 16 bits, separados por ':') tocados em sequência no
+//                canal do microfone (2); os outros canais da captura seguem SACD_ADC
+//   SACD_OUT     diretório de saída (padrão "sim_out"): oled_<ms>.pbm, leds.log, pwm.log;
+//                vazio desliga as saídas (p. ex. nos benchmarks)
+//   SACD_SIM_MS  duração da simulação em ms de tempo virtual (padrão 10000; 0 = sem limite)
+//   SACD_BUTTONS pressionamentos "ms:gpio,..." (o pino fica em nível baixo por 100 ms)
+//   SACD_ADC     leituras avulsas "ms:canal:valor,..." (p. ex. o joystick); padrão 2048
+//   SACD_CONSOLE linhas digitadas na stdio "ms:texto,..." (p. ex. "20000:dump")
+//   SACD_FLASH   arquivo com a área de dados da flash, lido no início e atualizado a cada
+//                operação (sem ele, a flash começa apagada e some no fim)
+//   SACD_FLASH_CUT  "n[:semente]": falta de energia no meio da n-ésima operação da flash
+//                (contando do boot); a operação fica pela metade, com bits ao acaso, e a
+//                simulação termina ali. Rodar de novo sobre o mesmo SACD_FLASH mostra o que
+//                sobreviveu, e variar n e a semente faz um fuzzing de queda de energia
+//   SACD_CPU_SCALE  quanto o firmware leva na placa para cada unidade de tempo de CPU no host
+//                (p. ex. 40, da razão entre bench/ na placa e no host); o tempo gasto fora da
+//                HAL avança o relógio virtual nessa escala (e na razão do clock reduzido), e o
+//                ciclo de trabalho e a latência saem diferentes de zero. Padrão 0: o firmware
+//                não gasta tempo e a simulação é determinística
+
+#define HOST_MAX_ALARMS 32
+#define HOST_MAX_SCRIPT 64
+#define HOST_CONSOLE_LINE 32
+#define HOST_MAX_GPIO 30
+#define HOST_BUTTON_PRESS_US 100000
+#define HOST_SYS_CLOCK_HZ 125000000
+#define HOST_LEDS_LATCH_US (8 * 30 + 30 + 100)
+#define HOST_ADC_MIDSCALE 2048
+#define HOST_MIC_CHANNEL 2 // Canal do microfone na BitDogLab: é o que toca os WAV
+#define HOST_ADC_CHANNELS 5
+
+// ---------------------------------------------------------------------------
+// Relógio virtual e alarmes
+
+typedef struct {
+    hal_alarm_id_t id; // 0 quando livre
+    uint64_t when;
+    hal_alarm_cb_t callback;
+    void *user_data;
+} host_alarm_t;
+
+static uint64_t host_now_us;
+static uint64_t host_end_us;
+static host_alarm_t host_alarms[HOST_MAX_ALARMS];
+static hal_alarm_id_t host_next_id = 1;
+static bool host_event = false;
+static bool host_ready = false;
+
+static const char *host_out_dir = "sim_out";
+static FILE *host_leds_log;
+static FILE *host_pwm_log;
+static FILE *host_flash_file;
+static uint32_t host_frames;
+static uint32_t host_led_frames;
+static clock_t host_wall_start;
+static double host_cpu_scale; // SACD_CPU_SCALE
+static uint64_t host_cpu_mark_ns; // Tempo de CPU do thread já contado
+static double host_cpu_carry_us; // Fração de us ainda não somada ao relógio
+static uint32_t host_sys_clock_hz = HOST_SYS_CLOCK_HZ;
+
+static void host_setup(void);
+
+// Alarme pendente mais cedo (em empate, o mais antigo), ou NULL
+static host_alarm_t *host_next_alarm(void) {
+    host_alarm_t *next = NULL;
+
+    for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+        host_alarm_t *a = &host_alarms[i];
+        if (a->id && (!next || a->when < next->when || (a->when == next->when && a->id < next->id))) {
+            next = a;
+        }
+    }
+    return next;
+}
+
+// Fim da simulação: fecha os logs e encerra o processo (o firmware nunca retorna de main)
+static void host_finish(void) {
+    double wall = (double)(clock() - host_wall_start) / CLOCKS_PER_SEC;
+
+    if (host_leds_log) fclose(host_leds_log);
+    if (host_pwm_log) fclose(host_pwm_log);
+    if (host_flash_file) fclose(host_flash_file);
+
+    fprintf(stderr, "sim: %llu ms simulados em %.3f s, %u quadros do OLED, %u quadros dos LEDs\n",
+            (unsigned long long)(host_now_us / 1000), wall, host_frames, host_led_frames);
+    exit(0);
+}
+
+// Ocupa uma posição livre da tabela de alarmes
+static hal_alarm_id_t host_alarm_insert(hal_alarm_id_t id, uint64_t when, hal_alarm_cb_t callback, void *user_data) {
+    for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+        host_alarm_t *a = &host_alarms[i];
+        if (!a->id) {
+            a->id = id;
+            a->when = when;
+            a->callback = callback;
+            a->user_data = user_data;
+            return id;
+        }
+    }
+    return -1;
+}
+
+// Dispara o próximo alarme, se vencer até 'limit'; retorna false se não havia nenhum
+static bool host_run_alarm(uint64_t limit) {
+    host_alarm_t *a = host_next_alarm();
+
+    if (!a || a->when > limit) {
+        return false;
+    }
+    if (a->when > host_end_us) {
+        host_now_us = host_end_us;
+        host_finish();
+    }
+
+    if (a->when > host_now_us) {
+        host_now_us = a->when;
+    }
+
+    // Libera a posição antes do callback, que pode criar outros alarmes
+    host_alarm_t fired = *a;
+    a->id = 0;
+
+    int64_t next = fired.callback(fired.id, fired.user_data);
+    if (next != 0) {
+        // Reagenda com o mesmo id, como o pico-sdk
+        uint64_t when = next > 0 ? fired.when + next : host_now_us - next;
+        host_alarm_insert(fired.id, when, fired.callback, fired.user_data);
+    }
+    return true;
+}
+
+static uint64_t host_cpu_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+// Com SACD_CPU_SCALE, leva ao relógio virtual o tempo de CPU do firmware desde a última
+// marca, no clock atual. Chamada ao entrar na HAL; host_cpu_mark() na saída descarta o
+// tempo da própria simulação (alarmes, arquivos de saída).
+static void host_cpu_charge(void) {
+    if (host_cpu_scale <= 0) {
+        return;
+    }
+    uint64_t now = host_cpu_ns();
+    double us = (now - host_cpu_mark_ns) / 1000.0 * host_cpu_scale * HOST_SYS_CLOCK_HZ / host_sys_clock_hz + host_cpu_carry_us;
+
+    host_cpu_mark_ns = now;
+    host_now_us += (uint64_t)us;
+    host_cpu_carry_us = us - (uint64_t)us;
+}
+
+static void host_cpu_mark(void) {
+    if (host_cpu_scale > 0) {
+        host_cpu_mark_ns = host_cpu_ns();
+    }
+}
+
+uint64_t hal_time_us(void) {
+    host_cpu_charge();
+    return host_now_us;
+}
+
+uint32_t hal_time_ms(void) {
+    host_cpu_charge();
+    return host_now_us / 1000;
+}
+
+// Avança o relógio, disparando os alarmes que vencerem no caminho
+void hal_sleep_ms(uint32_t ms) {
+    host_cpu_charge();
+    uint64_t target = host_now_us + (uint64_t)ms * 1000;
+
+    while (host_run_alarm(target)) {
+    }
+    if (target > host_end_us) {
+        host_now_us = host_end_us;
+        host_finish();
+    }
+    host_now_us = target;
+    host_cpu_mark();
+}
+
+hal_alarm_id_t hal_alarm_in_us(uint64_t delay_us, hal_alarm_cb_t callback, void *user_data) {
+    host_cpu_charge();
+    hal_alarm_id_t id = host_alarm_insert(host_next_id, host_now_us + delay_us, callback, user_data);
+
+    if (id > 0) {
+        host_next_id++;
+    }
+    return id;
+}
+
+bool hal_alarm_cancel(hal_alarm_id_t id) {
+    for (uint i = 0; i < HOST_MAX_ALARMS; i++) {
+        if (id > 0 && host_alarms[i].id == id) {
+            host_alarms[i].id = 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t hal_irq_save(void) {
+    return 0;
+}
+
+void hal_irq_restore(uint32_t state) {
+    (void)state;
+}
+
+// Equivale a dormir até a próxima interrupção: dispara o próximo alarme
+void hal_wait_for_event(void) {
+    host_cpu_charge();
+    if (host_event) {
+        host_event = false;
+        return;
+    }
+    if (!host_run_alarm(UINT64_MAX)) {
+        fprintf(stderr, "sim: nenhum alarme pendente, o firmware dormiria para sempre\n");
+        host_finish();
+    }
+    host_cpu_mark();
+}
+
+void hal_signal_event(void) {
+    host_event = true;
+}
+
+// O simulador tem um só thread: o áudio deve ser compilado com AUDIO_DUAL_CORE=0
+void hal_launch_core1(void (*entry)(void)) {
+    (void)entry;
+    fprintf(stderr, "sim: core1 não é simulado; compile com AUDIO_DUAL_CORE=0\n");
+    abort();
+}
+
+uint hal_core_num(void) {
+    return 0;
+}
+
+void hal_stdio_init(void) {
+    host_setup();
+}
+
+// Console: as linhas de SACD_CONSOLE chegam, caractere a caractere, a partir do seu instante
+typedef struct {
+    uint32_t ms;
+    char text[HOST_CONSOLE_LINE];
+} host_console_line_t;
+
+static host_console_line_t host_console[HOST_MAX_SCRIPT];
+static uint host_console_count;
+static uint host_console_line;
+static uint host_console_pos;
+
+int hal_stdio_getchar(void) {
+    if (host_console_line >= host_console_count || host_now_us < (uint64_t)host_console[host_console_line].ms * 1000) {
+        return -1;
+    }
+
+    const char *text = host_console[host_console_line].text;
+    if (text[host_console_pos]) {
+        return text[host_console_pos++];
+    }
+    host_console_line++;
+    host_console_pos = 0;
+    return '\n';
+}
+
+// Lê "ms:texto,..." (o texto vai até a próxima vírgula)
+static uint host_parse_console(const char *text) {
+    uint count = 0;
+
+    while (text && *text && count < HOST_MAX_SCRIPT) {
+        unsigned ms;
+        int used = 0;
+        if (sscanf(text, "%u:%n", &ms, &used) != 1 || used == 0) {
+            fprintf(stderr, "sim: console inválido: %s\n", text);
+            break;
+        }
+        text += used;
+        size_t length = strcspn(text, ",");
+        if (length >= HOST_CONSOLE_LINE) {
+            length = HOST_CONSOLE_LINE - 1;
+        }
+        host_console[count].ms = ms;
+        memcpy(host_console[count].text, text, length);
+        host_console[count].text[length] = 0;
+        count++;
+
+        text = strchr(text, ',');
+        if (text) text++;
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// Roteiros (botões e leituras avulsas do ADC)
+
+typedef struct {
+    uint32_t ms;
+    uint16_t a, b;
+} host_script_t;
+
+static host_script_t host_buttons[HOST_MAX_SCRIPT];
+static uint host_button_count;
+static host_script_t host_adc_values[HOST_MAX_SCRIPT];
+static uint host_adc_value_count;
+
+// Lê "n:n[:n],..." em 'out'; retorna quantos itens foram lidos
+static uint host_parse_script(const char *text, host_script_t *out, uint max, uint fields) {
+    uint count = 0;
+
+    while (text && *text && count < max) {
+        unsigned ms, a = 0, b = 0;
+        int n = fields == 3 ? sscanf(text, "%u:%u:%u", &ms, &a, &b) : sscanf(text, "%u:%u", &ms, &a);
+        if (n != (int)fields) {
+            fprintf(stderr, "sim: roteiro inválido: %s\n", text);
+            break;
+        }
+        out[count].ms = ms;
+        out[count].a = a;
+        out[count].b = b;
+        count++;
+
+        text = strchr(text, ',');
+        if (text) text++;
+    }
+    return count;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO: entradas com pull-up; os botões do roteiro puxam o pino para baixo
+
+static bool host_gpio_low[HOST_MAX_GPIO];
+static hal_gpio_cb_t host_gpio_callback[HOST_MAX_GPIO];
+
+static int64_t host_button_release(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    host_gpio_low[(uintptr_t)user_data] = false;
+    return 0;
+}
+
+static int64_t host_button_press(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    uint gpio = (uintptr_t)user_data;
+
+    host_gpio_low[gpio] = true;
+    if (host_gpio_callback[gpio]) {
+        host_gpio_callback[gpio](gpio, 0x4); // GPIO_IRQ_EDGE_FALL
+    }
+    hal_alarm_in_us(HOST_BUTTON_PRESS_US, host_button_release, user_data);
+    return 0;
+}
+
+void hal_gpio_input_pullup(uint gpio) {
+    host_gpio_low[gpio] = false;
+}
+
+bool hal_gpio_get(uint gpio) {
+    return !host_gpio_low[gpio];
+}
+
+void hal_gpio_on_falling_edge(uint gpio, hal_gpio_cb_t callback) {
+    host_gpio_callback[gpio] = callback;
+}
+
+// ---------------------------------------------------------------------------
+// ADC: as amostras vêm dos WAV, reamostrados para a taxa da captura
+
+typedef struct {
+    int16_t *samples;
+    uint32_t count;
+    uint32_t rate;
+} host_wav_t;
+
+#define HOST_MAX_WAVS 8
+static host_wav_t host_wavs[HOST_MAX_WAVS];
+static uint host_wav_count;
+
+static uint16_t *host_adc_samples; // Sequência completa, já em contagens de 12 bits
+static uint32_t host_adc_length;
+static uint32_t host_adc_pos;
+
+static uint16_t *host_adc_ring;
+static uint host_adc_block_samples;
+static uint host_adc_blocks;
+static uint32_t host_adc_rate;
+static uint64_t host_adc_start_us;
+static uint64_t host_adc_done;
+static hal_adc_block_cb_t host_adc_callback;
+static hal_alarm_id_t host_adc_alarm;
+static uint host_adc_channels[HOST_ADC_CHANNELS]; // Ordem do round-robin
+static uint host_adc_channel_count;
+
+static uint32_t host_read_le(const uint8_t *p, uint bytes) {
+    uint32_t v = 0;
+    for (uint i = 0; i < bytes; i++) {
+        v |= (uint32_t)p[i] << (8 * i);
+    }
+    return v;
+}
+
+// Carrega o primeiro canal de um WAV PCM de 16 bits
+static bool host_load_wav(const char *path, host_wav_t *wav) {
+    FILE *f = fopen(path, "rb");
+    uint8_t header[12], chunk[8], fmt[16];
+    uint channels = 0, bits = 0;
+    bool ok = false;
+
+    if (!f) {
+        fprintf(stderr, "sim: não foi possível abrir %s\n", path);
+        return false;
+    }
+
+    if (fread(header, 1, 12, f) != 12 || memcmp(header, "RIFF", 4) || memcmp(header + 8, "WAVE", 4)) {
+        fprintf(stderr, "sim: %s não é um WAV\n", path);
+        fclose(f);
+        return false;
+    }
+
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = host_read_le(chunk + 4, 4);
+
+        if (!memcmp(chunk, "fmt ", 4) && size >= 16) {
+            if (fread(fmt, 1, 16, f) != 16) break;
+            channels = host_read_le(fmt + 2, 2);
+            wav->rate = host_read_le(fmt + 4, 4);
+            bits = host_read_le(fmt + 14, 2);
+            fseek(f, size - 16 + (size & 1), SEEK_CUR);
+        }
+        else if (!memcmp(chunk, "data", 4)) {
+            if (host_read_le(fmt, 2) != 1 || bits != 16 || channels == 0) {
+                fprintf(stderr, "sim: %s: só PCM de 16 bits é suportado\n", path);
+                break;
+            }
+
+            uint32_t frames = size / (2 * channels);
+            int16_t *raw = malloc(size);
+            wav->samples = malloc(frames * sizeof(int16_t));
+            frames = fread(raw, 2 * channels, frames, f);
+            for (uint32_t i = 0; i < frames; i++) {
+                wav->samples[i] = (int16_t)host_read_le((const uint8_t *)&raw[i * channels], 2);
+            }
+            wav->count = frames;
+            free(raw);
+            ok = true;
+            break;
+        }
+        else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fclose(f);
+    return ok;
+}
+
+// Converte os WAV na sequência do ADC: vizinho mais próximo na taxa da captura,
+// 16 bits com sinal para 12 bits em torno do meio da escala (a polarização do microfone)
+static void host_adc_prepare(uint32_t rate) {
+    uint64_t total = 0;
+
+    for (uint i = 0; i < host_wav_count; i++) {
+        total += (uint64_t)host_wavs[i].count * rate / host_wavs[i].rate;
+    }
+
+    free(host_adc_samples);
+    host_adc_samples = malloc((total ? total : 1) * sizeof(uint16_t));
+    host_adc_length = 0;
+
+    for (uint i = 0; i < host_wav_count; i++) {
+        const host_wav_t *wav = &host_wavs[i];
+        uint32_t n = (uint64_t)wav->count * rate / wav->rate;
+
+        for (uint32_t j = 0; j < n; j++) {
+            int32_t s = wav->samples[(uint64_t)j * wav->rate / rate];
+            int32_t v = HOST_ADC_MIDSCALE + (s >> 4);
+            host_adc_samples[host_adc_length++] = v < 0 ? 0 : v > 4095 ? 4095 : v;
+        }
+    }
+}
+
+// "Interrupção" de fim de bloco: copia as próximas amostras do microfone (silêncio depois do
+// fim dos WAV) e, intercalados como no round-robin, os valores do roteiro dos outros canais
+static int64_t host_adc_block(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    uint index = host_adc_done % host_adc_blocks;
+    uint16_t *block = host_adc_ring + index * host_adc_block_samples;
+    uint16_t values[HOST_ADC_CHANNELS];
+
+    for (uint c = 0; c < host_adc_channel_count; c++) {
+        values[c] = hal_adc_read(host_adc_channels[c]);
+    }
+
+    for (uint i = 0; i < host_adc_block_samples; i++) {
+        uint c = i % host_adc_channel_count;
+        if (host_adc_channels[c] != HOST_MIC_CHANNEL) {
+            block[i] = values[c];
+        }
+        else {
+            block[i] = host_adc_pos < host_adc_length ? host_adc_samples[host_adc_pos++] : HOST_ADC_MIDSCALE;
+        }
+    }
+
+    host_adc_done++;
+    host_adc_callback(index);
+
+    // Próximo bloco no instante exato, sem acumular o arredondamento do período
+    uint64_t rate = (uint64_t)host_adc_rate * host_adc_channel_count;
+    uint64_t now = host_adc_start_us + (host_adc_done * host_adc_block_samples * 1000000) / rate;
+    uint64_t next = host_adc_start_us + ((host_adc_done + 1) * host_adc_block_samples * 1000000) / rate;
+    return next - now;
+}
+
+void hal_adc_stream_init(uint channel_mask, uint32_t sample_rate, uint16_t *ring, uint block_samples, uint blocks, hal_adc_block_cb_t callback) {
+    host_setup();
+
+    host_adc_channel_count = 0;
+    for (uint channel = 0; channel < HOST_ADC_CHANNELS; channel++) {
+        if (channel_mask & (1u << channel)) {
+            host_adc_channels[host_adc_channel_count++] = channel;
+        }
+    }
+
+    host_adc_ring = ring;
+    host_adc_block_samples = block_samples;
+    host_adc_blocks = blocks;
+    host_adc_rate = sample_rate;
+    host_adc_callback = callback;
+    host_adc_prepare(sample_rate);
+}
+
+void hal_adc_stream_start(void) {
+    hal_adc_stream_stop();
+
+    host_adc_start_us = host_now_us;
+    host_adc_done = 0;
+    host_adc_alarm = hal_alarm_in_us((uint64_t)host_adc_block_samples * 1000000 / ((uint64_t)host_adc_rate * host_adc_channel_count), host_adc_block, NULL);
+}
+
+void hal_adc_stream_stop(void) {
+    if (host_adc_alarm > 0) {
+        hal_alarm_cancel(host_adc_alarm);
+        host_adc_alarm = 0;
+    }
+}
+
+// Último valor do roteiro para o canal até agora
+uint16_t hal_adc_read(uint channel) {
+    uint16_t value = HOST_ADC_MIDSCALE;
+
+    for (uint i = 0; i < host_adc_value_count; i++) {
+        if (host_adc_values[i].a == channel && (uint64_t)host_adc_values[i].ms * 1000 <= host_now_us) {
+            value = host_adc_values[i].b;
+        }
+    }
+    return value;
+}
+
+// ---------------------------------------------------------------------------
+// I2C: emulação da memória do SSD1306, gravada em PBM a cada quadro alterado
+
+#define HOST_OLED_ADDRESS 0x3C
+#define HOST_OLED_WIDTH 128
+#define HOST_OLED_PAGES 8
+
+static uint32_t host_i2c_baud[2] = {100000, 100000};
+
+static struct {
+    uint8_t ram[HOST_OLED_PAGES][HOST_OLED_WIDTH];
+    uint8_t saved[HOST_OLED_PAGES][HOST_OLED_WIDTH];
+    uint8_t mode; // 0: horizontal, 1: vertical, 2: página
+    uint8_t col, col_start, col_end;
+    uint8_t page, page_start, page_end;
+    uint8_t command; // Comando à espera de argumentos
+    uint8_t args[6];
+    uint8_t args_needed, args_count;
+    bool control; // Próximo byte é de controle
+    bool continuation; // Co = 1: um só byte antes do próximo controle
+    bool data; // D/C# = 1
+} oled;
+
+// Argumentos de cada comando do SSD1306
+static uint8_t host_oled_arg_count(uint8_t command) {
+    switch (command) {
+        case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3:
+        case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+            return 1;
+        case 0x21: case 0x22: case 0xA3:
+            return 2;
+        case 0x29: case 0x2A:
+            return 5;
+        case 0x26: case 0x27:
+            return 6;
+        default:
+            return 0;
+    }
+}
+
+static void host_oled_execute(void) {
+    uint8_t c = oled.command;
+
+    if (c == 0x20) {
+        oled.mode = oled.args[0] & 3;
+    }
+    else if (c == 0x21) {
+        oled.col_start = oled.col = oled.args[0] & 0x7F;
+        oled.col_end = oled.args[1] & 0x7F;
+    }
+    else if (c == 0x22) {
+        oled.page_start = oled.page = oled.args[0] & 7;
+        oled.page_end = oled.args[1] & 7;
+    }
+    else if (c >= 0xB0 && c <= 0xB7) {
+        oled.page = c & 7;
+    }
+    else if (c <= 0x0F && oled.mode == 2) {
+        oled.col = (oled.col & 0xF0) | c;
+    }
+    else if (c >= 0x10 && c <= 0x17 && oled.mode == 2) {
+        oled.col = (oled.col & 0x0F) | ((c & 7) << 4);
+    }
+}
+
+static void host_oled_command(uint8_t byte) {
+    if (oled.args_needed) {
+        oled.args[oled.args_count++] = byte;
+        if (oled.args_count == oled.args_needed) {
+            oled.args_needed = 0;
+            host_oled_execute();
+        }
+        return;
+    }
+
+    oled.command = byte;
+    oled.args_count = 0;
+    oled.args_needed = host_oled_arg_count(byte);
+    if (!oled.args_needed) {
+        host_oled_execute();
+    }
+}
+
+// Escrita na memória do display, avançando o ponteiro como o controlador
+static void host_oled_data(uint8_t byte) {
+    oled.ram[oled.page][oled.col] = byte;
+
+    if (oled.mode == 1) {
+        if (oled.page++ >= oled.page_end) {
+            oled.page = oled.page_start;
+            oled.col = oled.col >= oled.col_end ? oled.col_start : oled.col + 1;
+        }
+    }
+    else if (oled.mode == 0) {
+        if (oled.col++ >= oled.col_end) {
+            oled.col = oled.col_start;
+            oled.page = oled.page >= oled.page_end ? oled.page_start : oled.page + 1;
+        }
+    }
+    else if (oled.col < HOST_OLED_WIDTH - 1) {
+        oled.col++;
+    }
+}
+
+static void host_oled_byte(uint8_t byte) {
+    if (oled.control) {
+        oled.continuation = byte & 0x80;
+        oled.data = byte & 0x40;
+        oled.control = false;
+        return;
+    }
+
+    if (oled.data) {
+        host_oled_data(byte);
+    }
+    else {
+        host_oled_command(byte);
+    }
+    oled.control = oled.continuation;
+}
+
+// Fim de transação (STOP): grava um PBM se a memória mudou desde o último quadro.
+// Pixel aceso é preto no PBM.
+static void host_oled_stop(void) {
+    char path[512];
+
+    oled.control = true;
+    if (!memcmp(oled.ram, oled.saved, sizeof(oled.ram))) {
+        return;
+    }
+    memcpy(oled.saved, oled.ram, sizeof(oled.ram));
+    host_frames++;
+    if (!host_out_dir) {
+        return;
+    }
+
+    snprintf(path, sizeof(path), "%s/oled_%08u.pbm", host_out_dir, hal_time_ms());
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        return;
+    }
+
+    fprintf(f, "P4\n%d %d\n", HOST_OLED_WIDTH, HOST_OLED_PAGES * 8);
+    for (uint y = 0; y < HOST_OLED_PAGES * 8; y++) {
+        for (uint x = 0; x < HOST_OLED_WIDTH; x += 8) {
+            uint8_t packed = 0;
+            for (uint bit = 0; bit < 8; bit++) {
+                if (oled.ram[y / 8][x + bit] & (1u << (y % 8))) {
+                    packed |= 0x80 >> bit;
+                }
+            }
+            fputc(packed, f);
+        }
+    }
+    fclose(f);
+}
+
+void hal_i2c_init(uint bus, uint sda, uint scl, uint32_t baud_hz) {
+    (void)sda;
+    (void)scl;
+    host_setup();
+    host_i2c_baud[bus & 1] = baud_hz;
+}
+
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *data, size_t length) {
+    (void)bus;
+    if (address != HOST_OLED_ADDRESS) {
+        return -2; // PICO_ERROR_GENERIC: ninguém responde nesse endereço
+    }
+
+    for (size_t i = 0; i < length; i++) {
+        host_oled_byte(data[i]);
+    }
+    host_oled_stop();
+    return length;
+}
+
+static void (*host_i2c_done)(bool ok);
+static bool host_i2c_ok;
+
+static int64_t host_i2c_complete(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    host_i2c_done(host_i2c_ok);
+    return 0;
+}
+
+// O conteúdo é entregue ao display na hora; o fim é sinalizado após o tempo de barramento
+bool hal_i2c_write_async(uint bus, uint8_t address, const uint16_t *words, uint count, void (*done)(bool ok)) {
+    host_i2c_ok = address == HOST_OLED_ADDRESS;
+
+    for (uint i = 0; i < count && host_i2c_ok; i++) {
+        host_oled_byte(words[i] & 0xFF);
+        if (words[i] & HAL_I2C_STOP) {
+            host_oled_stop();
+        }
+    }
+
+    host_i2c_done = done;
+    hal_alarm_in_us((uint64_t)count * 9 * 1000000 / host_i2c_baud[bus & 1] + 1, host_i2c_complete, NULL);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// LEDs: cada quadro vira uma linha "ms RRGGBB RRGGBB ..." em leds.log
+
+static void (*host_leds_done)(void);
+
+static int64_t host_leds_complete(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    if (host_leds_done) {
+        host_leds_done();
+    }
+    return 0;
+}
+
+void hal_leds_init(uint gpio, uint count) {
+    (void)gpio;
+    (void)count;
+    host_setup();
+}
+
+void hal_leds_write_async(const uint32_t *words, uint count, void (*done)(void)) {
+    if (host_leds_log) {
+        fprintf(host_leds_log, "%u", hal_time_ms());
+        for (uint i = 0; i < count; i++) {
+            uint32_t w = words[i];
+            fprintf(host_leds_log, " %02X%02X%02X", (w >> 16) & 0xFF, w >> 24, (w >> 8) & 0xFF);
+        }
+        fputc('\n', host_leds_log);
+    }
+    host_led_frames++;
+
+    host_leds_done = done;
+    hal_alarm_in_us(count * 30 + HOST_LEDS_LATCH_US, host_leds_complete, NULL);
+}
+
+// ---------------------------------------------------------------------------
+// Clock e PWM: cada mudança do PWM vira uma linha "ms gpio freq_hz" (ou "off") em pwm.log
+
+uint32_t hal_sys_clock_hz(void) {
+    return host_sys_clock_hz;
+}
+
+// Qualquer frequência serve; o PWM passa a usar a nova (como na placa)
+bool hal_set_sys_clock_khz(uint32_t khz) {
+    host_sys_clock_hz = khz * 1000;
+    return true;
+}
+
+void hal_pwm_start(uint gpio, uint8_t div_int, uint8_t div_frac, uint16_t wrap, uint16_t level) {
+    uint32_t div16 = div_int * 16 + div_frac;
+    uint64_t freq = (uint64_t)host_sys_clock_hz * 16 / (div16 * ((uint64_t)wrap + 1));
+
+    if (host_pwm_log) {
+        if (level) {
+            fprintf(host_pwm_log, "%u %u %llu\n", hal_time_ms(), gpio, (unsigned long long)freq);
+        }
+        else {
+            fprintf(host_pwm_log, "%u %u off\n", hal_time_ms(), gpio);
+        }
+    }
+}
+
+void hal_pwm_stop(uint gpio) {
+    if (host_pwm_log) {
+        fprintf(host_pwm_log, "%u %u off\n", hal_time_ms(), gpio);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Flash: a área de dados fica em memória, com a semântica de uma NOR (apagar = 0xFF, gravar
+// só zera bits); com SACD_FLASH, cada operação é repetida no arquivo
+
+static uint8_t host_flash[HAL_FLASH_DATA_SIZE];
+static uint32_t host_flash_ops; // Operações desde o boot
+static uint32_t host_flash_cut; // Operação interrompida (0 = nenhuma)
+static uint32_t host_flash_random;
+
+static void host_flash_sync(uint32_t offset, uint32_t length) {
+    if (host_flash_file) {
+        fseek(host_flash_file, offset, SEEK_SET);
+        fwrite(host_flash + offset, 1, length, host_flash_file);
+        fflush(host_flash_file);
+    }
+}
+
+// xorshift32: só precisa ser reprodutível a partir da semente
+static uint32_t host_flash_rand(void) {
+    host_flash_random ^= host_flash_random << 13;
+    host_flash_random ^= host_flash_random >> 17;
+    host_flash_random ^= host_flash_random << 5;
+    return host_flash_random;
+}
+
+// Conta a operação; na escolhida por SACD_FLASH_CUT, aplica só parte dela e encerra. Até um
+// ponto ao acaso ela terminou; dali em diante cada byte ficou a meio caminho: o apagamento
+// só subiu alguns bits para 1, a gravação só desceu alguns para 0.
+static void host_flash_check_cut(uint32_t offset, const uint8_t *data, uint32_t length) {
+    if (++host_flash_ops != host_flash_cut) {
+        return;
+    }
+
+    uint32_t done = host_flash_rand() % length;
+    for (uint32_t i = 0; i < length; i++) {
+        uint8_t *byte = &host_flash[offset + i];
+        if (data) {
+            *byte &= i < done ? data[i] : data[i] | (uint8_t)host_flash_rand();
+        }
+        else {
+            *byte = i < done ? 0xFF : *byte | (uint8_t)host_flash_rand();
+        }
+    }
+    host_flash_sync(offset, length);
+    fprintf(stderr, "sim: energia cortada na operação %u da flash (%s de %u bytes em 0x%05x, %u feitos)\n",
+            host_flash_ops, data ? "gravação" : "apagamento", length, offset, done);
+    host_finish();
+}
+
+void hal_flash_erase(uint32_t offset, uint32_t length) {
+    assert(offset % HAL_FLASH_SECTOR_SIZE == 0 && length % HAL_FLASH_SECTOR_SIZE == 0);
+    assert(offset + length <= HAL_FLASH_DATA_SIZE);
+    // Na placa, o apagamento passa do anel do ADC (o DMA só é rearmado na interrupção)
+    if (host_adc_alarm > 0) {
+        fprintf(stderr, "sim: apagamento da flash em 0x%x com a captura do ADC ligada\n", (unsigned)offset);
+        abort();
+    }
+    host_flash_check_cut(offset, NULL, length);
+    memset(host_flash + offset, 0xFF, length);
+    host_flash_sync(offset, length);
+}
+
+void hal_flash_program(uint32_t offset, const uint8_t *data, uint32_t length) {
+    assert(offset % HAL_FLASH_PAGE_SIZE == 0 && length % HAL_FLASH_PAGE_SIZE == 0);
+    assert(offset + length <= HAL_FLASH_DATA_SIZE);
+    host_flash_check_cut(offset, data, length);
+    for (uint32_t i = 0; i < length; i++) {
+        host_flash[offset + i] &= data[i];
+    }
+    host_flash_sync(offset, length);
+}
+
+const uint8_t *hal_flash_data(uint32_t offset) {
+    return host_flash + offset;
+}
+
+static void host_flash_open(const char *path) {
+    memset(host_flash, 0xFF, sizeof(host_flash));
+    if (!path || !*path) {
+        return;
+    }
+
+    host_flash_file = fopen(path, "r+b");
+    if (host_flash_file) {
+        size_t n = fread(host_flash, 1, sizeof(host_flash), host_flash_file);
+        (void)n; // Arquivo menor: o resto continua apagado
+    }
+    else {
+        host_flash_file = fopen(path, "w+b");
+        host_flash_sync(0, sizeof(host_flash));
+    }
+    if (!host_flash_file) {
+        fprintf(stderr, "sim: não foi possível abrir %s\n", path);
+    }
+}
+
+// ---------------------------------------------------------------------------
+
+// Lê a configuração do ambiente e abre as saídas (uma vez, na primeira chamada da HAL)
+static void host_setup(void) {
+    char path[512];
+    const char *env;
+
+    if (host_ready) {
+        return;
+    }
+    host_ready = true;
+    host_wall_start = clock();
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    env = getenv("SACD_OUT");
+    if (env) {
+        host_out_dir = *env ? env : NULL;
+    }
+    if (host_out_dir) {
+        mkdir(host_out_dir, 0755);
+        snprintf(path, sizeof(path), "%s/leds.log", host_out_dir);
+        host_leds_log = fopen(path, "w");
+        snprintf(path, sizeof(path), "%s/pwm.log", host_out_dir);
+        host_pwm_log = fopen(path, "w");
+    }
+
+    env = getenv("SACD_SIM_MS");
+    host_end_us = (uint64_t)(env ? strtoul(env, NULL, 10) : 10000) * 1000;
+    if (host_end_us == 0) {
+        host_end_us = UINT64_MAX;
+    }
+
+    env = getenv("SACD_WAV");
+    if (env && *env) {
+        char *list = strdup(env);
+        for (char *name = strtok(list, ":"); name && host_wav_count < HOST_MAX_WAVS; name = strtok(NULL, ":")) {
+            if (host_load_wav(name, &host_wavs[host_wav_count])) {
+                host_wav_count++;
+            }
+        }
+        free(list);
+    }
+
+    host_adc_value_count = host_parse_script(getenv("SACD_ADC"), host_adc_values, HOST_MAX_SCRIPT, 3);
+    host_button_count = host_parse_script(getenv("SACD_BUTTONS"), host_buttons, HOST_MAX_SCRIPT, 2);
+    for (uint i = 0; i < host_button_count; i++) {
+        if (host_buttons[i].a < HOST_MAX_GPIO) {
+            hal_alarm_in_us((uint64_t)host_buttons[i].ms * 1000, host_button_press, (void *)(uintptr_t)host_buttons[i].a);
+        }
+    }
+
+    host_console_count = host_parse_console(getenv("SACD_CONSOLE"));
+    host_flash_open(getenv("SACD_FLASH"));
+
+    env = getenv("SACD_FLASH_CUT");
+    if (env && *env) {
+        char *end;
+        host_flash_cut = strtoul(env, &end, 10);
+        host_flash_random = *end == ':' ? strtoul(end + 1, NULL, 10) : host_flash_cut;
+        if (host_flash_random == 0) {
+            host_flash_random = 1; // O xorshift fica preso no zero
+        }
+    }
+
+    oled.control = true;
+    oled.col_end = HOST_OLED_WIDTH - 1;
+    oled.page_end = HOST_OLED_PAGES - 1;
+
+    env = getenv("SACD_CPU_SCALE");
+    host_cpu_scale = env ? strtod(env, NULL) : 0;
+    host_cpu_mark(); // A preparação da simulação não conta
+}
@@ -0,0 +1,547 @@
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/adc.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/i2c.h"
+#include "hardware/pio.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/sync.h"
+#include "hardware/flash.h"
+#include "ws2818b.pio.h"
+#include "hal.h"
+
+// Implementação da HAL sobre o pico-sdk (RP2040).
+// DMA_IRQ_0 fica com a captura do ADC (core de áudio); LEDs e I2C usam a DMA_IRQ_1 no core0.
+
+#define HAL_ADC_MAX_BLOCKS 4
+#define HAL_ADC_CLOCK_HZ 48000000
+
+#define HAL_LEDS_BIT_HZ 800000.f
+
+// Tempo entre o fim do DMA e o fim do quadro: FIFO unida (8 pixels de 30us) + OSR + RESET (>= 100us)
+#define HAL_LEDS_LATCH_US (8 * 30 + 30 + 100)
+
+// ---------------------------------------------------------------------------
+// Tempo, interrupções e cores
+
+uint64_t hal_time_us(void) {
+    return time_us_64();
+}
+
+uint32_t hal_time_ms(void) {
+    return to_ms_since_boot(get_absolute_time());
+}
+
+void hal_sleep_ms(uint32_t ms) {
+    sleep_ms(ms);
+}
+
+hal_alarm_id_t hal_alarm_in_us(uint64_t delay_us, hal_alarm_cb_t callback, void *user_data) {
+    return add_alarm_in_us(delay_us, callback, user_data, true);
+}
+
+bool hal_alarm_cancel(hal_alarm_id_t id) {
+    return cancel_alarm(id);
+}
+
+uint32_t hal_irq_save(void) {
+    return save_and_disable_interrupts();
+}
+
+void hal_irq_restore(uint32_t state) {
+    restore_interrupts(state);
+}
+
+// Dorme até uma interrupção ou um __sev() do outro core
+void hal_wait_for_event(void) {
+    __wfe();
+}
+
+void hal_signal_event(void) {
+    __sev();
+}
+
+static void (*hal_core1_entry)(void);
+static bool hal_core1_running = false;
+
+// O core1 aceita ser pausado pelo core0 durante as operações na flash
+static void hal_core1_main(void) {
+    multicore_lockout_victim_init();
+    hal_core1_entry();
+}
+
+void hal_launch_core1(void (*entry)(void)) {
+    hal_core1_entry = entry;
+    hal_core1_running = true;
+    multicore_launch_core1(hal_core1_main);
+}
+
+uint hal_core_num(void) {
+    return get_core_num();
+}
+
+void hal_stdio_init(void) {
+    stdio_init_all();
+}
+
+int hal_stdio_getchar(void) {
+    int c = getchar_timeout_us(0);
+    return c == PICO_ERROR_TIMEOUT ? -1 : c;
+}
+
+// ---------------------------------------------------------------------------
+// GPIO
+
+void hal_gpio_input_pullup(uint gpio) {
+    gpio_init(gpio);
+    gpio_set_dir(gpio, GPIO_IN);
+    gpio_pull_up(gpio);
+}
+
+bool hal_gpio_get(uint gpio) {
+    return gpio_get(gpio);
+}
+
+void hal_gpio_on_falling_edge(uint gpio, hal_gpio_cb_t callback) {
+    gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_EDGE_FALL, true, callback);
+}
+
+// ---------------------------------------------------------------------------
+// ADC: modo contínuo com canais de DMA encadeados em anel (um por bloco)
+
+static bool adc_ready = false;
+static uint adc_gpio_ready; // Máscara dos canais com o pino já configurado
+static bool adc_streaming = false;
+static uint adc_stream_mask;
+static uint adc_stream_rrobin; // Máscara do round-robin (0 com um canal só)
+static uint16_t *adc_ring;
+static uint adc_block_samples;
+static uint adc_blocks;
+static uint adc_dma_chan[HAL_ADC_MAX_BLOCKS];
+static hal_adc_block_cb_t adc_callback;
+
+static void hal_adc_setup(uint channel) {
+    if (!adc_ready) {
+        adc_init();
+        adc_ready = true;
+    }
+    if (!(adc_gpio_ready & (1u << channel))) {
+        adc_gpio_init(26 + channel);
+        adc_gpio_ready |= 1u << channel;
+    }
+}
+
+// Interrupção do DMA: rearma o canal que terminou para o seu bloco e sinaliza
+static void hal_adc_dma_handler(void) {
+    for (uint i = 0; i < adc_blocks; i++) {
+        uint chan = adc_dma_chan[i];
+
+        if (dma_hw->ints0 & (1u << chan)) {
+            dma_channel_acknowledge_irq0(chan);
+            // O contador de transferências é recarregado sozinho a cada disparo
+            dma_channel_set_write_addr(chan, adc_ring + i * adc_block_samples, false);
+            adc_callback(i);
+        }
+    }
+}
+
+void hal_adc_stream_init(uint channel_mask, uint32_t sample_rate, uint16_t *ring, uint block_samples, uint blocks, hal_adc_block_cb_t callback) {
+    uint channels = 0;
+
+    if (blocks > HAL_ADC_MAX_BLOCKS) {
+        blocks = HAL_ADC_MAX_BLOCKS;
+    }
+
+    adc_stream_mask = channel_mask;
+    adc_ring = ring;
+    adc_block_samples = block_samples;
+    adc_blocks = blocks;
+    adc_callback = callback;
+
+    for (uint channel = 0; channel < 5; channel++) {
+        if (channel_mask & (1u << channel)) {
+            hal_adc_setup(channel);
+            channels++;
+        }
+    }
+    adc_stream_rrobin = channels > 1 ? channel_mask : 0;
+    adc_fifo_setup(
+        true,    // Habilitar FIFO
+        true,    // Habilitar request de dados do DMA
+        1,       // Threshold para ativar request DMA
+        false,   // Não usar bit de erro
+        false    // Manter 12-bits
+    );
+    // Período de (1 + div) ciclos do clock de 48 MHz do ADC, dividido entre os canais
+    adc_set_clkdiv((float)HAL_ADC_CLOCK_HZ / (sample_rate * channels) - 1);
+
+    for (uint i = 0; i < blocks; i++) {
+        adc_dma_chan[i] = dma_claim_unused_channel(true);
+    }
+
+    for (uint i = 0; i < blocks; i++) {
+        uint chan = adc_dma_chan[i];
+        dma_channel_config cfg = dma_channel_get_default_config(chan);
+
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, false);
+        channel_config_set_write_increment(&cfg, true);
+        channel_config_set_dreq(&cfg, DREQ_ADC);
+        // Cada canal dispara o seguinte ao terminar, então o ADC nunca fica sem destino
+        channel_config_set_chain_to(&cfg, adc_dma_chan[(i + 1) % blocks]);
+
+        dma_channel_configure(chan, &cfg,
+            ring + i * block_samples, // Escreve no seu bloco do anel.
+            &(adc_hw->fifo), // Lê do ADC.
+            block_samples, // Um bloco por disparo.
+            false // Só liga em hal_adc_stream_start().
+        );
+        dma_channel_set_irq0_enabled(chan, true);
+    }
+
+    irq_add_shared_handler(DMA_IRQ_0, hal_adc_dma_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+}
+
+// Liga a captura contínua a partir do primeiro bloco do anel
+void hal_adc_stream_start(void) {
+    adc_run(false);
+    adc_fifo_drain();
+    adc_select_input(__builtin_ctz(adc_stream_mask)); // Cada bloco começa no menor canal
+    adc_set_round_robin(adc_stream_rrobin);
+
+    for (uint i = 0; i < adc_blocks; i++) {
+        dma_channel_set_write_addr(adc_dma_chan[i], adc_ring + i * adc_block_samples, false);
+        dma_channel_set_trans_count(adc_dma_chan[i], adc_block_samples, false);
+    }
+
+    adc_streaming = true;
+    dma_channel_start(adc_dma_chan[0]);
+    adc_run(true);
+}
+
+// Desliga o ADC e aborta os canais
+void hal_adc_stream_stop(void) {
+    adc_run(false);
+    adc_set_round_robin(0);
+    adc_streaming = false;
+
+    for (uint i = 0; i < adc_blocks; i++) {
+        dma_channel_abort(adc_dma_chan[i]);
+        dma_channel_acknowledge_irq0(adc_dma_chan[i]);
+    }
+
+    adc_fifo_drain();
+}
+
+// Leitura avulsa de um canal. Com a captura ligada, suspende a conversão entre duas amostras,
+// lê sem passar pela FIFO (senão a leitura entraria no áudio) e retoma no mesmo ponto do
+// round-robin, para não desalinhar os canais intercalados. Deve ser chamada no core que trata
+// a interrupção da captura; canais que já estão na captura não precisam disso.
+uint16_t hal_adc_read(uint channel) {
+    uint16_t value;
+    uint32_t cs;
+
+    hal_adc_setup(channel);
+
+    if (!adc_streaming) {
+        adc_select_input(channel);
+        return adc_read();
+    }
+
+    adc_run(false);
+    while (!(adc_hw->cs & ADC_CS_READY_BITS)) {
+        tight_loop_contents();
+    }
+    hw_clear_bits(&adc_hw->fcs, ADC_FCS_EN_BITS);
+
+    cs = adc_hw->cs; // Próximo canal (AINSEL) e máscara do round-robin
+    adc_set_round_robin(0);
+    adc_select_input(channel);
+    value = adc_read();
+
+    adc_select_input((cs & ADC_CS_AINSEL_BITS) >> ADC_CS_AINSEL_LSB);
+    adc_set_round_robin((cs & ADC_CS_RROBIN_BITS) >> ADC_CS_RROBIN_LSB);
+    hw_set_bits(&adc_hw->fcs, ADC_FCS_EN_BITS);
+    adc_run(true);
+
+    return value;
+}
+
+// ---------------------------------------------------------------------------
+// I2C: escrita assíncrona por DMA no ritmo da DREQ de transmissão
+
+static int i2c_dma[2] = {-1, -1};
+static uint i2c_baud[2];
+static uint i2c_requested_baud[2]; // Pedido em hal_i2c_init(), reaplicado quando o clock muda
+static void (*i2c_done[2])(bool ok);
+static bool dma1_irq_ready = false;
+
+// LEDs (declarados aqui porque dividem a interrupção com o I2C)
+static int leds_dma = -1;
+static PIO leds_pio;
+static uint leds_sm;
+static void (*leds_done)(void);
+
+static inline i2c_inst_t *hal_i2c_inst(uint bus) {
+    return bus ? i2c1 : i2c0;
+}
+
+void hal_i2c_init(uint bus, uint sda, uint scl, uint32_t baud_hz) {
+    i2c_requested_baud[bus] = baud_hz;
+    i2c_baud[bus] = i2c_init(hal_i2c_inst(bus), baud_hz);
+    gpio_set_function(sda, GPIO_FUNC_I2C);
+    gpio_set_function(scl, GPIO_FUNC_I2C);
+    gpio_pull_up(sda);
+    gpio_pull_up(scl);
+}
+
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *data, size_t length) {
+    return i2c_write_blocking(hal_i2c_inst(bus), address, data, length, false);
+}
+
+// Fim do envio: espera a FIFO do I2C esvaziar e o barramento ficar livre
+static int64_t hal_i2c_poll(alarm_id_t id, void *user_data) {
+    (void)id;
+    uint bus = (uint)(uintptr_t)user_data;
+    i2c_hw_t *hw = i2c_get_hw(hal_i2c_inst(bus));
+    bool ok = true;
+
+    if (!(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS)) {
+        return -50; // Tenta de novo em 50us
+    }
+
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        (void)hw->clr_tx_abrt; // O dispositivo não respondeu; a leitura limpa o aborto
+        ok = false;
+    }
+
+    if (i2c_done[bus]) {
+        i2c_done[bus](ok);
+    }
+    return 0;
+}
+
+// Interrupção do DMA no core0: I2C (dados já na FIFO, até 16 bytes por sair) e LEDs
+// (dados na FIFO da PIO, falta esvaziá-la e segurar o RESET)
+static int64_t hal_leds_latch_done(alarm_id_t id, void *user_data);
+
+static void hal_dma1_handler(void) {
+    for (uint bus = 0; bus < 2; bus++) {
+        if (i2c_dma[bus] >= 0 && (dma_hw->ints1 & (1u << i2c_dma[bus]))) {
+            dma_channel_acknowledge_irq1(i2c_dma[bus]);
+            uint32_t byte_us = 9 * 1000000 / i2c_baud[bus];
+            add_alarm_in_us(16 * byte_us, hal_i2c_poll, (void *)(uintptr_t)bus, true);
+        }
+    }
+
+    if (leds_dma >= 0 && (dma_hw->ints1 & (1u << leds_dma))) {
+        dma_channel_acknowledge_irq1(leds_dma);
+        add_alarm_in_us(HAL_LEDS_LATCH_US, hal_leds_latch_done, NULL, true);
+    }
+}
+
+static void hal_dma1_irq_init(void) {
+    if (!dma1_irq_ready) {
+        irq_add_shared_handler(DMA_IRQ_1, hal_dma1_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_1, true);
+        dma1_irq_ready = true;
+    }
+}
+
+// O DMA não pode escrever bytes em IC_DATA_CMD (a escrita estreita é replicada nos bits de
+// STOP/RESTART), por isso a sequência é de palavras de 16 bits; 'words' deve continuar
+// válido até 'done'.
+bool hal_i2c_write_async(uint bus, uint8_t address, const uint16_t *words, uint count, void (*done)(bool ok)) {
+    i2c_inst_t *i2c = hal_i2c_inst(bus);
+    i2c_hw_t *hw = i2c_get_hw(i2c);
+
+    if (i2c_dma[bus] < 0) {
+        i2c_dma[bus] = dma_claim_unused_channel(true);
+
+        dma_channel_config cfg = dma_channel_get_default_config(i2c_dma[bus]);
+        channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+        channel_config_set_read_increment(&cfg, true);
+        channel_config_set_write_increment(&cfg, false);
+        channel_config_set_dreq(&cfg, i2c_get_dreq(i2c, true));
+        dma_channel_configure(i2c_dma[bus], &cfg, &hw->data_cmd, words, 0, false);
+
+        dma_channel_set_irq1_enabled(i2c_dma[bus], true);
+        hal_dma1_irq_init();
+    }
+
+    i2c_done[bus] = done;
+    hw->enable = 0;
+    hw->tar = address;
+    hw->enable = 1;
+    dma_channel_transfer_from_buffer_now(i2c_dma[bus], words, count);
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PIO: LEDs WS2812, um pixel (palavra de 32 bits) por transferência de DMA
+
+static int64_t hal_leds_latch_done(alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    if (leds_done) {
+        leds_done();
+    }
+    return 0;
+}
+
+void hal_leds_init(uint gpio, uint count) {
+    // Cria programa PIO.
+    uint offset = pio_add_program(pio0, &ws2818b_program);
+    leds_pio = pio0;
+
+    // Toma posse de uma máquina PIO.
+    int sm = pio_claim_unused_sm(leds_pio, false);
+    if (sm < 0) {
+        leds_pio = pio1;
+        sm = pio_claim_unused_sm(leds_pio, true); // Se nenhuma máquina estiver livre, panic!
+    }
+    leds_sm = sm;
+
+    // Inicia programa na máquina PIO obtida.
+    ws2818b_program_init(leds_pio, leds_sm, offset, gpio, HAL_LEDS_BIT_HZ);
+
+    leds_dma = dma_claim_unused_channel(true);
+
+    dma_channel_config cfg = dma_channel_get_default_config(leds_dma);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_32);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, pio_get_dreq(leds_pio, leds_sm, true));
+    dma_channel_configure(leds_dma, &cfg, &leds_pio->txf[leds_sm], NULL, count, false);
+
+    dma_channel_set_irq1_enabled(leds_dma, true);
+    hal_dma1_irq_init();
+}
+
+// 'words' deve continuar válido até 'done'
+void hal_leds_write_async(const uint32_t *words, uint count, void (*done)(void)) {
+    leds_done = done;
+    dma_channel_transfer_from_buffer_now(leds_dma, words, count);
+}
+
+// ---------------------------------------------------------------------------
+// Clock do sistema
+
+uint32_t hal_sys_clock_hz(void) {
+    return clock_get_hz(clk_sys);
+}
+
+// Retorna false se os PLLs não geram a frequência pedida. Um envio ao display leva até ~25 ms;
+// trocar o clock no meio dele mudaria o tempo dos bits já na FIFO, então a troca espera.
+bool hal_set_sys_clock_khz(uint32_t khz) {
+    uint vco, postdiv1, postdiv2;
+
+    if (khz * 1000 == clock_get_hz(clk_sys)) {
+        return true;
+    }
+    if (!check_sys_clock_khz(khz, &vco, &postdiv1, &postdiv2)) {
+        return false;
+    }
+
+    for (uint bus = 0; bus < 2; bus++) {
+        if (i2c_dma[bus] < 0) {
+            continue;
+        }
+        i2c_hw_t *hw = i2c_get_hw(hal_i2c_inst(bus));
+        while (dma_channel_is_busy(i2c_dma[bus]) || !(hw->status & I2C_IC_STATUS_TFE_BITS) || (hw->status & I2C_IC_STATUS_ACTIVITY_BITS)) {
+            tight_loop_contents();
+        }
+    }
+    if (leds_dma >= 0) {
+        while (dma_channel_is_busy(leds_dma) || !pio_sm_is_tx_fifo_empty(leds_pio, leds_sm)) {
+            tight_loop_contents();
+        }
+        busy_wait_us(HAL_LEDS_LATCH_US); // Último pixel saindo do OSR e o RESET
+    }
+
+    set_sys_clock_pll(vco, postdiv1, postdiv2);
+
+    for (uint bus = 0; bus < 2; bus++) {
+        if (i2c_requested_baud[bus]) {
+            i2c_baud[bus] = i2c_set_baudrate(hal_i2c_inst(bus), i2c_requested_baud[bus]);
+        }
+    }
+    if (leds_dma >= 0) {
+        pio_sm_set_clkdiv(leds_pio, leds_sm, clock_get_hz(clk_sys) / (10.f * HAL_LEDS_BIT_HZ));
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------------
+// PWM
+
+void hal_pwm_start(uint gpio, uint8_t div_int, uint8_t div_frac, uint16_t wrap, uint16_t level) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    pwm_set_clkdiv_int_frac(slice, div_int, div_frac);
+    pwm_set_wrap(slice, wrap);
+    pwm_set_chan_level(slice, pwm_gpio_to_channel(gpio), level);
+    pwm_set_enabled(slice, true);
+}
+
+void hal_pwm_stop(uint gpio) {
+    uint slice = pwm_gpio_to_slice_num(gpio);
+
+    pwm_set_enabled(slice, false);
+    pwm_set_chan_level(slice, pwm_gpio_to_channel(gpio), 0);
+}
+
+// ---------------------------------------------------------------------------
+// Flash: a área de dados fica no fim da memória. Enquanto a flash apaga ou grava, o XIP
+// não funciona; o core1 espera num laço em RAM (lockout) e as interrupções ficam desligadas.
+// O DMA do ADC continua escrevendo na RAM, mas só é rearmado na interrupção: uma gravação
+// de página (~1 ms) cabe num bloco do anel; um apagamento (dezenas de ms por setor, centenas
+// por bloco de 64 KB) não, e o DMA escreveria além do anel. Apagar exige a captura parada
+// (audio_pause_capture e audio_capture_stopped).
+
+#define HAL_FLASH_DATA_OFFSET (PICO_FLASH_SIZE_BYTES - HAL_FLASH_DATA_SIZE)
+
+_Static_assert(HAL_FLASH_DATA_SIZE % HAL_FLASH_BLOCK_SIZE == 0 && HAL_FLASH_DATA_SIZE < PICO_FLASH_SIZE_BYTES,
+               "a área de dados ocupa blocos inteiros no fim da flash e deixa espaço para o programa");
+
+extern char __flash_binary_end; // Fim do programa na flash (script do linker do pico-sdk)
+
+// Antes de apagar ou gravar: um firmware que cresceu até a área de dados se apagaria junto
+static uint32_t hal_flash_lock(void) {
+    if ((uintptr_t)&__flash_binary_end > XIP_BASE + HAL_FLASH_DATA_OFFSET) {
+        panic("firmware de %u KB invade a area de dados da flash (cabem %u KB)",
+              (unsigned)(((uintptr_t)&__flash_binary_end - XIP_BASE) / 1024), (unsigned)(HAL_FLASH_DATA_OFFSET / 1024));
+    }
+    if (hal_core1_running && get_core_num() == 0) {
+        multicore_lockout_start_blocking();
+    }
+    return save_and_disable_interrupts();
+}
+
+static void hal_flash_unlock(uint32_t irq) {
+    restore_interrupts(irq);
+    if (hal_core1_running && get_core_num() == 0) {
+        multicore_lockout_end_blocking();
+    }
+}
+
+void hal_flash_erase(uint32_t offset, uint32_t length) {
+    uint32_t irq = hal_flash_lock();
+    flash_range_erase(HAL_FLASH_DATA_OFFSET + offset, length); // Usa blocos de 64 KB quando alinhado
+    hal_flash_unlock(irq);
+}
+
+void hal_flash_program(uint32_t offset, const uint8_t *data, uint32_t length) {
+    uint32_t irq = hal_flash_lock();
+    flash_range_program(HAL_FLASH_DATA_OFFSET + offset, data, length);
+    hal_flash_unlock(irq);
+}
+
+// Leitura direta pelo XIP
+const uint8_t *hal_flash_data(uint32_t offset) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + HAL_FLASH_DATA_OFFSET + offset);
+}
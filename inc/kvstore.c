@@ -0,0 +1,446 @@
+#include <string.h>
+#include "hal.h"
+#include "kvstore.h"
+
+// Armazenamento de configurações (chave/valor) e de um histórico de eventos na flash.
+//
+// Os setores da região formam um anel usado como log: só se acrescentam registros, cada um com
+// CRC, no setor da cabeça; quando ele enche, a cabeça passa para o próximo, e o mais antigo é
+// apagado para dar lugar, o que espalha o desgaste por todos. Vale a última cópia de cada chave;
+// antes de apagar um setor, as chaves cuja última cópia está nele são regravadas na cabeça, e
+// os eventos dele se perdem (o histórico guarda o que cabe em 15 setores).
+//
+// No boot, kv_init() lê a região uma vez, em ordem de sequência, e monta na RAM os valores
+// atuais, o setor de cada um e os últimos eventos. Um registro com CRC errado é o que estava
+// sendo gravado quando a energia caiu: o resto daquele setor é ignorado e a escrita continua
+// no seguinte. Valores e eventos novos ficam na RAM e vão para a flash em kv_poll(), um
+// lote por página, no core0 (a HAL para o core de áudio durante a gravação, ~1 ms). Apagar
+// leva dezenas de ms, mais que o anel do ADC, então só acontece quando a aplicação permite
+// (fora da escuta, com a captura parada); para isso o setor seguinte à cabeça é mantido
+// apagado de antemão. Um setor só é apagado sem nenhuma chave cuja última cópia esteja nele:
+// se a cabeça não recebe as chaves a mover, a escrita passa para outro setor.
+
+_Static_assert(KV_FLASH_OFFSET % HAL_FLASH_SECTOR_SIZE == 0 && KV_SECTORS >= 3, "região em setores inteiros");
+_Static_assert(KV_MAX_KEYS <= 32, "as chaves cabem numa máscara de 32 bits");
+
+#define KV_RECORD_SIZE(length) ((sizeof(kv_record_t) + (length) + 3) & ~3u)
+
+// Espaço no fim da cabeça que só as chaves sendo movidas usam, para a rotação nunca travar
+#define KV_RESERVE (KV_MAX_KEYS * KV_RECORD_SIZE(KV_MAX_DATA))
+
+// Valores atuais
+static uint8_t kv_values[KV_MAX_KEYS][KV_MAX_DATA];
+static uint8_t kv_lengths[KV_MAX_KEYS];
+static int8_t kv_value_sector[KV_MAX_KEYS]; // Setor da última cópia na flash (-1 = só na RAM)
+static uint32_t kv_present; // Máscara das chaves com valor
+static uint32_t kv_dirty; // Chaves a gravar
+static uint32_t kv_moving; // Chaves a gravar antes de apagar o setor onde estão
+
+// Setores
+static uint32_t kv_sequence[KV_SECTORS]; // 0 = setor sem cabeçalho válido
+static uint32_t kv_erased; // Máscara dos setores inteiramente apagados
+static int kv_head = -1;
+static uint32_t kv_write; // Próxima posição livre na cabeça
+static uint32_t kv_last_sequence;
+static bool kv_blocked; // Cabeça cheia e nenhum setor livre de chaves para apagar
+
+// Eventos: fila de gravação e os mais recentes
+static kv_event_t kv_queue[KV_EVENT_QUEUE];
+static uint kv_queue_first, kv_queue_count;
+static kv_event_t kv_history[KV_HISTORY];
+static uint kv_history_next, kv_history_count;
+static uint16_t kv_sector_events[KV_SECTORS]; // Eventos gravados em cada setor
+
+static uint32_t kv_corrupt;
+static uint32_t kv_page_writes;
+static uint32_t kv_sector_erases;
+
+// CRC-32 (IEEE, refletido), bit a bit: os registros são pequenos e raros
+static uint32_t kv_crc32(uint32_t crc, const uint8_t *data, uint32_t length) {
+    crc = ~crc;
+    for (uint32_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint b = 0; b < 8; b++) {
+            crc = (crc >> 1) ^ (0xEDB88320u & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t kv_record_crc(const kv_record_t *record, const uint8_t *data) {
+    return kv_crc32(kv_crc32(0, (const uint8_t *)record, 4), data, record->length);
+}
+
+static uint32_t kv_header_crc(const kv_sector_header_t *header) {
+    return kv_crc32(0, (const uint8_t *)header, 8);
+}
+
+static uint32_t kv_sector_offset(uint sector) {
+    return KV_FLASH_OFFSET + sector * HAL_FLASH_SECTOR_SIZE;
+}
+
+static bool kv_blank(const uint8_t *data, uint32_t length) {
+    for (uint32_t i = 0; i < length; i++) {
+        if (data[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void kv_history_push(uint8_t type, const void *data, uint8_t length) {
+    kv_event_t *event = &kv_history[kv_history_next];
+
+    event->type = type;
+    event->length = length;
+    memcpy(event->data, data, length);
+    kv_history_next = (kv_history_next + 1) % KV_HISTORY;
+    if (kv_history_count < KV_HISTORY) {
+        kv_history_count++;
+    }
+}
+
+// Aplica os registros de um setor; retorna a posição do fim do log (o tamanho do setor se
+// ele terminou num registro interrompido)
+static uint32_t kv_replay(uint sector) {
+    const uint8_t *base = hal_flash_data(kv_sector_offset(sector));
+    uint32_t pos = sizeof(kv_sector_header_t);
+
+    while (pos + sizeof(kv_record_t) <= HAL_FLASH_SECTOR_SIZE) {
+        kv_record_t record;
+        const uint8_t *data = base + pos + sizeof(kv_record_t);
+
+        memcpy(&record, base + pos, sizeof(record));
+        if (record.type == 0xFF) {
+            // Fim do log, desde que nenhum bit depois dele tenha sido gravado pela metade
+            if (kv_blank(base + pos, HAL_FLASH_SECTOR_SIZE - pos)) {
+                return pos;
+            }
+            kv_corrupt++;
+            return HAL_FLASH_SECTOR_SIZE;
+        }
+        if (record.length > KV_MAX_DATA || pos + KV_RECORD_SIZE(record.length) > HAL_FLASH_SECTOR_SIZE ||
+            record.crc != kv_record_crc(&record, data)) {
+            kv_corrupt++;
+            return HAL_FLASH_SECTOR_SIZE;
+        }
+
+        if (record.type == KV_RECORD_VALUE && record.key < KV_MAX_KEYS) {
+            memcpy(kv_values[record.key], data, record.length);
+            kv_lengths[record.key] = record.length;
+            kv_value_sector[record.key] = sector;
+            kv_present |= 1u << record.key;
+        }
+        else if (record.type == KV_RECORD_EVENT) {
+            kv_history_push(record.key, data, record.length);
+            kv_sector_events[sector]++;
+        }
+        pos += KV_RECORD_SIZE(record.length);
+    }
+    return pos;
+}
+
+/**
+ * Lê a região uma vez e monta o índice na RAM: valores atuais, últimos eventos e a cabeça.
+ */
+void kv_init(void) {
+    memset(kv_lengths, 0, sizeof(kv_lengths));
+    memset(kv_value_sector, -1, sizeof(kv_value_sector));
+    kv_present = kv_dirty = kv_moving = 0;
+    kv_erased = 0;
+    kv_head = -1;
+    kv_write = 0;
+    kv_last_sequence = 0;
+    kv_blocked = false;
+    kv_queue_first = kv_queue_count = 0;
+    kv_history_next = kv_history_count = 0;
+    kv_corrupt = 0;
+    memset(kv_sector_events, 0, sizeof(kv_sector_events));
+
+    for (uint s = 0; s < KV_SECTORS; s++) {
+        const kv_sector_header_t *header = (const kv_sector_header_t *)hal_flash_data(kv_sector_offset(s));
+
+        kv_sequence[s] = 0;
+        if (header->magic == KV_SECTOR_MAGIC && header->sequence != 0 && header->crc == kv_header_crc(header)) {
+            kv_sequence[s] = header->sequence;
+        }
+        else if (kv_blank((const uint8_t *)header, HAL_FLASH_SECTOR_SIZE)) {
+            kv_erased |= 1u << s;
+        }
+        // Senão, sobra de um apagamento ou de um cabeçalho interrompido: é apagado antes do uso
+    }
+
+    // Do mais antigo ao mais novo; o último é a cabeça
+    for (;;) {
+        int next = -1;
+        for (uint s = 0; s < KV_SECTORS; s++) {
+            if (kv_sequence[s] > kv_last_sequence && (next < 0 || kv_sequence[s] < kv_sequence[next])) {
+                next = s;
+            }
+        }
+        if (next < 0) {
+            break;
+        }
+        kv_last_sequence = kv_sequence[next];
+        kv_head = next;
+        kv_write = kv_replay(next);
+    }
+}
+
+/**
+ * Copia o valor de 'key' para 'data'; retorna false se a chave não tem valor ou o tamanho é outro.
+ */
+bool kv_get(uint8_t key, void *data, uint8_t length) {
+    if (key >= KV_MAX_KEYS || !(kv_present & (1u << key)) || kv_lengths[key] != length) {
+        return false;
+    }
+    memcpy(data, kv_values[key], length);
+    return true;
+}
+
+/**
+ * Muda o valor de 'key' na RAM; a gravação fica para kv_poll(). Gravar o mesmo valor não gasta
+ * a flash.
+ */
+bool kv_set(uint8_t key, const void *data, uint8_t length) {
+    uint32_t bit = 1u << key;
+
+    if (key >= KV_MAX_KEYS || length > KV_MAX_DATA) {
+        return false;
+    }
+    if ((kv_present & bit) && kv_lengths[key] == length && memcmp(kv_values[key], data, length) == 0) {
+        return true;
+    }
+    memcpy(kv_values[key], data, length);
+    kv_lengths[key] = length;
+    kv_present |= bit;
+    kv_dirty |= bit;
+    return true;
+}
+
+/**
+ * Acrescenta um evento ao histórico; retorna false se a fila de gravação está cheia.
+ */
+bool kv_log_event(uint8_t type, const void *data, uint8_t length) {
+    if (length > KV_MAX_DATA || kv_queue_count == KV_EVENT_QUEUE) {
+        return false;
+    }
+
+    kv_event_t *event = &kv_queue[(kv_queue_first + kv_queue_count) % KV_EVENT_QUEUE];
+    event->type = type;
+    event->length = length;
+    memcpy(event->data, data, length);
+    kv_queue_count++;
+    kv_history_push(type, data, length);
+    return true;
+}
+
+/**
+ * Evento 'index' do histórico, do mais recente (0) para trás; false se não há tantos na RAM.
+ */
+bool kv_event(uint index, kv_event_t *event) {
+    if (index >= kv_history_count) {
+        return false;
+    }
+    *event = kv_history[(kv_history_next + KV_HISTORY - 1 - index) % KV_HISTORY];
+    return true;
+}
+
+// Serializa um registro na imagem da página, se ele começa na primeira página da imagem e
+// termina antes de 'limit' (posição no setor)
+static bool kv_append(uint8_t *image, uint32_t page, uint32_t *pos, uint32_t limit,
+                      uint8_t type, uint8_t key, const uint8_t *data, uint8_t length) {
+    kv_record_t record = { .type = type, .key = key, .length = length, .reserved = 0 };
+
+    if (*pos >= page + HAL_FLASH_PAGE_SIZE || *pos + KV_RECORD_SIZE(length) > limit) {
+        return false;
+    }
+    record.crc = kv_record_crc(&record, data);
+    memcpy(image + *pos - page, &record, sizeof(record));
+    memcpy(image + *pos - page + sizeof(record), data, length);
+    *pos += KV_RECORD_SIZE(length);
+    return true;
+}
+
+// Grava na cabeça o que couber a partir da página atual (um registro pode invadir a página
+// seguinte); retorna false se nada coube
+static bool kv_program_batch(void) {
+    static uint8_t image[2 * HAL_FLASH_PAGE_SIZE];
+    uint32_t limit = HAL_FLASH_SECTOR_SIZE - KV_RESERVE;
+    uint32_t page, pos;
+
+    if (kv_head < 0) {
+        return false;
+    }
+    page = kv_write & ~(HAL_FLASH_PAGE_SIZE - 1);
+    pos = kv_write;
+    memset(image, 0xFF, sizeof(image)); // 0xFF não altera o que já está gravado na página
+
+    // Primeiro as chaves sendo movidas, que podem usar a reserva
+    for (uint pass = 0; pass < 2; pass++) {
+        uint32_t keys = pass == 0 ? kv_moving : kv_dirty & ~kv_moving;
+        for (uint k = 0; k < KV_MAX_KEYS; k++) {
+            if ((keys & (1u << k)) &&
+                kv_append(image, page, &pos, pass == 0 ? HAL_FLASH_SECTOR_SIZE : limit, KV_RECORD_VALUE, k, kv_values[k], kv_lengths[k])) {
+                kv_dirty &= ~(1u << k);
+                kv_moving &= ~(1u << k);
+                kv_value_sector[k] = kv_head;
+            }
+        }
+    }
+
+    // Eventos em ordem
+    while (kv_queue_count > 0) {
+        const kv_event_t *event = &kv_queue[kv_queue_first];
+        if (!kv_append(image, page, &pos, limit, KV_RECORD_EVENT, event->type, event->data, event->length)) {
+            break;
+        }
+        kv_queue_first = (kv_queue_first + 1) % KV_EVENT_QUEUE;
+        kv_queue_count--;
+        kv_sector_events[kv_head]++;
+    }
+
+    if (pos == kv_write) {
+        return false;
+    }
+    hal_flash_program(kv_sector_offset(kv_head) + page, image, pos - page > HAL_FLASH_PAGE_SIZE ? 2 * HAL_FLASH_PAGE_SIZE : HAL_FLASH_PAGE_SIZE);
+    kv_write = pos;
+    kv_page_writes++;
+    return true;
+}
+
+// Máscara das chaves cuja última cópia está em 'sector'
+static uint32_t kv_sector_keys(uint sector) {
+    uint32_t keys = 0;
+
+    for (uint k = 0; k < KV_MAX_KEYS; k++) {
+        if (kv_value_sector[k] == (int)sector) {
+            keys |= 1u << k;
+        }
+    }
+    return keys;
+}
+
+// Apaga um setor sem chaves (os eventos dele se perdem)
+static void kv_erase(uint sector) {
+    hal_flash_erase(kv_sector_offset(sector), HAL_FLASH_SECTOR_SIZE);
+    kv_sector_erases++;
+    kv_sequence[sector] = 0;
+    kv_sector_events[sector] = 0; // Os da RAM continuam visíveis até serem substituídos
+    kv_erased |= 1u << sector;
+}
+
+// Abre um setor apagado como a nova cabeça
+static void kv_open(uint sector) {
+    uint8_t page[HAL_FLASH_PAGE_SIZE];
+    kv_sector_header_t header = {
+        .magic = KV_SECTOR_MAGIC,
+        .sequence = kv_last_sequence + 1,
+        .reserved = 0xFFFFFFFFu,
+    };
+
+    header.crc = kv_header_crc(&header);
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    hal_flash_program(kv_sector_offset(sector), page, sizeof(page));
+    kv_page_writes++;
+
+    kv_last_sequence = header.sequence;
+    kv_sequence[sector] = header.sequence;
+    kv_erased &= ~(1u << sector);
+    kv_head = sector;
+    kv_write = sizeof(header);
+}
+
+// A cabeça não recebe as chaves a mover (terminou num registro interrompido): a escrita passa
+// para um setor apagado ou, sem nenhum, o mais antigo sem chaves é apagado para isso. Retorna
+// false se todos os setores fora da cabeça guardam chaves; aí nada mais é apagado.
+static bool kv_open_spare(void) {
+    int victim = -1;
+
+    for (uint s = 0; s < KV_SECTORS; s++) {
+        if ((int)s == kv_head) {
+            continue;
+        }
+        if (kv_erased & (1u << s)) {
+            kv_open(s);
+            return true;
+        }
+        if (kv_sector_keys(s) == 0 && (victim < 0 || kv_sequence[s] < kv_sequence[victim])) {
+            victim = s;
+        }
+    }
+    if (victim < 0) {
+        kv_blocked = true;
+        return false;
+    }
+    kv_erase(victim);
+    return true;
+}
+
+/**
+ * Há valores ou eventos esperando a gravação?
+ */
+bool kv_pending(void) {
+    return kv_dirty != 0 || kv_queue_count > 0;
+}
+
+/**
+ * O setor seguinte à cabeça espera ser preparado (chaves movidas e apagamento), o que
+ * kv_poll() só faz com 'erase_ok'? A aplicação para a captura do ADC antes de permitir.
+ */
+bool kv_erase_pending(void) {
+    uint next = kv_head < 0 ? 0 : (kv_head + 1) % KV_SECTORS;
+
+    return !(kv_erased & (1u << next)) && !kv_blocked;
+}
+
+/**
+ * Faz uma etapa do trabalho pendente na flash: gravar um lote na cabeça (uma ou duas páginas),
+ * abrir o próximo setor, ou, se 'erase_ok' (com a captura do ADC já parada), preparar o setor
+ * seguinte à cabeça (mover as chaves que estão nele e apagá-lo). Chamada no core0 antes de
+ * dormir; retorna true se fez algo.
+ */
+bool kv_poll(bool erase_ok) {
+    uint next = kv_head < 0 ? 0 : (kv_head + 1) % KV_SECTORS;
+    bool next_erased = kv_erased & (1u << next);
+
+    if (erase_ok && kv_erase_pending()) {
+        uint32_t keys = kv_sector_keys(next);
+        if (keys == 0) {
+            kv_erase(next);
+            return true;
+        }
+        // Apagar antes de regravar as chaves perderia a única cópia delas na flash
+        kv_dirty |= keys;
+        kv_moving |= keys;
+        return kv_program_batch() || kv_open_spare();
+    }
+
+    if (!kv_pending()) {
+        return false;
+    }
+    if (kv_program_batch()) {
+        return true;
+    }
+    if (next_erased) {
+        kv_open(next);
+        return true;
+    }
+    return false; // Cabeça cheia: espera poder apagar
+}
+
+void kv_stats(kv_stats_t *stats) {
+    stats->head = kv_head;
+    stats->sequence = kv_head < 0 ? 0 : kv_sequence[kv_head];
+    stats->free_bytes = kv_head < 0 ? 0 : HAL_FLASH_SECTOR_SIZE - kv_write;
+    stats->sectors_used = 0;
+    stats->events = kv_queue_count;
+    for (uint s = 0; s < KV_SECTORS; s++) {
+        stats->sectors_used += kv_sequence[s] != 0;
+        stats->events += kv_sector_events[s];
+    }
+    stats->corrupt_records = kv_corrupt;
+    stats->page_writes = kv_page_writes;
+    stats->sector_erases = kv_sector_erases;
+}
@@ -0,0 +1,67 @@
+#include "hal.h"
+#include "recorder.h"
+
+#ifndef kvstore_inc_h
+#define kvstore_inc_h
+
+// Região do armazenamento: o que sobra da área de dados depois da gravação (64 KB, 16 setores)
+#define KV_FLASH_OFFSET (RECORDER_FLASH_OFFSET + RECORDER_FLASH_SIZE)
+#define KV_FLASH_SIZE (HAL_FLASH_DATA_SIZE - KV_FLASH_OFFSET)
+#define KV_SECTORS (KV_FLASH_SIZE / HAL_FLASH_SECTOR_SIZE)
+#define KV_SECTOR_MAGIC 0x3156534bu // "KSV1"
+#define KV_MAX_KEYS 16 // Chaves de 0 a KV_MAX_KEYS - 1
+#define KV_MAX_DATA 16 // Bytes de dados por valor ou evento
+#define KV_EVENT_QUEUE 8 // Eventos esperando a gravação
+#define KV_HISTORY 8 // Eventos mais recentes mantidos na RAM
+
+// Tipos de registro (0xFF é flash apagada: fim do log no setor)
+#define KV_RECORD_VALUE 0x01
+#define KV_RECORD_EVENT 0x02
+
+// Cabeçalho de um setor em uso; sem ele (ou com CRC errado) o setor está apagado ou foi
+// interrompido no meio do apagamento
+typedef struct {
+    uint32_t magic;
+    uint32_t sequence; // Ordem de abertura dos setores (cresce a cada rotação)
+    uint32_t crc; // CRC-32 de magic e sequence
+    uint32_t reserved; // 0xFFFFFFFF
+} kv_sector_header_t;
+
+// Registro do log, alinhado a 4 bytes: cabeçalho seguido de 'length' bytes de dados
+typedef struct {
+    uint8_t type; // KV_RECORD_*
+    uint8_t key; // Chave do valor, ou tipo do evento
+    uint8_t length;
+    uint8_t reserved; // 0
+    uint32_t crc; // CRC-32 dos 4 bytes acima e dos dados
+} kv_record_t;
+
+// Evento do histórico
+typedef struct {
+    uint8_t type;
+    uint8_t length;
+    uint8_t data[KV_MAX_DATA];
+} kv_event_t;
+
+typedef struct {
+    int head; // Setor sendo escrito (-1 = nenhum ainda)
+    uint32_t sequence; // Sequência da cabeça
+    uint32_t free_bytes; // Espaço livre na cabeça
+    uint sectors_used; // Setores com dados válidos
+    uint32_t events; // Eventos guardados (nos setores que ainda existem)
+    uint32_t corrupt_records; // Registros interrompidos encontrados na varredura
+    uint32_t page_writes; // Gravações de página desde o boot
+    uint32_t sector_erases; // Apagamentos desde o boot
+} kv_stats_t;
+
+void kv_init(void);
+bool kv_get(uint8_t key, void *data, uint8_t length);
+bool kv_set(uint8_t key, const void *data, uint8_t length);
+bool kv_log_event(uint8_t type, const void *data, uint8_t length);
+bool kv_event(uint index, kv_event_t *event);
+bool kv_poll(bool erase_ok);
+bool kv_erase_pending(void);
+bool kv_pending(void);
+void kv_stats(kv_stats_t *stats);
+
+#endif
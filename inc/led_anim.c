@@ -0,0 +1,64 @@
+#include <string.h>
+#include "led_anim.h"
+
+// Animação da matriz de LEDs por quadros-chave.
+//
+// Os quadros-chave ficam prontos antes (um por nível de intensidade) e cada quadro mostrado
+// é a interpolação linear dos dois vizinhos da posição atual, que anda até o nível pedido aos
+// poucos: mudar de nível vira uma transição suave em vez de um salto. O brilho percebido passa
+// pela tabela de gama (tools/led_tables.py) para o nível do PWM em Q8.8, e a fração vai para
+// um acumulador por canal (pontilhamento temporal de primeira ordem): um LED em 1,25 acende em
+// 1 em três quadros e em 2 no quarto, o que dá brilhos entre os poucos níveis inteiros
+// disponíveis no fundo da escala. A ordem serpentina da fita também sai de uma tabela.
+//
+// O custo por quadro é fixo: uma interpolação, uma consulta à gama e uma soma por canal dos
+// 25 LEDs, qualquer que seja o desenho. Parado num quadro-chave sem frações na gama, o quadro
+// não muda mais, e a aplicação pode deixar de pedir quadros até o nível mudar.
+
+void led_anim_init(led_anim_t *anim, const led_anim_frame_t *keyframes, uint levels, uint16_t step_q8) {
+    anim->keyframes = keyframes;
+    anim->levels = levels;
+    anim->position_q8 = anim->target_q8 = 0;
+    anim->step_q8 = step_q8;
+    memset(anim->error, 0, sizeof(anim->error));
+}
+
+// Nível de destino (0 a levels - 1); a posição chega lá em led_anim_render()
+void led_anim_set_level(led_anim_t *anim, uint level) {
+    if (level >= anim->levels) {
+        level = anim->levels - 1;
+    }
+    anim->target_q8 = level << 8;
+}
+
+// Avança a posição um passo e escreve o quadro em 'words' (palavras GRB alinhadas à
+// esquerda, na ordem da fita, como em hal_leds_write_async). Retorna true se o próximo quadro
+// será outro: a transição não terminou ou algum canal é pontilhado.
+bool led_anim_render(led_anim_t *anim, uint32_t *words) {
+    if (anim->position_q8 < anim->target_q8) {
+        anim->position_q8 = anim->target_q8 - anim->position_q8 > anim->step_q8 ? anim->position_q8 + anim->step_q8 : anim->target_q8;
+    }
+    else if (anim->position_q8 > anim->target_q8) {
+        anim->position_q8 = anim->position_q8 - anim->target_q8 > anim->step_q8 ? anim->position_q8 - anim->step_q8 : anim->target_q8;
+    }
+
+    uint level = anim->position_q8 >> 8;
+    uint frac = anim->position_q8 & 0xFF;
+    const uint8_t *from = anim->keyframes[level][0];
+    const uint8_t *to = anim->keyframes[level + 1 < anim->levels ? level + 1 : level][0];
+    uint8_t *error = anim->error[0];
+    uint32_t fractions = 0;
+
+    for (uint i = 0; i < LED_ANIM_PIXELS; i++) {
+        uint32_t rgb[3];
+        for (uint c = 0; c < 3; c++) {
+            uint32_t v = (*from++ * (256 - frac) + *to++ * frac) >> 8;
+            uint32_t out = led_gamma_q8[v] + *error;
+            fractions |= led_gamma_q8[v] & 0xFF;
+            *error++ = out & 0xFF;
+            rgb[c] = out >> 8;
+        }
+        words[led_serpentine[i]] = (rgb[1] << 24) | (rgb[0] << 16) | (rgb[2] << 8);
+    }
+    return anim->position_q8 != anim->target_q8 || fractions != 0;
+}
@@ -0,0 +1,27 @@
+#include "hal.h"
+#include "led_tables.h"
+
+#ifndef led_anim_inc_h
+#define led_anim_inc_h
+
+#define LED_ANIM_PIXELS LED_TABLE_PIXELS
+
+// Quadro-chave: brilho percebido (R, G, B, de 0 a 255) por posição lógica, linha a linha
+typedef uint8_t led_anim_frame_t[LED_ANIM_PIXELS][3];
+
+// Animação entre quadros-chave, um por nível: a posição (nível em Q8) anda até o alvo
+// 'step_q8' por quadro, e o quadro mostrado interpola os dois quadros-chave vizinhos
+typedef struct {
+    const led_anim_frame_t *keyframes;
+    uint levels;
+    uint16_t position_q8;
+    uint16_t target_q8;
+    uint16_t step_q8;
+    uint8_t error[LED_ANIM_PIXELS][3]; // Fração do PWM acumulada pelo pontilhamento (Q8)
+} led_anim_t;
+
+void led_anim_init(led_anim_t *anim, const led_anim_frame_t *keyframes, uint levels, uint16_t step_q8);
+void led_anim_set_level(led_anim_t *anim, uint level);
+bool led_anim_render(led_anim_t *anim, uint32_t *words);
+
+#endif
@@ -0,0 +1,40 @@
+#include <stdint.h>
+
+#ifndef led_tables_inc_h
+#define led_tables_inc_h
+
+// Gerado por tools/led_tables.py (--width 5 --height 5 --gamma 2.2 --max 8 --snap 0.05)
+#define LED_TABLE_WIDTH 5
+#define LED_TABLE_HEIGHT 5
+#define LED_TABLE_PIXELS 25
+
+// Brilho percebido -> nível do PWM em Q8.8 (gama 2.2, teto 8, inteiros a menos de 0.05)
+static const uint16_t led_gamma_q8[256] = {
+    0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 3, 3, 4,
+    5, 5, 6, 7, 8, 8, 9, 10, 11, 12, 13, 15, 16, 17, 18, 20,
+    21, 23, 24, 26, 28, 29, 31, 33, 35, 37, 39, 41, 43, 45, 47, 50,
+    52, 54, 57, 59, 62, 65, 67, 70, 73, 76, 79, 82, 85, 88, 91, 95,
+    98, 101, 105, 108, 112, 115, 119, 123, 127, 131, 135, 139, 143, 147, 151, 155,
+    160, 164, 169, 173, 178, 183, 187, 192, 197, 202, 207, 212, 217, 223, 228, 233,
+    239, 256, 256, 256, 256, 256, 273, 279, 285, 291, 297, 303, 309, 316, 322, 329,
+    335, 342, 348, 355, 362, 369, 376, 383, 390, 397, 405, 412, 419, 427, 434, 442,
+    450, 457, 465, 473, 481, 489, 497, 512, 512, 512, 530, 539, 548, 556, 565, 574,
+    583, 591, 601, 610, 619, 628, 637, 647, 656, 666, 675, 685, 695, 705, 714, 724,
+    735, 745, 755, 768, 768, 786, 796, 807, 818, 828, 839, 850, 861, 872, 883, 895,
+    906, 917, 929, 940, 952, 963, 975, 987, 999, 1011, 1024, 1024, 1047, 1060, 1072, 1084,
+    1097, 1110, 1122, 1135, 1148, 1161, 1174, 1187, 1200, 1213, 1227, 1240, 1254, 1267, 1280, 1294,
+    1308, 1322, 1336, 1350, 1364, 1378, 1393, 1407, 1421, 1436, 1451, 1465, 1480, 1495, 1510, 1536,
+    1536, 1555, 1570, 1586, 1601, 1617, 1632, 1648, 1663, 1679, 1695, 1711, 1727, 1743, 1760, 1776,
+    1792, 1809, 1825, 1842, 1859, 1875, 1892, 1909, 1926, 1943, 1961, 1978, 1995, 2013, 2030, 2048,
+};
+
+// Posição lógica (linha a linha) -> índice do LED na fita
+static const uint8_t led_serpentine[25] = {
+    0, 1, 2, 3, 4,
+    9, 8, 7, 6, 5,
+    10, 11, 12, 13, 14,
+    19, 18, 17, 16, 15,
+    20, 21, 22, 23, 24,
+};
+
+#endif
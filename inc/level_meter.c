@@ -0,0 +1,98 @@
+#include <string.h>
+#include "level_meter.h"
+
+// Medidor de nível: RMS -> dB por log2 aproximado, balística de subida/descida e retenção de
+// pico, tudo em inteiros e com custo constante por bloco (sem FPU, sem laços que dependam do nível).
+
+#define LEVEL_METER_DB_PER_OCTAVE_Q8 1541 // 20·log10(2) = 6,0206 dB em Q8
+
+// log2(1 + i/32) em Q8, com a ponta de 1 para interpolar o último trecho
+static const uint16_t level_meter_log2_lut[33] = {
+    0, 11, 22, 33, 44, 54, 63, 73, 82, 92, 100, 109, 118, 126, 134, 142,
+    150, 157, 165, 172, 179, 186, 193, 200, 207, 213, 220, 226, 232, 238, 244, 250,
+    256,
+};
+
+// log2(x) em Q8: o expoente vem da posição do bit mais alto e a mantissa da tabela, com
+// interpolação linear nos 8 bits seguintes (erro abaixo de 0,01 oitava). x = 0 dá 0.
+int32_t level_meter_log2_q8(uint32_t x) {
+    if (x == 0) {
+        return 0;
+    }
+
+    int msb = 31 - __builtin_clz(x);
+    uint32_t normalized = x << (31 - msb); // Bit mais alto na posição 31
+    uint32_t index = (normalized >> 26) & 31;
+    uint32_t frac = (normalized >> 18) & 0xFF;
+    int32_t base = level_meter_log2_lut[index];
+    int32_t next = level_meter_log2_lut[index + 1];
+
+    return (msb << 8) + base + (((next - base) * (int32_t)frac) >> 8);
+}
+
+// RMS em Q4 para dB (Q8) relativos a 1 contagem; abaixo disso, o piso da escala
+int32_t level_meter_db_q8(uint32_t rms_q4) {
+    if (rms_q4 <= 16) {
+        return LEVEL_METER_MIN_DB_Q8;
+    }
+    int32_t log2_counts_q8 = level_meter_log2_q8(rms_q4) - (4 << 8); // Q4: 4 oitavas abaixo
+    return (log2_counts_q8 * LEVEL_METER_DB_PER_OCTAVE_Q8 + 128) >> 8;
+}
+
+void level_meter_init(level_meter_t *meter, const level_meter_config_t *config) {
+    memset(meter, 0, sizeof(*meter));
+    meter->config = *config;
+    meter->level_db_q8 = meter->peak_db_q8 = LEVEL_METER_MIN_DB_Q8;
+}
+
+// Aplica o RMS de um bloco e retorna o nível com a balística (dB em Q8)
+int32_t level_meter_update(level_meter_t *meter, uint32_t rms_q4) {
+    const level_meter_config_t *config = &meter->config;
+    int32_t target = level_meter_db_q8(rms_q4);
+    int32_t diff = target - meter->level_db_q8;
+
+    meter->level_db_q8 += (diff * (diff > 0 ? config->attack_q8 : config->release_q8)) >> 8;
+
+    // O pico acompanha o nível para cima na hora; para baixo, só depois da retenção
+    if (meter->level_db_q8 >= meter->peak_db_q8) {
+        meter->peak_db_q8 = meter->level_db_q8;
+        meter->peak_age = 0;
+    }
+    else if (meter->peak_age < config->peak_hold_blocks) {
+        meter->peak_age++;
+    }
+    else {
+        meter->peak_db_q8 -= config->peak_fall_db_q8;
+        if (meter->peak_db_q8 < meter->level_db_q8) {
+            meter->peak_db_q8 = meter->level_db_q8;
+        }
+    }
+
+    return meter->level_db_q8;
+}
+
+// Quantiza um nível em 'levels' degraus: 0 abaixo de min_db, depois um a cada step_db,
+// saturando em levels - 1
+uint8_t level_meter_quantize(int32_t db_q8, int32_t min_db_q8, int32_t step_db_q8, uint8_t levels) {
+    if (db_q8 < min_db_q8 || levels < 2) {
+        return 0;
+    }
+    int32_t level = 1 + (db_q8 - min_db_q8) / step_db_q8;
+    return level < levels ? level : levels - 1;
+}
+
+// Quantiza com histerese: só muda de degrau quando o nível passa da fronteira por mais de
+// 'hysteresis_db_q8', o que evita que um som parado bem na fronteira faça o LED piscar
+uint8_t level_meter_quantize_hysteresis(int32_t db_q8, int32_t min_db_q8, int32_t step_db_q8, uint8_t levels,
+                                        uint8_t previous, int32_t hysteresis_db_q8) {
+    uint8_t up = level_meter_quantize(db_q8 - hysteresis_db_q8, min_db_q8, step_db_q8, levels);
+    uint8_t down = level_meter_quantize(db_q8 + hysteresis_db_q8, min_db_q8, step_db_q8, levels);
+
+    if (previous < up) {
+        return up;
+    }
+    if (previous > down) {
+        return down;
+    }
+    return previous;
+}
@@ -0,0 +1,41 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef level_meter_inc_h
+#define level_meter_inc_h
+
+// Medidor de nível em dB, em ponto fixo: dB em Q8 (1/256 dB), relativos a 1 contagem do ADC
+#define LEVEL_METER_MIN_DB_Q8 0 // Piso da escala (RMS de 1 contagem ou menos)
+#define LEVEL_METER_DB(x) ((int32_t)((x) * 256)) // dB inteiros em Q8
+
+// Balística por bloco: frações (Q8) da diferença em dB vencidas a cada bloco na subida e na
+// descida (256 = instantâneo), e o pico retido por 'peak_hold_blocks' antes de cair
+// 'peak_fall_db_q8' por bloco. Com blocos de 16 ms:
+//  - VU: subida e descida iguais, ~300 ms até 99%
+//  - PPM: subida em ~10 ms, descida com constante de tempo de ~250 ms, pico retido por 1 s
+typedef struct {
+    uint16_t attack_q8;
+    uint16_t release_q8;
+    uint16_t peak_hold_blocks;
+    uint16_t peak_fall_db_q8;
+} level_meter_config_t;
+
+#define LEVEL_METER_VU { .attack_q8 = 56, .release_q8 = 56, .peak_hold_blocks = 0, .peak_fall_db_q8 = 256 }
+#define LEVEL_METER_PPM { .attack_q8 = 205, .release_q8 = 16, .peak_hold_blocks = 62, .peak_fall_db_q8 = 64 }
+
+typedef struct {
+    level_meter_config_t config;
+    int32_t level_db_q8; // Nível com a balística aplicada
+    int32_t peak_db_q8; // Pico retido
+    uint16_t peak_age; // Blocos desde o último pico
+} level_meter_t;
+
+int32_t level_meter_log2_q8(uint32_t x);
+int32_t level_meter_db_q8(uint32_t rms_q4);
+void level_meter_init(level_meter_t *meter, const level_meter_config_t *config);
+int32_t level_meter_update(level_meter_t *meter, uint32_t rms_q4);
+uint8_t level_meter_quantize(int32_t db_q8, int32_t min_db_q8, int32_t step_db_q8, uint8_t levels);
+uint8_t level_meter_quantize_hysteresis(int32_t db_q8, int32_t min_db_q8, int32_t step_db_q8, uint8_t levels,
+                                        uint8_t previous, int32_t hysteresis_db_q8);
+
+#endif
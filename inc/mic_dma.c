@@ -0,0 +1,133 @@
+#include <assert.h>
+#include "hal.h"
+#include "mic_dma.h"
+#include "trace.h"
+
+// Buffer em anel: o bloco n (contando desde o início) fica sempre na metade n % 2
+static uint16_t mic_ring[MIC_DMA_BLOCKS][MIC_DMA_RAW_SAMPLES] __attribute__((aligned(4)));
+
+// Bloco do microfone entregue ao consumidor, separado dos outros canais e decimado
+// (o processamento é todo feito fora da interrupção)
+#if MIC_DMA_OVERSAMPLE
+static decimator_t mic_decimator;
+#endif
+static uint16_t mic_block[MIC_DMA_BLOCK_SAMPLES];
+
+static uint mic_slot; // Posição do microfone entre os canais intercalados
+static uint16_t mic_aux_values[MIC_DMA_MAX_CHANNELS]; // Média de cada canal auxiliar no último bloco
+
+static volatile uint32_t mic_blocks_completed; // Escrito apenas pela interrupção
+static uint32_t mic_blocks_read; // Escrito apenas pelo consumidor
+static uint32_t mic_blocks_lost;
+static mic_dma_block_cb_t mic_callback;
+
+// Registra um bloco completo; chamada pela interrupção do DMA
+static void mic_dma_block_complete(uint half) {
+    mic_blocks_completed++;
+    TRACE_INSTANT(TRACE_ADC_BLOCK, half, mic_blocks_completed);
+
+    if (mic_callback) {
+        mic_callback(mic_ring[half], MIC_DMA_RAW_SAMPLES);
+    }
+}
+
+// Configura a captura contínua do canal na taxa pedida, em ping-pong sobre o buffer em anel,
+// com os canais de MIC_DMA_AUX_MASK intercalados. Com MIC_DMA_OVERSAMPLE, o ADC roda
+// DECIMATOR_RATIO vezes mais rápido e 'sample_rate' é a taxa depois da decimação.
+void mic_dma_init(uint adc_channel, uint32_t sample_rate) {
+    uint mask = MIC_DMA_AUX_MASK | (1u << adc_channel);
+
+    assert(!(MIC_DMA_AUX_MASK & (1u << adc_channel)));
+    mic_slot = __builtin_popcount(mask & ((1u << adc_channel) - 1));
+    for (uint i = 0; i < MIC_DMA_MAX_CHANNELS; i++) {
+        mic_aux_values[i] = 2048; // Centro até o primeiro bloco
+    }
+
+#if MIC_DMA_OVERSAMPLE
+    sample_rate *= DECIMATOR_RATIO;
+#endif
+    hal_adc_stream_init(mask, sample_rate, mic_ring[0], MIC_DMA_RAW_SAMPLES, MIC_DMA_BLOCKS, mic_dma_block_complete);
+}
+
+// Média de cada canal auxiliar no bloco (o ruído do joystick some de graça)
+static void mic_dma_update_aux(const uint16_t *raw) {
+    uint slot = 0;
+
+    for (uint channel = 0; channel < MIC_DMA_MAX_CHANNELS; channel++) {
+        uint32_t sum = 0;
+
+        if (!(MIC_DMA_AUX_MASK & (1u << channel))) {
+            continue;
+        }
+        if (slot == mic_slot) {
+            slot++; // Pula o microfone
+        }
+        for (uint i = slot; i < MIC_DMA_RAW_SAMPLES; i += MIC_DMA_CHANNELS) {
+            sum += raw[i];
+        }
+        mic_aux_values[channel] = sum / (MIC_DMA_RAW_SAMPLES / MIC_DMA_CHANNELS);
+        slot++;
+    }
+}
+
+// Liga a captura contínua a partir da primeira metade do buffer
+void mic_dma_start(void) {
+    mic_blocks_completed = 0;
+    mic_blocks_read = 0;
+#if MIC_DMA_OVERSAMPLE
+    decimator_init(&mic_decimator);
+#endif
+    hal_adc_stream_start();
+}
+
+// Desliga a captura
+void mic_dma_stop(void) {
+    hal_adc_stream_stop();
+}
+
+// Função opcional chamada a cada bloco completo (contexto de interrupção)
+void mic_dma_set_callback(mic_dma_block_cb_t callback) {
+    mic_callback = callback;
+}
+
+// Retorna o bloco completo mais recente ainda não lido, ou NULL se não há bloco novo.
+// O bloco é separado dos canais auxiliares (e decimado, com MIC_DMA_OVERSAMPLE) aqui e vale
+// até a próxima chamada; um bloco perdido deixa um transiente no filtro.
+const uint16_t *mic_dma_get_block(void) {
+    uint32_t done = mic_blocks_completed;
+
+    if (done == mic_blocks_read) {
+        return NULL;
+    }
+
+    // Blocos que foram sobrescritos antes de serem lidos
+    mic_blocks_lost += done - mic_blocks_read - 1;
+    mic_blocks_read = done;
+
+    const uint16_t *raw = mic_ring[(done - 1) % MIC_DMA_BLOCKS];
+    mic_dma_update_aux(raw);
+
+#if MIC_DMA_OVERSAMPLE
+    decimator_process(&mic_decimator, raw + mic_slot, MIC_DMA_RAW_SAMPLES / MIC_DMA_CHANNELS, MIC_DMA_CHANNELS, mic_block);
+#else
+    for (uint i = 0; i < MIC_DMA_BLOCK_SAMPLES; i++) {
+        mic_block[i] = raw[mic_slot + i * MIC_DMA_CHANNELS];
+    }
+#endif
+    return mic_block;
+}
+
+// Média do canal auxiliar no último bloco lido por mic_dma_get_block() (2048 antes do primeiro)
+uint16_t mic_dma_aux(uint adc_channel) {
+    return mic_aux_values[adc_channel];
+}
+
+// Total de blocos completados desde mic_dma_start()
+uint32_t mic_dma_blocks_done(void) {
+    return mic_blocks_completed;
+}
+
+// Total de blocos que o consumidor não chegou a ler
+uint32_t mic_dma_overruns(void) {
+    return mic_blocks_lost;
+}
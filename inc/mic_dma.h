@@ -0,0 +1,41 @@
+#include "hal.h"
+#include "decimator.h"
+
+#ifndef mic_dma_inc_h
+#define mic_dma_inc_h
+
+#define MIC_DMA_BLOCK_SAMPLES 256 // Amostras de áudio por bloco entregue
+#define MIC_DMA_BLOCKS 2 // Duas metades: enquanto uma é lida, a outra é escrita
+
+#ifndef MIC_DMA_OVERSAMPLE
+#define MIC_DMA_OVERSAMPLE 1 // 1: ADC a DECIMATOR_RATIO vezes a taxa do áudio, com decimação; 0: ADC na taxa do áudio
+#endif
+
+// Canais lidos junto com o microfone no round-robin do ADC (o joystick, VRX e VRY), na mesma
+// taxa; o valor de cada um é a média do último bloco (mic_dma_aux)
+#ifndef MIC_DMA_AUX_MASK
+#define MIC_DMA_AUX_MASK 0x3u
+#endif
+#define MIC_DMA_CHANNELS (1 + __builtin_popcount(MIC_DMA_AUX_MASK))
+#define MIC_DMA_MAX_CHANNELS 5 // Entradas do ADC do RP2040 (4 = sensor de temperatura)
+
+#if MIC_DMA_OVERSAMPLE
+#define MIC_DMA_RAW_SAMPLES (MIC_DMA_BLOCK_SAMPLES * DECIMATOR_RATIO * MIC_DMA_CHANNELS) // Amostras brutas por bloco
+#else
+#define MIC_DMA_RAW_SAMPLES (MIC_DMA_BLOCK_SAMPLES * MIC_DMA_CHANNELS)
+#endif
+
+// Função chamada (em contexto de interrupção) a cada bloco completo, com as amostras brutas
+// (intercaladas com as dos canais auxiliares)
+typedef void (*mic_dma_block_cb_t)(const uint16_t *block, uint count);
+
+void mic_dma_init(uint adc_channel, uint32_t sample_rate);
+void mic_dma_start(void);
+void mic_dma_stop(void);
+void mic_dma_set_callback(mic_dma_block_cb_t callback);
+const uint16_t *mic_dma_get_block(void);
+uint16_t mic_dma_aux(uint adc_channel);
+uint32_t mic_dma_blocks_done(void);
+uint32_t mic_dma_overruns(void);
+
+#endif
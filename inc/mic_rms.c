@@ -0,0 +1,102 @@
+#include <string.h>
+#include "mic_rms.h"
+
+// Tolerâncias em relação ao cálculo antigo em float (sqrtf da média dos quadrados):
+//  - mic_rms_raw() trunca a raiz, então fica entre -1 e 0 contagens do valor em float;
+//  - mic_rms_ac_q4() trunca em 1/16 de contagem, então fica entre -1/16 e 0 do
+//    desvio padrão em float (sqrtf(E[x²] - E[x]²)) calculado sobre as mesmas amostras.
+
+// Raiz quadrada inteira (piso), bit a bit, sem divisões
+uint32_t mic_rms_isqrt64(uint64_t x) {
+    uint64_t result = 0;
+    uint64_t bit = 1ull << 62;
+
+    while (bit > x) {
+        bit >>= 2;
+    }
+
+    while (bit) {
+        if (x >= result + bit) {
+            x -= result + bit;
+            result = (result >> 1) + bit;
+        }
+        else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return (uint32_t)result;
+}
+
+// Soma as amostras e seus quadrados; 256 quadrados de 12 bits cabem em 32 bits
+void mic_rms_accumulate(mic_rms_acc_t *acc, const uint16_t *samples, uint32_t count) {
+    uint32_t sum = 0;
+    uint64_t sumsq = 0;
+
+    acc->count += count;
+
+    while (count) {
+        uint32_t n = count < 256 ? count : 256;
+        uint32_t partial = 0;
+
+        count -= n;
+        while (n--) {
+            uint32_t x = *samples++;
+            sum += x;
+            partial += x * x;
+        }
+        sumsq += partial;
+    }
+
+    acc->sum += sum;
+    acc->sumsq += sumsq;
+}
+
+// Nível DC (média) em contagens do ADC
+uint32_t mic_rms_dc(const mic_rms_acc_t *acc) {
+    return acc->count ? acc->sum / acc->count : 0;
+}
+
+// RMS sem remover o DC, equivalente inteiro do antigo mic_power()
+uint32_t mic_rms_raw(const mic_rms_acc_t *acc) {
+    return acc->count ? mic_rms_isqrt64(acc->sumsq / acc->count) : 0;
+}
+
+// RMS com o DC removido (desvio padrão), em Q4: n²·var = n·Σx² - (Σx)²
+uint32_t mic_rms_ac_q4(const mic_rms_acc_t *acc) {
+    if (acc->count == 0) {
+        return 0;
+    }
+
+    uint64_t n = acc->count;
+    uint64_t var_n2 = n * acc->sumsq - (uint64_t)acc->sum * acc->sum;
+
+    return mic_rms_isqrt64((var_n2 << (2 * MIC_RMS_FRAC_BITS)) / (n * n));
+}
+
+// Esvazia a janela deslizante
+void mic_rms_window_init(mic_rms_window_t *win) {
+    memset(win, 0, sizeof(*win));
+}
+
+// Acrescenta um bloco à janela, descartando o mais antigo, e retorna o RMS AC (Q4) da janela.
+// Só o bloco novo é percorrido; o restante é atualizado pelas somas parciais.
+uint32_t mic_rms_window_push(mic_rms_window_t *win, const uint16_t *samples, uint32_t count) {
+    mic_rms_acc_t *slot = &win->blocks[win->head];
+
+    win->total.count -= slot->count;
+    win->total.sum -= slot->sum;
+    win->total.sumsq -= slot->sumsq;
+
+    memset(slot, 0, sizeof(*slot));
+    mic_rms_accumulate(slot, samples, count);
+
+    win->total.count += slot->count;
+    win->total.sum += slot->sum;
+    win->total.sumsq += slot->sumsq;
+
+    win->head = (win->head + 1) % MIC_RMS_WINDOW_BLOCKS;
+
+    return mic_rms_ac_q4(&win->total);
+}
@@ -0,0 +1,32 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef mic_rms_inc_h
+#define mic_rms_inc_h
+
+#define MIC_RMS_WINDOW_BLOCKS 4 // Blocos na janela deslizante
+#define MIC_RMS_FRAC_BITS 4 // Resultado em Q4 (1/16 de contagem do ADC)
+
+// Somas parciais de um trecho de amostras (tudo inteiro, sem FPU)
+typedef struct {
+    uint32_t count;
+    uint32_t sum;
+    uint64_t sumsq;
+} mic_rms_acc_t;
+
+// Janela deslizante com as somas parciais dos últimos MIC_RMS_WINDOW_BLOCKS blocos
+typedef struct {
+    mic_rms_acc_t blocks[MIC_RMS_WINDOW_BLOCKS];
+    mic_rms_acc_t total;
+    uint8_t head;
+} mic_rms_window_t;
+
+uint32_t mic_rms_isqrt64(uint64_t x);
+void mic_rms_accumulate(mic_rms_acc_t *acc, const uint16_t *samples, uint32_t count);
+uint32_t mic_rms_dc(const mic_rms_acc_t *acc);
+uint32_t mic_rms_raw(const mic_rms_acc_t *acc);
+uint32_t mic_rms_ac_q4(const mic_rms_acc_t *acc);
+void mic_rms_window_init(mic_rms_window_t *win);
+uint32_t mic_rms_window_push(mic_rms_window_t *win, const uint16_t *samples, uint32_t count);
+
+#endif
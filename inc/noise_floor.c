@@ -0,0 +1,77 @@
+#include "noise_floor.h"
+
+// Estimador do piso de ruído.
+//
+// A calibração tira a média do RMS e do DC de NOISE_FLOOR_CAL_BLOCKS blocos. Depois, o piso
+// segue um percentil baixo do RMS pelo método "frugal": cada bloco abaixo do piso o puxa para
+// baixo e cada bloco acima o empurra para cima, com passos na proporção (1 - p) : p, o que só
+// fica em equilíbrio quando uma fração p dos blocos está abaixo dele. Sons longos e altos
+// (fervura, exaustor) sobem o piso devagar; o silêncio o traz de volta rápido.
+//
+// Blocos tonais (o próprio apito) não entram nem na calibração nem no acompanhamento, e o
+// teto NOISE_FLOOR_MAX_Q4 impede que um som contínuo cegue o detector.
+
+// Começa sem piso (o nível é absoluto) e já calibrando
+void noise_floor_init(noise_floor_t *nf) {
+    nf->floor_q4 = 0;
+    nf->dc_q4 = 2048u << 4; // Meio da escala, até a primeira medida
+    noise_floor_calibrate(nf);
+}
+
+// Recomeça a calibração; o piso atual continua valendo até ela terminar
+void noise_floor_calibrate(noise_floor_t *nf) {
+    nf->cal_remaining = NOISE_FLOOR_CAL_BLOCKS;
+    nf->cal_count = 0;
+    nf->cal_rms_sum = 0;
+    nf->cal_dc_sum = 0;
+}
+
+// Acompanha o percentil com passos proporcionais ao piso (no mínimo 1/16 de contagem)
+static void noise_floor_track(noise_floor_t *nf, uint32_t rms_q4) {
+    uint32_t step = (nf->floor_q4 >> NOISE_FLOOR_STEP_SHIFT) + 1;
+    uint32_t up = (step * NOISE_FLOOR_PERCENTILE_Q8 + 255) >> 8;
+    uint32_t down = (step * (256 - NOISE_FLOOR_PERCENTILE_Q8) + 255) >> 8;
+
+    if (rms_q4 < nf->floor_q4) {
+        nf->floor_q4 = nf->floor_q4 - rms_q4 > down ? nf->floor_q4 - down : rms_q4;
+    }
+    else if (rms_q4 > nf->floor_q4) {
+        nf->floor_q4 = rms_q4 - nf->floor_q4 > up ? nf->floor_q4 + up : rms_q4;
+    }
+
+    if (nf->floor_q4 > NOISE_FLOOR_MAX_Q4) {
+        nf->floor_q4 = NOISE_FLOOR_MAX_Q4;
+    }
+}
+
+// Atualiza o piso e o DC com o RMS e a média de um bloco
+void noise_floor_update(noise_floor_t *nf, uint32_t rms_q4, uint32_t dc_q4, bool tonal) {
+    if (nf->cal_remaining > 0) {
+        if (!tonal) {
+            nf->cal_rms_sum += rms_q4;
+            nf->cal_dc_sum += dc_q4;
+            nf->cal_count++;
+        }
+        // Se a calibração inteira foi tonal, fica o piso anterior
+        if (--nf->cal_remaining == 0 && nf->cal_count > 0) {
+            nf->floor_q4 = nf->cal_rms_sum / nf->cal_count;
+            nf->dc_q4 = nf->cal_dc_sum / nf->cal_count;
+            if (nf->floor_q4 > NOISE_FLOOR_MAX_Q4) {
+                nf->floor_q4 = NOISE_FLOOR_MAX_Q4;
+            }
+        }
+        return;
+    }
+
+    if (tonal) {
+        return;
+    }
+    noise_floor_track(nf, rms_q4);
+    nf->dc_q4 = nf->dc_q4 + (((int32_t)dc_q4 - (int32_t)nf->dc_q4) >> NOISE_FLOOR_DC_SHIFT);
+}
+
+// RMS acima do piso com margem (Q4); 0 para o que é só ruído de fundo
+uint32_t noise_floor_excess_q4(const noise_floor_t *nf, uint32_t rms_q4) {
+    uint32_t threshold = (nf->floor_q4 * NOISE_FLOOR_MARGIN_Q8) >> 8;
+    return rms_q4 > threshold ? rms_q4 - threshold : 0;
+}
@@ -0,0 +1,30 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef noise_floor_inc_h
+#define noise_floor_inc_h
+
+#define NOISE_FLOOR_CAL_BLOCKS 32 // Blocos medidos na calibração (~0,5 s a 16 kHz)
+#define NOISE_FLOOR_PERCENTILE_Q8 51 // Percentil do RMS acompanhado como piso (20% em Q8)
+#define NOISE_FLOOR_STEP_SHIFT 6 // Passo do acompanhamento: 1/64 do piso por bloco
+#define NOISE_FLOOR_DC_SHIFT 4 // Média exponencial do DC: 1/16 por bloco
+#define NOISE_FLOOR_MARGIN_Q8 384 // O nível conta a partir de 1,5x o piso (+3,5 dB)
+#define NOISE_FLOOR_MAX_Q4 (48u << 4) // Teto do piso: 48 contagens de RMS, bem abaixo de um apito
+
+// Piso de ruído (RMS sem DC) e nível DC do microfone, calibrados por uma média curta e depois
+// acompanhados bloco a bloco em O(1), sem guardar histórico
+typedef struct {
+    uint32_t floor_q4; // Piso de ruído (Q4, contagens do ADC)
+    uint32_t dc_q4; // Nível DC (Q4, contagens do ADC)
+    uint16_t cal_remaining; // Blocos que faltam na calibração (0 = acompanhando)
+    uint16_t cal_count; // Blocos aproveitados na calibração
+    uint32_t cal_rms_sum;
+    uint32_t cal_dc_sum;
+} noise_floor_t;
+
+void noise_floor_init(noise_floor_t *nf);
+void noise_floor_calibrate(noise_floor_t *nf);
+void noise_floor_update(noise_floor_t *nf, uint32_t rms_q4, uint32_t dc_q4, bool tonal);
+uint32_t noise_floor_excess_q4(const noise_floor_t *nf, uint32_t rms_q4);
+
+#endif
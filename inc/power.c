@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include "hal.h"
+#include "power.h"
+#include "audio.h"
+#include "event_sched.h"
+
+// Política de energia: cada modo junta um clock do sistema e o estado da captura do ADC.
+// Sem captura não há interrupção do DMA a cada 16 ms, e os dois cores dormem até o próximo
+// alarme ou botão (a USB, se conectada, ainda acorda o core0 a cada 1 ms para o seu serviço).
+
+static power_mode_t power_current = POWER_ACTIVE;
+static uint32_t power_full_khz; // Clock do boot, restaurado no modo ativo
+
+/**
+ * Guarda o clock do boot; chamada depois da inicialização do hardware.
+ */
+void power_init(void) {
+    power_full_khz = hal_sys_clock_hz() / 1000;
+    power_current = POWER_ACTIVE;
+}
+
+/**
+ * Troca o modo. O clock muda antes de a captura voltar e depois de ela parar, para que o
+ * DSP nunca rode no clock reduzido com mais trabalho do que o modo prevê.
+ */
+void power_set_mode(power_mode_t mode) {
+    if (mode == power_current) {
+        return;
+    }
+
+    if (mode == POWER_ACTIVE) {
+        hal_set_sys_clock_khz(power_full_khz);
+    }
+    audio_set_capture(mode != POWER_COUNTDOWN);
+    if (mode != POWER_ACTIVE && !hal_set_sys_clock_khz(POWER_LOW_KHZ)) {
+        printf("Clock de %u kHz indisponivel\n", (unsigned)POWER_LOW_KHZ);
+    }
+    power_current = mode;
+}
+
+power_mode_t power_mode(void) {
+    return power_current;
+}
+
+/**
+ * Imprime o ciclo de trabalho do core0 e a latência de despertar desde a última zeragem.
+ */
+void power_report(bool reset) {
+    static const char *const names[] = { "ativo", "escuta", "contagem" };
+    sched_stats_t stats;
+
+    sched_get_stats(&stats, reset);
+    uint32_t elapsed_ms = stats.elapsed_us / 1000;
+    uint32_t duty_permille = stats.elapsed_us ? 1000 - stats.sleep_us * 1000 / stats.elapsed_us : 0;
+    uint32_t latency_avg = stats.latency_count ? stats.latency_sum_us / stats.latency_count : 0;
+
+    printf("energia: modo %s, %lu kHz, %lu ms: acordado %lu.%lu%%, %lu despertares, latencia media %lu us, max %lu us\n",
+           names[power_current], (unsigned long)(hal_sys_clock_hz() / 1000), (unsigned long)elapsed_ms,
+           (unsigned long)(duty_permille / 10), (unsigned long)(duty_permille % 10), (unsigned long)stats.wakeups,
+           (unsigned long)latency_avg, (unsigned long)stats.latency_max_us);
+}
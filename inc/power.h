@@ -0,0 +1,23 @@
+#include "hal.h"
+
+#ifndef power_inc_h
+#define power_inc_h
+
+#ifndef POWER_LOW_KHZ
+#define POWER_LOW_KHZ 48000 // Clock reduzido: folga para o DSP de um bloco e a USB continua a 48 MHz
+#endif
+
+// Modos de consumo, do mais acordado ao mais econômico. O laço principal sempre dorme entre
+// eventos (sched_run); o modo decide o clock e quem pode acordá-lo.
+typedef enum {
+    POWER_ACTIVE, // Clock cheio, captura ligada (menus, espectro, gravação)
+    POWER_LISTEN, // Clock reduzido, captura ligada: acorda a cada bloco do DMA
+    POWER_COUNTDOWN, // Clock reduzido, captura desligada: só alarmes e bordas de GPIO acordam
+} power_mode_t;
+
+void power_init(void);
+void power_set_mode(power_mode_t mode);
+power_mode_t power_mode(void);
+void power_report(bool reset);
+
+#endif
@@ -0,0 +1,280 @@
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "hal.h"
+#include "adpcm.h"
+#include "recorder.h"
+
+// Gravador de áudio em IMA-ADPCM na flash.
+//
+// O core de áudio codifica cada bloco (recorder_push_block) num de dois buffers do tamanho de
+// um setor; quando um enche, passa a usar o outro e o core0 grava o cheio página por página
+// em recorder_poll(). Uma página leva ~1 ms com o XIP parado, menos que um bloco do ADC, então
+// a captura nunca espera pela flash: se o core0 atrasar e os dois buffers estiverem ocupados,
+// o bloco novo é descartado (e contado) e o codificador continua do estado anterior.
+//
+// Apagar é lento demais para o meio da gravação (dezenas a centenas de ms), então a região
+// inteira é apagada, em blocos de 64 KB, antes de a captura começar. E é lento demais para
+// a captura em si: quem chama recorder_poll() só libera o apagamento com o ADC parado.
+
+_Static_assert(RECORDER_FLASH_SIZE % HAL_FLASH_BLOCK_SIZE == 0, "a região é apagada em blocos de 64 KB");
+
+// Compartilhado entre os cores
+static uint8_t recorder_buffers[2][HAL_FLASH_SECTOR_SIZE];
+static _Atomic uint32_t recorder_ready[2]; // Bytes prontos para gravar (0 = buffer livre)
+static _Atomic bool recorder_capturing = false;
+static _Atomic bool recorder_stop_request = false;
+static _Atomic bool recorder_capture_done = false;
+static volatile uint32_t recorder_captured; // Bytes codificados até agora
+static volatile uint32_t recorder_dropped;
+
+// Estado do produtor (core de áudio)
+static adpcm_state_t recorder_adpcm;
+static uint recorder_fill; // Buffer sendo preenchido
+static uint32_t recorder_fill_pos;
+
+// Estado do consumidor (core0)
+static recorder_state_t recorder_current = RECORDER_IDLE;
+static uint32_t recorder_sample_rate;
+static uint32_t recorder_erase_offset;
+static uint recorder_program; // Buffer sendo gravado
+static uint32_t recorder_program_pos;
+static uint32_t recorder_write_offset; // Setor de destino na flash
+static uint32_t recorder_dump_pos;
+static uint32_t recorder_dump_length;
+
+void recorder_init(uint32_t sample_rate) {
+    recorder_sample_rate = sample_rate;
+}
+
+/**
+ * Começa uma gravação nova (apaga a anterior); retorna false se o gravador está ocupado.
+ */
+bool recorder_start(void) {
+    if (recorder_current != RECORDER_IDLE) {
+        return false;
+    }
+    recorder_erase_offset = 0;
+    recorder_current = RECORDER_ERASING;
+    return true;
+}
+
+/**
+ * Para a gravação. O que já foi capturado continua indo para a flash em recorder_poll(),
+ * que termina escrevendo o cabeçalho; parar durante o apagamento descarta tudo.
+ */
+void recorder_stop(void) {
+    if (recorder_current == RECORDER_ERASING) {
+        recorder_current = RECORDER_IDLE;
+    }
+    else if (recorder_current == RECORDER_RECORDING) {
+        atomic_store_explicit(&recorder_stop_request, true, memory_order_release);
+    }
+}
+
+// Região apagada: zera os buffers e libera o core de áudio para codificar
+static void recorder_begin_capture(void) {
+    adpcm_init(&recorder_adpcm);
+    recorder_fill = recorder_fill_pos = 0;
+    recorder_program = recorder_program_pos = 0;
+    recorder_write_offset = RECORDER_DATA_OFFSET;
+    recorder_captured = recorder_dropped = 0;
+    atomic_store_explicit(&recorder_ready[0], 0, memory_order_relaxed);
+    atomic_store_explicit(&recorder_ready[1], 0, memory_order_relaxed);
+    atomic_store_explicit(&recorder_stop_request, false, memory_order_relaxed);
+    atomic_store_explicit(&recorder_capture_done, false, memory_order_relaxed);
+    atomic_store_explicit(&recorder_capturing, true, memory_order_release);
+    recorder_current = RECORDER_RECORDING;
+}
+
+/**
+ * Codifica um bloco do ADC, se houver gravação em andamento. Roda no core de áudio e nunca
+ * espera: sem buffer livre, o bloco é descartado.
+ */
+void recorder_push_block(const uint16_t *samples, uint count) {
+    if (!atomic_load_explicit(&recorder_capturing, memory_order_acquire)) {
+        return;
+    }
+
+    uint32_t bytes = count / 2;
+    bool full = recorder_captured + bytes > RECORDER_DATA_SIZE;
+
+    if (atomic_load_explicit(&recorder_stop_request, memory_order_acquire) || full) {
+        // Entrega o setor parcial e encerra a captura
+        if (recorder_fill_pos > 0) {
+            atomic_store_explicit(&recorder_ready[recorder_fill], recorder_fill_pos, memory_order_release);
+        }
+        atomic_store_explicit(&recorder_capturing, false, memory_order_relaxed);
+        atomic_store_explicit(&recorder_capture_done, true, memory_order_release);
+        return;
+    }
+
+    // Um buffer só é reaproveitado depois que o core0 terminou de gravá-lo
+    if (recorder_fill_pos == 0 && atomic_load_explicit(&recorder_ready[recorder_fill], memory_order_acquire) != 0) {
+        recorder_dropped++;
+        return;
+    }
+
+    adpcm_encode_adc(&recorder_adpcm, samples, count, recorder_buffers[recorder_fill] + recorder_fill_pos);
+    recorder_fill_pos += bytes;
+    recorder_captured += bytes;
+
+    if (recorder_fill_pos + bytes > HAL_FLASH_SECTOR_SIZE) {
+        atomic_store_explicit(&recorder_ready[recorder_fill], recorder_fill_pos, memory_order_release);
+        recorder_fill ^= 1;
+        recorder_fill_pos = 0;
+    }
+}
+
+// Grava a próxima página do buffer pronto; retorna false se não havia nenhum
+static bool recorder_program_page(void) {
+    uint32_t length = atomic_load_explicit(&recorder_ready[recorder_program], memory_order_acquire);
+    uint8_t page[HAL_FLASH_PAGE_SIZE];
+    const uint8_t *data = recorder_buffers[recorder_program] + recorder_program_pos;
+
+    if (length == 0) {
+        return false;
+    }
+
+    // Última página de um setor parcial: completa com 0xFF (não altera a flash apagada)
+    if (length - recorder_program_pos < HAL_FLASH_PAGE_SIZE) {
+        memset(page, 0xFF, sizeof(page));
+        memcpy(page, data, length - recorder_program_pos);
+        data = page;
+    }
+    hal_flash_program(recorder_write_offset + recorder_program_pos, data, HAL_FLASH_PAGE_SIZE);
+    recorder_program_pos += HAL_FLASH_PAGE_SIZE;
+
+    if (recorder_program_pos >= length) {
+        recorder_write_offset += HAL_FLASH_SECTOR_SIZE;
+        recorder_program_pos = 0;
+        atomic_store_explicit(&recorder_ready[recorder_program], 0, memory_order_release);
+        recorder_program ^= 1;
+    }
+    return true;
+}
+
+// Tudo gravado: escreve o cabeçalho, o que torna a gravação válida
+static void recorder_finish(void) {
+    uint8_t page[HAL_FLASH_PAGE_SIZE];
+    recorder_header_t header = {
+        .magic = RECORDER_MAGIC,
+        .sample_rate = recorder_sample_rate,
+        .data_bytes = recorder_captured,
+        .dropped_blocks = recorder_dropped,
+    };
+
+    memset(page, 0xFF, sizeof(page));
+    memcpy(page, &header, sizeof(header));
+    hal_flash_program(RECORDER_FLASH_OFFSET, page, sizeof(page));
+    recorder_current = RECORDER_IDLE;
+}
+
+// Envia uma linha "#R" com os próximos bytes (o cabeçalho sai sozinho na primeira)
+static void recorder_dump_line(void) {
+    static const char hex[] = "0123456789abcdef";
+    char line[2 + RECORDER_DUMP_LINE * 2 + 1];
+    const uint8_t *data;
+    uint32_t n;
+    char *out = line;
+
+    if (recorder_dump_pos == 0) {
+        data = hal_flash_data(RECORDER_FLASH_OFFSET);
+        n = sizeof(recorder_header_t);
+    }
+    else {
+        data = hal_flash_data(RECORDER_DATA_OFFSET + recorder_dump_pos - sizeof(recorder_header_t));
+        n = recorder_dump_length - recorder_dump_pos;
+        if (n > RECORDER_DUMP_LINE) n = RECORDER_DUMP_LINE;
+    }
+
+    *out++ = '#';
+    *out++ = 'R';
+    for (uint32_t i = 0; i < n; i++) {
+        *out++ = hex[data[i] >> 4];
+        *out++ = hex[data[i] & 0xF];
+    }
+    *out++ = '\n';
+    fwrite(line, 1, out - line, stdout);
+
+    recorder_dump_pos += n;
+    if (recorder_dump_pos >= recorder_dump_length) {
+        fputs("#R-\n", stdout); // Fim da gravação
+        recorder_current = RECORDER_IDLE;
+    }
+}
+
+/**
+ * Começa a enviar a última gravação pela stdio, uma linha por chamada de recorder_poll().
+ */
+bool recorder_dump_start(void) {
+    const recorder_header_t *header = (const recorder_header_t *)hal_flash_data(RECORDER_FLASH_OFFSET);
+
+    if (recorder_current != RECORDER_IDLE) {
+        return false;
+    }
+    if (header->magic != RECORDER_MAGIC || header->data_bytes > RECORDER_DATA_SIZE) {
+        printf("Nenhuma gravacao na flash\n");
+        return false;
+    }
+
+    recorder_dump_pos = 0;
+    recorder_dump_length = sizeof(recorder_header_t) + header->data_bytes;
+    recorder_current = RECORDER_DUMPING;
+    return true;
+}
+
+/**
+ * Faz uma etapa do trabalho pendente na flash ou na stdio (apagar um bloco, gravar uma
+ * página, enviar uma linha). Chamada no core0 antes de dormir; retorna true se ainda há trabalho.
+ * Sem erase_ok (captura do ADC ainda ligada), o apagamento espera.
+ */
+bool recorder_poll(bool erase_ok) {
+    switch (recorder_current) {
+        case RECORDER_ERASING:
+            if (!erase_ok) {
+                return true;
+            }
+            hal_flash_erase(RECORDER_FLASH_OFFSET + recorder_erase_offset, HAL_FLASH_BLOCK_SIZE);
+            recorder_erase_offset += HAL_FLASH_BLOCK_SIZE;
+            if (recorder_erase_offset >= RECORDER_FLASH_SIZE) {
+                recorder_begin_capture();
+            }
+            return true;
+
+        case RECORDER_RECORDING:
+            if (recorder_program_page()) {
+                return true;
+            }
+            // Captura encerrada e os dois buffers já gravados
+            if (atomic_load_explicit(&recorder_capture_done, memory_order_acquire)) {
+                if (!recorder_program_page()) {
+                    recorder_finish();
+                }
+                return true;
+            }
+            return false;
+
+        case RECORDER_DUMPING:
+            recorder_dump_line();
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+recorder_state_t recorder_state(void) {
+    return recorder_current;
+}
+
+/**
+ * Bytes de áudio codificados na gravação atual (ou na última).
+ */
+uint32_t recorder_bytes(void) {
+    return recorder_captured;
+}
+
+uint32_t recorder_dropped_blocks(void) {
+    return recorder_dropped;
+}
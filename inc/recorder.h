@@ -0,0 +1,40 @@
+#include "hal.h"
+
+#ifndef recorder_inc_h
+#define recorder_inc_h
+
+// Região da gravação dentro da área de dados da flash: o primeiro setor guarda o cabeçalho
+// (escrito só no fim, para que uma gravação interrompida nunca pareça válida) e o resto, o áudio
+#define RECORDER_FLASH_OFFSET 0
+#define RECORDER_FLASH_SIZE (960u * 1024u) // 120 s a 16 kHz (múltiplo de HAL_FLASH_BLOCK_SIZE)
+#define RECORDER_DATA_OFFSET (RECORDER_FLASH_OFFSET + HAL_FLASH_SECTOR_SIZE)
+#define RECORDER_DATA_SIZE (RECORDER_FLASH_SIZE - HAL_FLASH_SECTOR_SIZE)
+#define RECORDER_MAGIC 0x31434441u // "ADC1"
+#define RECORDER_DUMP_LINE 64 // Bytes por linha "#R" no envio pela USB
+
+// Cabeçalho da gravação (little-endian; manter em sincronia com tools/adpcm_dump.py)
+typedef struct {
+    uint32_t magic;
+    uint32_t sample_rate;
+    uint32_t data_bytes; // Bytes de IMA-ADPCM (2 amostras por byte), estado inicial zerado
+    uint32_t dropped_blocks; // Blocos descartados por falta de buffer livre
+} recorder_header_t;
+
+typedef enum {
+    RECORDER_IDLE,
+    RECORDER_ERASING, // Apagando a região antes de começar
+    RECORDER_RECORDING, // Capturando (ou gravando na flash o que falta depois da parada)
+    RECORDER_DUMPING, // Enviando a gravação pela stdio
+} recorder_state_t;
+
+void recorder_init(uint32_t sample_rate);
+bool recorder_start(void);
+void recorder_stop(void);
+void recorder_push_block(const uint16_t *samples, uint count);
+bool recorder_poll(bool erase_ok);
+bool recorder_dump_start(void);
+recorder_state_t recorder_state(void);
+uint32_t recorder_bytes(void);
+uint32_t recorder_dropped_blocks(void);
+
+#endif
@@ -0,0 +1,99 @@
+#include <string.h>
+#include "spectrum.h"
+#include "ssd1306.h"
+
+// Primeiro bin de cada barra (a barra i usa os bins edge[i]..edge[i+1]-1), espaçados em
+// escala logarítmica de 125 Hz a 8 kHz para N = 256 a 16 kHz (62,5 Hz por bin). Nos graves
+// a escala pediria menos de um bin por barra, então ali cada barra fica com um bin só.
+static const uint8_t spectrum_edges[SPECTRUM_BARS + 1] = {
+    2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17,
+    18, 19, 21, 24, 27, 31, 35, 40, 45, 52, 59, 67, 76, 87, 99, 112,
+    128,
+};
+
+/**
+ * Reduz a saída da FFT a SPECTRUM_BARS níveis em unidades de 3/8 dB (log2 da potência
+ * em Q3), usando a maior potência entre os bins de cada barra. Roda no core de áudio.
+ */
+void spectrum_compute(const fft_complex_t *bins, uint8_t bars[SPECTRUM_BARS]) {
+    for (uint i = 0; i < SPECTRUM_BARS; i++) {
+        uint32_t power = 0;
+
+        for (uint k = spectrum_edges[i]; k < spectrum_edges[i + 1]; k++) {
+            uint32_t p = fft_power(&bins[k]);
+            if (p > power) power = p;
+        }
+
+        uint32_t level = fft_log2_q4(power) >> 1;
+        bars[i] = level > 255 ? 255 : level;
+    }
+}
+
+void spectrum_view_init(spectrum_view_t *view) {
+    memset(view, 0, sizeof(*view));
+}
+
+/**
+ * Acumula os níveis de um bloco até o próximo quadro (o display roda mais devagar que o áudio).
+ */
+void spectrum_view_push(spectrum_view_t *view, const uint8_t bars[SPECTRUM_BARS]) {
+    for (uint i = 0; i < SPECTRUM_BARS; i++) {
+        if (bars[i] > view->pending[i]) view->pending[i] = bars[i];
+    }
+}
+
+// Nível (3/8 dB) para altura em pixels
+static uint spectrum_height(uint level) {
+    if (level <= SPECTRUM_FLOOR) {
+        return 0;
+    }
+    level -= SPECTRUM_FLOOR;
+    return level >= SPECTRUM_RANGE ? SPECTRUM_HEIGHT : level * SPECTRUM_HEIGHT / SPECTRUM_RANGE;
+}
+
+/**
+ * Desenha as barras pendentes e os picos nas páginas de baixo do framebuffer, escrevendo
+ * os bytes de cada página diretamente (sem ssd1306_set_pixel), e zera as barras pendentes.
+ * Cada barra ocupa 3 colunas, com 1 de espaço; o pico é uma linha de 1 pixel acima dela.
+ * Chame depois de ssd1306_clear(), que marca a tela toda para o próximo ssd1306_flush().
+ */
+void spectrum_render(spectrum_view_t *view, uint8_t *ssd) {
+    const uint bottom = ssd1306_height; // Linha logo abaixo da última
+
+    for (uint i = 0; i < SPECTRUM_BARS; i++) {
+        uint h = spectrum_height(view->pending[i]);
+        view->pending[i] = 0;
+
+        if (h >= view->peak[i]) {
+            view->peak[i] = h;
+            view->hold[i] = SPECTRUM_PEAK_HOLD;
+        }
+        else if (view->hold[i] > 0) {
+            view->hold[i]--;
+        }
+        else {
+            view->peak[i] = view->peak[i] > SPECTRUM_PEAK_DECAY ? view->peak[i] - SPECTRUM_PEAK_DECAY : 0;
+        }
+
+        uint top = bottom - h;
+        uint peak_y = bottom - view->peak[i];
+
+        for (uint page = SPECTRUM_TOP_PAGE; page < ssd1306_n_pages; page++) {
+            uint y0 = page * ssd1306_page_height;
+            uint8_t bits;
+
+            if (top <= y0) bits = 0xFF;
+            else if (top >= y0 + ssd1306_page_height) bits = 0;
+            else bits = 0xFF << (top - y0);
+
+            // Marcador de pico na linha acima do topo que ele registrou
+            if (view->peak[i] > 0 && peak_y - 1 >= y0 && peak_y - 1 < y0 + ssd1306_page_height) {
+                bits |= 1u << (peak_y - 1 - y0);
+            }
+
+            uint8_t *column = ssd + page * ssd1306_width + i * (ssd1306_width / SPECTRUM_BARS);
+            column[0] = column[1] = column[2] = bits;
+            column[3] = 0;
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#include "hal.h"
+#include "fft.h"
+
+#ifndef spectrum_inc_h
+#define spectrum_inc_h
+
+#define SPECTRUM_BARS 32 // Barras na tela (4 colunas cada)
+#define SPECTRUM_TOP_PAGE 1 // A primeira página fica para o título
+#define SPECTRUM_HEIGHT 56 // Altura máxima das barras (pixels)
+#define SPECTRUM_FLOOR 96 // Nível mostrado como barra vazia (unidades de 3/8 dB)
+#define SPECTRUM_RANGE 112 // Faixa mostrada acima do piso (42 dB)
+#define SPECTRUM_PEAK_HOLD 20 // Quadros com o pico parado antes de começar a cair
+#define SPECTRUM_PEAK_DECAY 1 // Pixels por quadro de queda do pico
+
+// Estado da tela: barras acumuladas desde o último quadro e marcadores de pico
+typedef struct {
+    uint8_t pending[SPECTRUM_BARS]; // Máximo dos blocos recebidos desde o último quadro
+    uint8_t peak[SPECTRUM_BARS]; // Altura do marcador de pico (pixels)
+    uint8_t hold[SPECTRUM_BARS]; // Quadros restantes até o pico cair
+} spectrum_view_t;
+
+void spectrum_compute(const fft_complex_t *bins, uint8_t bars[SPECTRUM_BARS]);
+void spectrum_view_init(spectrum_view_t *view);
+void spectrum_view_push(spectrum_view_t *view, const uint8_t bars[SPECTRUM_BARS]);
+void spectrum_render(spectrum_view_t *view, uint8_t *ssd);
+
+#endif
@@ -0,0 +1,30 @@
+#include "anim.h"
+
+#ifndef spinner_anim_inc_h
+#define spinner_anim_inc_h
+
+// Gerado por tools/anim_convert.py a partir de 8 quadros 16x16: 178 bytes (256 sem compressão)
+static const uint8_t spinner_anim_data[] = {
+    0x00, 0x85, 0x00, 0x0c, 0x04, 0x0e, 0x0e, 0x00, 0x10, 0xf8, 0xd8, 0xe0, 0xc0, 0xc0, 0x00, 0x00,
+    0x01, 0x87, 0x00, 0x04, 0x03, 0x03, 0x07, 0x03, 0x03, 0x00, 0x86, 0x00, 0x07, 0x04, 0x00, 0x00,
+    0x10, 0x38, 0x98, 0xc0, 0x80, 0x89, 0x00, 0x06, 0x18, 0x3c, 0x3e, 0x3f, 0x3f, 0x01, 0x00, 0x01,
+    0x89, 0x00, 0x02, 0x10, 0x38, 0x18, 0x87, 0x00, 0x00, 0x20, 0x82, 0xf8, 0x06, 0xe0, 0x14, 0x22,
+    0x26, 0x3c, 0x00, 0x00, 0x00, 0x8c, 0x00, 0x00, 0x80, 0x83, 0x00, 0x0d, 0x3c, 0x3e, 0x3e, 0x3c,
+    0x38, 0x70, 0x70, 0x20, 0x08, 0x1c, 0x18, 0x01, 0x00, 0x00, 0x01, 0x00, 0x80, 0x82, 0xc0, 0x00,
+    0x80, 0x8a, 0x00, 0x06, 0x03, 0x03, 0x3b, 0x25, 0x21, 0x34, 0x18, 0x82, 0x00, 0x02, 0x08, 0x1c,
+    0x18, 0x82, 0x00, 0x00, 0x06, 0x00, 0x80, 0xbc, 0xfc, 0x7c, 0x3c, 0x18, 0x89, 0x00, 0x07, 0x01,
+    0x03, 0x19, 0x1c, 0x08, 0x00, 0x20, 0x20, 0x86, 0x00, 0x01, 0x09, 0x00, 0x00, 0x3c, 0x64, 0x44,
+    0x28, 0x07, 0x1f, 0x1f, 0x0e, 0x88, 0x00, 0x02, 0x18, 0x1c, 0x08, 0x89, 0x00, 0x00, 0x82, 0x00,
+    0x0a, 0x18, 0x38, 0x10, 0x04, 0x0e, 0x0e, 0x18, 0x3c, 0x7c, 0x7c, 0x3c, 0x83, 0x00, 0x00, 0x01,
+    0x8c, 0x00,
+};
+
+static const anim_t spinner_anim = {
+    .data = spinner_anim_data,
+    .frame_count = 8,
+    .frame_ms = 100,
+    .width = 16,
+    .pages = 2,
+};
+
+#endif
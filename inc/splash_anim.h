@@ -0,0 +1,86 @@
+#include "anim.h"
+
+#ifndef splash_anim_inc_h
+#define splash_anim_inc_h
+
+// Gerado por tools/anim_convert.py a partir de 8 quadros 128x64: 1083 bytes (8192 sem compressão)
+static const uint8_t splash_anim_data[] = {
+    0x00, 0xb2, 0x00, 0x02, 0x04, 0x18, 0xe0, 0x8b, 0x00, 0x01, 0x10, 0x0c, 0x87, 0x00, 0x01, 0xc0,
+    0x20, 0xe2, 0x00, 0x04, 0xc0, 0x20, 0x00, 0x00, 0x01, 0x86, 0x00, 0x02, 0xe0, 0x18, 0x06, 0x8a,
+    0x00, 0x01, 0x0f, 0x30, 0xe1, 0x00, 0x01, 0x3c, 0x03, 0x8b, 0x00, 0x04, 0x01, 0x02, 0x00, 0x00,
+    0xc0, 0x8c, 0x00, 0x02, 0x04, 0x18, 0xe0, 0xdf, 0x00, 0x01, 0x04, 0x08, 0x87, 0x00, 0x85, 0xc0,
+    0x01, 0xc3, 0xcc, 0x8b, 0x00, 0x01, 0x06, 0x01, 0xd1, 0x00, 0x83, 0x3c, 0x00, 0xfc, 0x92, 0x7c,
+    0x87, 0x7f, 0x92, 0x7c, 0x00, 0xfc, 0x83, 0x3c, 0xc1, 0x00, 0x00, 0x3c, 0x87, 0x24, 0x01, 0x3c,
+    0xff, 0xad, 0x00, 0x01, 0xff, 0x3c, 0x87, 0x24, 0x00, 0x3c, 0xc5, 0x00, 0x00, 0xff, 0xad, 0x00,
+    0x00, 0xff, 0xcf, 0x00, 0x00, 0x1f, 0x82, 0x10, 0x00, 0xb0, 0x82, 0x10, 0x00, 0x50, 0x82, 0x10,
+    0x00, 0xb0, 0x82, 0x10, 0x00, 0x50, 0x82, 0x10, 0x00, 0xb0, 0x82, 0x10, 0x00, 0x50, 0x82, 0x10,
+    0x00, 0xb0, 0x82, 0x10, 0x00, 0x50, 0x82, 0x10, 0x00, 0xb0, 0x82, 0x10, 0x00, 0x50, 0x85, 0x10,
+    0x00, 0x1f, 0xa7, 0x00, 0x01, 0xb2, 0x00, 0x02, 0x04, 0x58, 0xdc, 0x88, 0x00, 0x04, 0x80, 0x00,
+    0x00, 0x14, 0x0c, 0x86, 0x00, 0x02, 0xe0, 0xd8, 0x20, 0xe0, 0x00, 0x06, 0x80, 0x60, 0xd8, 0x20,
+    0x00, 0x00, 0x01, 0x86, 0x00, 0x02, 0xdc, 0xdb, 0x06, 0x8a, 0x00, 0x02, 0x0e, 0x36, 0x08, 0xe0,
+    0x00, 0x01, 0x3b, 0x0b, 0x8b, 0x00, 0x06, 0x01, 0x02, 0x00, 0x00, 0xd0, 0x60, 0x80, 0x8a, 0x00,
+    0x02, 0x04, 0xdb, 0xdc, 0xdf, 0x00, 0x02, 0x04, 0x0b, 0x0c, 0x8c, 0x00, 0x01, 0x0b, 0x0b, 0x8a,
+    0x00, 0x02, 0x01, 0x06, 0x01, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xd9, 0x00, 0x00, 0xe0, 0x82,
+    0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82,
+    0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82,
+    0x00, 0x00, 0xe0, 0xae, 0x00, 0x01, 0xb3, 0x00, 0x01, 0x58, 0x38, 0x86, 0x00, 0x05, 0x80, 0x60,
+    0x80, 0x00, 0x00, 0x04, 0x87, 0x00, 0x01, 0xdc, 0xd8, 0xe1, 0x00, 0x02, 0x70, 0x6c, 0x1a, 0x8a,
+    0x00, 0x02, 0x3b, 0xdb, 0x20, 0x8a, 0x00, 0x06, 0x01, 0x06, 0x0b, 0x00, 0x00, 0x40, 0x80, 0xdc,
+    0x00, 0x05, 0x07, 0x0b, 0x00, 0x00, 0x40, 0x80, 0x8b, 0x00, 0x02, 0x10, 0x6c, 0x70, 0x8a, 0x00,
+    0x02, 0x60, 0xdb, 0x3b, 0xe0, 0x00, 0x02, 0x03, 0x0d, 0x0e, 0x8a, 0x00, 0x02, 0x04, 0x0b, 0x07,
+    0x87, 0x00, 0x03, 0x08, 0x00, 0x00, 0x01, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xdb, 0x00, 0x00,
+    0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00,
+    0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00,
+    0xe0, 0x82, 0x00, 0x00, 0xe0, 0xae, 0x00, 0x01, 0xaf, 0x00, 0x05, 0x80, 0x00, 0x00, 0x04, 0x18,
+    0x04, 0x86, 0x00, 0x01, 0x70, 0x68, 0x8b, 0x00, 0x03, 0x38, 0xd8, 0x60, 0x80, 0xdf, 0x00, 0x02,
+    0xee, 0x6d, 0x82, 0x8a, 0x00, 0x02, 0x07, 0x1b, 0x2c, 0x8c, 0x00, 0x04, 0x03, 0x00, 0x00, 0x40,
+    0x70, 0xdd, 0x00, 0x05, 0x03, 0x00, 0x00, 0x40, 0xb0, 0xc0, 0x8a, 0x00, 0x02, 0x80, 0x6d, 0xee,
+    0x89, 0x00, 0x03, 0x10, 0x6c, 0x1b, 0x07, 0xe1, 0x00, 0x01, 0x0d, 0x0d, 0x8a, 0x00, 0x01, 0x05,
+    0x03, 0x87, 0x00, 0x01, 0x0e, 0x08, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xde, 0x00, 0x00, 0xe0,
+    0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0,
+    0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0,
+    0x82, 0x00, 0x00, 0xe0, 0xae, 0x00, 0x01, 0xae, 0x00, 0x04, 0xc0, 0xa0, 0x00, 0x00, 0x04, 0x88,
+    0x00, 0x02, 0xec, 0x68, 0x80, 0x8a, 0x00, 0x04, 0x04, 0x18, 0x6c, 0x90, 0x20, 0xde, 0x00, 0x02,
+    0x1d, 0x6d, 0xb0, 0x8b, 0x00, 0x05, 0x03, 0x0d, 0x02, 0x00, 0x00, 0xc0, 0x8a, 0x00, 0x02, 0x80,
+    0x60, 0xec, 0xe1, 0x00, 0x01, 0xb4, 0xb8, 0x89, 0x00, 0x03, 0x40, 0xb0, 0x6d, 0x1d, 0x86, 0x00,
+    0x05, 0x80, 0x00, 0x04, 0x12, 0x0d, 0x03, 0xe1, 0x00, 0x02, 0x06, 0x0d, 0x03, 0x86, 0x00, 0x00,
+    0x08, 0x82, 0x00, 0x00, 0x01, 0x88, 0x00, 0x01, 0x0d, 0x0c, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00,
+    0xde, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0,
+    0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0,
+    0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0xae, 0x00, 0x01, 0xae, 0x00, 0x01, 0xb8, 0xa0,
+    0x8b, 0x00, 0x04, 0x1c, 0x6c, 0xb0, 0x40, 0x80, 0x8a, 0x00, 0x02, 0x0c, 0x10, 0x2c, 0xde, 0x00,
+    0x03, 0x03, 0x0d, 0x36, 0x08, 0x8b, 0x00, 0x04, 0x01, 0x02, 0x00, 0x80, 0xb0, 0x88, 0x00, 0x04,
+    0x80, 0x40, 0xb0, 0x6c, 0x1f, 0xe0, 0x00, 0x02, 0xc0, 0xb4, 0x77, 0x88, 0x00, 0x04, 0x10, 0x48,
+    0x36, 0x0d, 0x03, 0x86, 0x00, 0x04, 0xe0, 0x80, 0x05, 0x02, 0x01, 0xe1, 0x00, 0x02, 0x01, 0x06,
+    0x01, 0x87, 0x00, 0x00, 0x06, 0x8c, 0x00, 0x03, 0x03, 0x0d, 0x06, 0x08, 0xff, 0x00, 0xff, 0x00,
+    0xff, 0x00, 0xdc, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00,
+    0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00,
+    0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0xae, 0x00, 0x01, 0xae, 0x00, 0x02,
+    0x74, 0xb0, 0xc0, 0x8b, 0x00, 0x03, 0x0c, 0x34, 0x48, 0xb0, 0x8c, 0x00, 0x02, 0x0c, 0x80, 0x40,
+    0xdd, 0x00, 0x05, 0x01, 0x06, 0x09, 0x02, 0x00, 0xc0, 0x8a, 0x00, 0x02, 0xc0, 0xb0, 0x7c, 0x87,
+    0x00, 0x05, 0x40, 0xb0, 0x48, 0x36, 0x0d, 0x03, 0xde, 0x00, 0x04, 0x40, 0x20, 0xd8, 0x36, 0x0e,
+    0x86, 0x00, 0x05, 0x80, 0x00, 0x16, 0x09, 0x06, 0x01, 0x87, 0x00, 0x02, 0x68, 0xb0, 0xc1, 0xe0,
+    0x00, 0x03, 0x08, 0x00, 0x00, 0x01, 0x89, 0x00, 0x02, 0x0f, 0x06, 0x08, 0x8b, 0x00, 0x04, 0x01,
+    0x06, 0x09, 0x06, 0x08, 0xff, 0x00, 0xff, 0x00, 0xff, 0x00, 0xda, 0x00, 0x00, 0xe0, 0x82, 0x00,
+    0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00,
+    0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00,
+    0x00, 0xe0, 0xae, 0x00, 0x01, 0xae, 0x00, 0x04, 0x0c, 0x34, 0xd8, 0x20, 0xc0, 0x8a, 0x00, 0x03,
+    0x04, 0x08, 0x34, 0x08, 0x8b, 0x00, 0x02, 0xc0, 0xb0, 0x40, 0xdf, 0x00, 0x03, 0x01, 0x02, 0xc0,
+    0xf0, 0x88, 0x00, 0x04, 0xc0, 0x20, 0xd8, 0x36, 0x0d, 0x87, 0x00, 0x04, 0x58, 0x36, 0x09, 0x06,
+    0x01, 0xdf, 0x00, 0x04, 0x58, 0x24, 0x1b, 0x06, 0x01, 0x86, 0x00, 0x03, 0xa0, 0xc1, 0x06, 0x01,
+    0x89, 0x00, 0x04, 0x08, 0x36, 0xd8, 0x20, 0xc0, 0xde, 0x00, 0x01, 0x0e, 0x08, 0x8b, 0x00, 0x04,
+    0x01, 0x06, 0x0b, 0x04, 0x08, 0x8b, 0x00, 0x02, 0x01, 0x06, 0x0b, 0xff, 0x00, 0xff, 0x00, 0xff,
+    0x00, 0xda, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00,
+    0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00,
+    0xe0, 0x82, 0x00, 0x00, 0xe0, 0x82, 0x00, 0x00, 0xe0, 0xae, 0x00,
+};
+
+static const anim_t splash_anim = {
+    .data = splash_anim_data,
+    .frame_count = 8,
+    .frame_ms = 100,
+    .width = 128,
+    .pages = 8,
+};
+
+#endif
@@ -0,0 +1,68 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifndef spsc_queue_inc_h
+#define spsc_queue_inc_h
+
+// Fila circular sem travas para exatamente um produtor e um consumidor (p. ex. core1 -> core0).
+// Só depende de C11 (<stdatomic.h>), então compila igual no RP2040 e no Linux.
+//
+// SPSC_QUEUE_DEFINE(nome, tipo, capacidade) gera o tipo nome_t e as funções
+// nome_init(), nome_push(), nome_pop(), nome_front() e nome_count(). A capacidade deve ser
+// potência de 2.
+//
+// Os índices correm livres (só o produtor escreve head, só o consumidor escreve tail);
+// a ordem acquire/release garante que o item está completo antes de ficar visível.
+#define SPSC_QUEUE_DEFINE(name, type, capacity)                                         \
+    _Static_assert(((capacity) & ((capacity) - 1)) == 0, "capacidade deve ser potencia de 2"); \
+                                                                                        \
+    typedef struct {                                                                    \
+        _Atomic uint32_t head;                                                          \
+        _Atomic uint32_t tail;                                                          \
+        type items[capacity];                                                           \
+    } name##_t;                                                                         \
+                                                                                        \
+    static inline void name##_init(name##_t *q) {                                       \
+        atomic_store_explicit(&q->head, 0, memory_order_relaxed);                       \
+        atomic_store_explicit(&q->tail, 0, memory_order_relaxed);                       \
+    }                                                                                   \
+                                                                                        \
+    /* Produtor: retorna false (e descarta o item) se a fila estiver cheia */           \
+    static inline bool name##_push(name##_t *q, const type *item) {                     \
+        uint32_t head = atomic_load_explicit(&q->head, memory_order_relaxed);           \
+        uint32_t tail = atomic_load_explicit(&q->tail, memory_order_acquire);           \
+        if (head - tail == (capacity)) {                                                \
+            return false;                                                               \
+        }                                                                               \
+        q->items[head & ((capacity) - 1)] = *item;                                      \
+        atomic_store_explicit(&q->head, head + 1, memory_order_release);                \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    /* Consumidor: retorna false se a fila estiver vazia */                             \
+    static inline bool name##_pop(name##_t *q, type *item) {                            \
+        uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);           \
+        uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);           \
+        if (head == tail) {                                                             \
+            return false;                                                               \
+        }                                                                               \
+        *item = q->items[tail & ((capacity) - 1)];                                      \
+        atomic_store_explicit(&q->tail, tail + 1, memory_order_release);                \
+        return true;                                                                    \
+    }                                                                                   \
+                                                                                        \
+    /* Consumidor: item mais antigo, sem retirá-lo (NULL se a fila estiver vazia) */    \
+    static inline const type *name##_front(name##_t *q) {                               \
+        uint32_t tail = atomic_load_explicit(&q->tail, memory_order_relaxed);           \
+        uint32_t head = atomic_load_explicit(&q->head, memory_order_acquire);           \
+        return head == tail ? NULL : &q->items[tail & ((capacity) - 1)];                \
+    }                                                                                   \
+                                                                                        \
+    /* Itens na fila (aproximado se chamado enquanto o outro lado opera) */             \
+    static inline uint32_t name##_count(name##_t *q) {                                  \
+        return atomic_load_explicit(&q->head, memory_order_acquire) -                   \
+               atomic_load_explicit(&q->tail, memory_order_acquire);                    \
+    }
+
+#endif
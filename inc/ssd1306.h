@@ -9,9 +9,20 @@ extern void render_on_display(uint8_t *ssd, struct render_area *area);
 extern void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set);
 extern void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool set);
 extern void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character);
-extern void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string);
+extern void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, const char *string);
+extern void ssd1306_draw_string_scaled(uint8_t *ssd, int16_t x, int16_t y, const char *string, uint scale);
+extern int ssd1306_string_width(const char *string, uint scale);
+extern void ssd1306_text_layout(ssd1306_text_t *text, const char *string);
+extern void ssd1306_draw_text(uint8_t *ssd, int16_t x, int16_t y, const ssd1306_text_t *text);
 extern void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 extern void ssd1306_config(ssd1306_t *ssd);
-extern void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
+extern void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, uint i2c);
 extern void ssd1306_send_data(ssd1306_t *ssd);
-extern void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap);
\ No newline at end of file
+extern void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap);
+extern void ssd1306_draw_image(uint8_t *ssd, int16_t x, uint8_t page, uint8_t width, uint8_t pages, const uint8_t *image);
+extern void ssd1306_clear(uint8_t *ssd);
+extern void ssd1306_invalidate();
+extern bool ssd1306_flush(uint8_t *ssd);
+extern bool ssd1306_flush_busy();
+extern void ssd1306_flush_wait();
+extern void ssd1306_set_flush_callback(void (*callback)(void));
@@ -1,12 +1,57 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <ctype.h>
-#include "pico/stdlib.h"
-#include "pico/binary_info.h"
-#include "hardware/i2c.h"
+#include "hal.h"
 #include "ssd1306_font.h"
 #include "ssd1306_i2c.h"
+#include "trace.h"
+
+// Região alterada de cada página desde o último envio (dirty_x0 > dirty_x1 quando limpa).
+// O controle considera um único framebuffer, o que é passado a ssd1306_flush().
+static uint8_t dirty_x0[ssd1306_n_pages];
+static uint8_t dirty_x1[ssd1306_n_pages];
+
+// Cópia do que está de fato no display, para descartar regiões redesenhadas iguais
+static uint8_t shadow[ssd1306_buffer_length];
+static bool shadow_valid = false;
+
+// Sequência pronta para o registrador IC_DATA_CMD: cada byte vira uma palavra de 16 bits
+// (o DMA não pode escrever bytes ali, pois a escrita estreita é replicada nos bits de
+// STOP/RESTART). Contém a transação de comandos (0x00 + comandos) seguida da transação de
+// dados, com o byte de controle 0x40 reservado no início; é persistente, sem malloc.
+#define ssd1306_max_commands 8
+static uint16_t wire[1 + ssd1306_max_commands + 1 + ssd1306_buffer_length];
+static int wire_length;
+
+// Envio assíncrono (DMA no ritmo da DREQ de transmissão do I2C)
+static volatile bool flush_busy = false;
+static uint32_t flush_errors;
+static void (*flush_callback)(void);
+
+void ssd1306_flush_wait();
+
+// Lista de comandos em uma única transação (byte de controle 0x00 seguido dos comandos)
+static uint8_t command_buffer[32];
+
+// Marca as colunas x_0..x_1 das páginas page_0..page_1 como alteradas
+static inline void ssd1306_mark_dirty(int x_0, int x_1, int page_0, int page_1) {
+    for (int page = page_0; page <= page_1; page++) {
+        if (x_0 < dirty_x0[page]) dirty_x0[page] = x_0;
+        if (x_1 > dirty_x1[page]) dirty_x1[page] = x_1;
+    }
+}
+
+// Apaga o framebuffer inteiro (substitui o memset, para que a limpeza também conte como alteração)
+void ssd1306_clear(uint8_t *ssd) {
+    memset(ssd, 0, ssd1306_buffer_length);
+    ssd1306_mark_dirty(0, ssd1306_width - 1, 0, ssd1306_n_pages - 1);
+}
+
+// Esquece o conteúdo do display, forçando o próximo ssd1306_flush() a enviar tudo
+void ssd1306_invalidate() {
+    shadow_valid = false;
+    ssd1306_mark_dirty(0, ssd1306_width - 1, 0, ssd1306_n_pages - 1);
+}
 
 // Calcular quanto do buffer será destinado à área de renderização
 void calculate_render_area_buffer_length(struct render_area *area) {
@@ -16,26 +61,95 @@ void calculate_render_area_buffer_length(struct render_area *area) {
 // Processo de escrita do i2c espera um byte de controle, seguido por dados
 void ssd1306_send_command(uint8_t command) {
     uint8_t buffer[2] = {0x80, command};
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, buffer, 2, false);
+    ssd1306_flush_wait();
+    hal_i2c_write(ssd1306_i2c_bus, ssd1306_i2c_address, buffer, 2);
 }
 
-// Envia uma lista de comandos ao hardware
+// Espera terminar o envio assíncrono em andamento, se houver
+void ssd1306_flush_wait() {
+    while (flush_busy) {
+        hal_wait_for_event();
+    }
+}
+
+// Indica se ainda há um envio assíncrono em andamento
+bool ssd1306_flush_busy() {
+    return flush_busy;
+}
+
+// Define uma função chamada (em contexto de interrupção) ao fim de cada envio assíncrono
+void ssd1306_set_flush_callback(void (*callback)(void)) {
+    flush_callback = callback;
+}
+
+// Envia uma lista de comandos ao hardware, numa única transação por bloco de até 31 comandos
 void ssd1306_send_command_list(uint8_t *ssd, int number) {
+    ssd1306_flush_wait();
+
+    command_buffer[0] = 0x00; // Co = 0, D/C# = 0: todos os bytes seguintes são comandos
+    while (number > 0) {
+        int n = number < (int)sizeof(command_buffer) - 1 ? number : (int)sizeof(command_buffer) - 1;
+
+        memcpy(command_buffer + 1, ssd, n);
+        hal_i2c_write(ssd1306_i2c_bus, ssd1306_i2c_address, command_buffer, n + 1);
+        ssd += n;
+        number -= n;
+    }
+}
+
+// Começa a sequência com a transação de comandos
+static void wire_commands(const uint8_t *commands, int number) {
+    wire[0] = 0x00;
     for (int i = 0; i < number; i++) {
-        ssd1306_send_command(ssd[i]);
+        wire[1 + i] = commands[i];
     }
+    wire[number] |= HAL_I2C_STOP;
+    wire_length = number + 1;
 }
 
-// Copia buffer de referência num novo buffer, a fim de adicionar o byte de controle desde o início
-void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
-    uint8_t *temp_buffer = malloc(buffer_length + 1);
+// Acrescenta a transação de dados (0x40 + bytes), lendo linhas de largura 'width' a cada 'stride'
+static void wire_data(const uint8_t *data, int width, int stride, int rows) {
+    uint16_t *out = &wire[wire_length];
 
-    temp_buffer[0] = 0x40;
-    memcpy(temp_buffer + 1, ssd, buffer_length);
+    *out++ = 0x40;
+    for (int row = 0; row < rows; row++) {
+        const uint8_t *in = data + row * stride;
+        for (int i = 0; i < width; i++) {
+            *out++ = in[i];
+        }
+    }
+    out[-1] |= HAL_I2C_STOP;
+    wire_length = out - wire;
+}
 
-    i2c_write_blocking(i2c1, ssd1306_i2c_address, temp_buffer, buffer_length + 1, false);
+// Fim do envio (contexto de interrupção); se o display não respondeu, o conteúdo dele é desconhecido
+static void ssd1306_flush_done(bool ok) {
+    TRACE_INSTANT(TRACE_OLED_DONE, ok, 0);
+    if (!ok) {
+        flush_errors++;
+        ssd1306_invalidate();
+    }
 
-    free(temp_buffer);
+    flush_busy = false;
+    if (flush_callback) {
+        flush_callback();
+    }
+}
+
+// Dispara o envio assíncrono da sequência montada em wire
+static void wire_start() {
+    flush_busy = true;
+    hal_i2c_write_async(ssd1306_i2c_bus, ssd1306_i2c_address, wire, wire_length, ssd1306_flush_done);
+}
+
+// Envia o buffer com o byte de controle de dados à frente, sem cópia para buffer temporário
+void ssd1306_send_buffer(uint8_t ssd[], int buffer_length) {
+    ssd1306_flush_wait();
+
+    wire_length = 0;
+    wire_data(ssd, buffer_length, buffer_length, 1);
+    wire_start();
+    ssd1306_flush_wait();
 }
 
 // Cria a lista de comandos (com base nos endereços definidos em ssd1306_i2c.h) para a inicialização do display
@@ -62,6 +176,9 @@ void ssd1306_init() {
     };
 
     ssd1306_send_command_list(commands, count_of(commands));
+
+    // Conteúdo da memória do display é desconhecido após a inicialização
+    ssd1306_invalidate();
 }
 
 // Cria a lista de comandos para configurar o scrolling
@@ -102,6 +219,7 @@ void ssd1306_set_pixel(uint8_t *ssd, int x, int y, bool set) {
     }
 
     ssd[byte_idx] = byte;
+    ssd1306_mark_dirty(x, x, y / 8, y / 8);
 }
 
 // Algoritmo de Bresenham básico
@@ -132,53 +250,167 @@ void ssd1306_draw_line(uint8_t *ssd, int x_0, int y_0, int x_1, int y_1, bool se
     }
 }
 
-// Adquire os pixels para um caractere (de acordo com ssd1306_font.h)
-inline int ssd1306_get_font(uint8_t character)
-{
-  if (character >= 'A' && character <= 'Z') {
-    return character - 'A' + 1;
-  }
-  else if (character >= '0' && character <= '9') {
-    return character - '0' + 27;
-  }
-  else
-    return 0;
+// Texto. O framebuffer é organizado em páginas (cada byte é uma coluna de 8 pixels), então um
+// glifo em y múltiplo de 8 é uma cópia direta das colunas da fonte; em qualquer outro y, cada
+// coluna é deslocada e mesclada nas duas (ou, ampliada, até quatro) páginas que cobre.
+// A célula inteira (glifo, coluna e linha de espaço) é desenhada, apagando o que havia embaixo.
+
+// Glifo do caractere na fonte (fora da tabela ASCII imprimível, o espaço)
+static inline const uint8_t *ssd1306_glyph(uint8_t character) {
+    if (character < ssd1306_font_first || character > ssd1306_font_last) {
+        character = ' ';
+    }
+    return font + (character - ssd1306_font_first) * ssd1306_font_width;
 }
 
-// Desenha um único caractere no display
-void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
+// Amplia uma coluna do glifo: cada bit vira 'scale' bits seguidos
+static inline uint32_t ssd1306_scale_column(uint8_t column, uint scale) {
+    uint32_t run = (1u << scale) - 1;
+    uint32_t out = 0;
+
+    for (uint bit = 0; column; bit++, column >>= 1) {
+        if (column & 1) {
+            out |= run << (bit * scale);
+        }
+    }
+    return out;
+}
+
+// Substitui os bits de 'mask' numa coluna a partir de y (bit 0 em cima, até 25 pixels)
+static inline void ssd1306_blit_column(uint8_t *ssd, int x, int y, uint32_t bits, uint32_t mask) {
+    if (x < 0 || x >= ssd1306_width || y >= ssd1306_height || y <= -32) {
         return;
     }
+    if (y < 0) {
+        bits >>= -y;
+        mask >>= -y;
+        y = 0;
+    }
 
-    y = y / 8;
+    uint page = y / 8;
+    uint8_t *column = ssd + page * ssd1306_width + x;
 
-    character = toupper(character);
-    int idx = ssd1306_get_font(character);
-    int fb_idx = y * 128 + x;
+    bits <<= y % 8;
+    mask <<= y % 8;
+    for (; mask && page < ssd1306_n_pages; page++, column += ssd1306_width, bits >>= 8, mask >>= 8) {
+        *column = (*column & ~mask) | (bits & mask);
+    }
+}
 
-    for (int i = 0; i < 8; i++) {
-        ssd[fb_idx++] = font[idx * 8 + i];
+// Desenha a célula de um glifo sem marcar a área alterada (quem chama marca o texto todo)
+static inline void ssd1306_put_glyph(uint8_t *ssd, int x, int y, const uint8_t *glyph, uint scale) {
+    // Caso comum: escala 1, alinhado à página e inteiro na tela
+    if (scale == 1 && y >= 0 && y < ssd1306_height && y % 8 == 0 && x >= 0 && x <= ssd1306_width - ssd1306_font_advance) {
+        uint8_t *column = ssd + (y / 8) * ssd1306_width + x;
+        memcpy(column, glyph, ssd1306_font_width);
+        column[ssd1306_font_width] = 0;
+        return;
+    }
+
+    uint32_t mask = (1u << (ssd1306_font_height * scale)) - 1;
+    for (uint i = 0; i < ssd1306_font_advance; i++) {
+        uint32_t bits = 0;
+        if (i < ssd1306_font_width) {
+            bits = scale == 1 ? glyph[i] : ssd1306_scale_column(glyph[i], scale);
+        }
+        for (uint repeat = 0; repeat < scale; repeat++) {
+            ssd1306_blit_column(ssd, x++, y, bits, mask);
+        }
+    }
+}
+
+// Marca como alterada a parte visível de um texto de 'width' pixels
+static void ssd1306_mark_text(int x, int y, int width, uint scale) {
+    int x_1 = x + width - 1;
+    int y_1 = y + ssd1306_font_height * scale - 1;
+
+    if (x < 0) x = 0;
+    if (y < 0) y = 0;
+    if (x_1 > ssd1306_width - 1) x_1 = ssd1306_width - 1;
+    if (y_1 > ssd1306_height - 1) y_1 = ssd1306_height - 1;
+    if (x <= x_1 && y <= y_1) {
+        ssd1306_mark_dirty(x, x_1, y / 8, y_1 / 8);
     }
 }
 
-// Desenha uma string, chamando a função de desenhar caractere várias vezes
-void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, char *string) {
-    if (x > ssd1306_width - 8 || y > ssd1306_height - 8) {
+// Desenha um único caractere no display, em qualquer posição
+void ssd1306_draw_char(uint8_t *ssd, int16_t x, int16_t y, uint8_t character) {
+    ssd1306_put_glyph(ssd, x, y, ssd1306_glyph(character), 1);
+    ssd1306_mark_text(x, y, ssd1306_font_advance, 1);
+}
+
+/**
+ * Desenha uma string ampliada 'scale' vezes (1 a ssd1306_font_max_scale), com o canto superior
+ * esquerdo em (x, y); o que passa da tela é cortado.
+ */
+void ssd1306_draw_string_scaled(uint8_t *ssd, int16_t x, int16_t y, const char *string, uint scale) {
+    int advance = ssd1306_font_advance * scale;
+    int x_0 = x;
+
+    assert(scale >= 1 && scale <= ssd1306_font_max_scale);
+    if (y >= ssd1306_height || y <= -(int)(ssd1306_font_height * scale)) {
         return;
     }
 
-    while (*string) {
-        ssd1306_draw_char(ssd, x, y, *string++);
-        x += 8;
+    for (; *string && x < ssd1306_width; string++, x += advance) {
+        if (x > -advance) {
+            ssd1306_put_glyph(ssd, x, y, ssd1306_glyph(*string), scale);
+        }
+    }
+    ssd1306_mark_text(x_0, y, x - x_0, scale);
+}
+
+// Desenha uma string no tamanho normal
+void ssd1306_draw_string(uint8_t *ssd, int16_t x, int16_t y, const char *string) {
+    ssd1306_draw_string_scaled(ssd, x, y, string, 1);
+}
+
+// Largura em pixels de uma string na escala pedida (para centralizar)
+int ssd1306_string_width(const char *string, uint scale) {
+    return strlen(string) * ssd1306_font_advance * scale;
+}
+
+/**
+ * Calcula uma vez o layout de um rótulo fixo (cortado em ssd1306_text_max caracteres), para
+ * que redesenhá-lo a cada quadro seja só copiar colunas.
+ */
+void ssd1306_text_layout(ssd1306_text_t *text, const char *string) {
+    text->length = 0;
+    while (*string && text->length < ssd1306_text_max) {
+        text->glyphs[text->length++] = ssd1306_glyph(*string++);
+    }
+    text->width = text->length * ssd1306_font_advance;
+}
+
+// Desenha um rótulo com o layout já calculado
+void ssd1306_draw_text(uint8_t *ssd, int16_t x, int16_t y, const ssd1306_text_t *text) {
+    for (uint i = 0; i < text->length; i++) {
+        ssd1306_put_glyph(ssd, x + i * ssd1306_font_advance, y, text->glyphs[i], 1);
+    }
+    ssd1306_mark_text(x, y, text->width, 1);
+}
+
+/**
+ * Copia uma imagem no formato de páginas (width x pages, p. ex. um quadro de animação) para o
+ * framebuffer a partir da coluna x e da página 'page'. A imagem pode ser o próprio framebuffer,
+ * quando o quadro foi decodificado no lugar; nesse caso só a área é marcada como alterada.
+ */
+void ssd1306_draw_image(uint8_t *ssd, int16_t x, uint8_t page, uint8_t width, uint8_t pages, const uint8_t *image) {
+    assert(x >= 0 && x + width <= ssd1306_width && page + pages <= ssd1306_n_pages);
+
+    if (image != ssd) {
+        for (uint i = 0; i < pages; i++) {
+            memcpy(ssd + (page + i) * ssd1306_width + x, image + i * width, width);
+        }
     }
+    ssd1306_mark_dirty(x, x + width - 1, page, page + pages - 1);
 }
 
 // Comando de configuração com base na estrutura ssd1306_t
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
-	ssd->i2c_port, ssd->address, ssd->port_buffer, 2, false );
+  hal_i2c_write(
+	ssd->i2c_port, ssd->address, ssd->port_buffer, 2);
 }
 
 // Função de configuração do display para o caso do bitmap
@@ -211,11 +443,12 @@ void ssd1306_config(ssd1306_t *ssd) {
 }
 
 // Inicializa o display para o caso de exibição de bitmap
-void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
+void ssd1306_init_bm(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, uint i2c) {
     ssd->width = width;
     ssd->height = height;
     ssd->pages = height / 8U;
     ssd->address = address;
+    ssd->external_vcc = external_vcc;
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
     ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
@@ -231,15 +464,78 @@ void ssd1306_send_data(ssd1306_t *ssd) {
     ssd1306_command(ssd, ssd1306_set_page_address);
     ssd1306_command(ssd, 0);
     ssd1306_command(ssd, ssd->pages - 1);
-    i2c_write_blocking(
-    ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize, false );
+    hal_i2c_write(
+    ssd->i2c_port, ssd->address, ssd->ram_buffer, ssd->bufsize);
 }
 
-// Desenha o bitmap (a ser fornecido em display_oled.c) no display
+// Desenha o bitmap (no formato de páginas, a tela inteira) no display, com um só envio
 void ssd1306_draw_bitmap(ssd1306_t *ssd, const uint8_t *bitmap) {
-    for (int i = 0; i < ssd->bufsize - 1; i++) {
-        ssd->ram_buffer[i + 1] = bitmap[i];
+    memcpy(ssd->ram_buffer + 1, bitmap, ssd->bufsize - 1);
+    ssd1306_send_data(ssd);
+}
+
+// Começa a enviar, sem bloquear, só o retângulo que mudou desde o último envio.
+// Retorna false se nada mudou ou se o envio anterior ainda não acabou (as alterações
+// continuam marcadas e saem no próximo ssd1306_flush()).
+bool ssd1306_flush(uint8_t *ssd) {
+    if (flush_busy) {
+        return false;
+    }
+    TRACE_BEGIN(TRACE_OLED_FLUSH, 0);
+
+    int x_0 = ssd1306_width, x_1 = -1;
+    int page_0 = ssd1306_n_pages, page_1 = -1;
+
+    for (int page = 0; page < (int)ssd1306_n_pages; page++) {
+        int a = dirty_x0[page], b = dirty_x1[page];
+        const uint8_t *row = ssd + page * ssd1306_width;
+        const uint8_t *old = shadow + page * ssd1306_width;
+
+        dirty_x0[page] = ssd1306_width - 1;
+        dirty_x1[page] = 0;
+        if (a > b) {
+            continue;
+        }
+
+        // Descarta as colunas redesenhadas com o mesmo conteúdo
+        if (shadow_valid) {
+            while (a <= b && row[a] == old[a]) a++;
+            while (b >= a && row[b] == old[b]) b--;
+            if (a > b) {
+                continue;
+            }
+        }
 
-        ssd1306_send_data(ssd);
+        if (a < x_0) x_0 = a;
+        if (b > x_1) x_1 = b;
+        if (page < page_0) page_0 = page;
+        page_1 = page;
     }
-}
\ No newline at end of file
+
+    if (page_1 < 0) {
+        TRACE_END(TRACE_OLED_FLUSH, 0);
+        return false;
+    }
+
+    uint8_t commands[] = {
+        ssd1306_set_column_address, x_0, x_1,
+        ssd1306_set_page_address, page_0, page_1
+    };
+
+    // Comandos e retângulo numa só sequência de DMA, empacotados direto do framebuffer
+    int width = x_1 - x_0 + 1;
+    wire_commands(commands, count_of(commands));
+    wire_data(ssd + page_0 * ssd1306_width + x_0, width, ssd1306_width, page_1 - page_0 + 1);
+    wire_start();
+
+    for (int page = page_0; page <= page_1; page++) {
+        memcpy(shadow + page * ssd1306_width + x_0, ssd + page * ssd1306_width + x_0, width);
+    }
+    // O display só fica inteiramente conhecido depois de um envio da tela toda
+    if (x_0 == 0 && x_1 == ssd1306_width - 1 && page_0 == 0 && page_1 == ssd1306_n_pages - 1) {
+        shadow_valid = true;
+    }
+
+    TRACE_END(TRACE_OLED_FLUSH, wire_length);
+    return true;
+}
@@ -1,6 +1,5 @@
 #include <stdlib.h>
-#include "pico/stdlib.h"
-#include "hardware/i2c.h"
+#include "hal.h"
 
 #ifndef ssd1306_inc_h
 #define ssd1306_inc_h
@@ -9,6 +8,7 @@
 #define ssd1306_width 128 // Define a largura do display (128 pixels)
 
 #define ssd1306_i2c_address _u(0x3C) // Define o endereço do i2c do display
+#define ssd1306_i2c_bus 1 // Barramento do display (i2c1)
 
 #define ssd1306_i2c_clock 400 // Define o tempo do clock (pode ser aumentado)
 
@@ -44,6 +44,15 @@
 #define ssd1306_n_pages (ssd1306_height / ssd1306_page_height)
 #define ssd1306_buffer_length (ssd1306_n_pages * ssd1306_width)
 
+// Texto: fonte 5x7 (ssd1306_font.h) em células de 6x8, ampliável 2x ou 3x
+#define ssd1306_font_first ' '
+#define ssd1306_font_last '~'
+#define ssd1306_font_width 5
+#define ssd1306_font_advance 6 // Largura da célula (glifo + uma coluna de espaço)
+#define ssd1306_font_height 8 // Altura da célula (glifo + uma linha de espaço)
+#define ssd1306_font_max_scale 3
+#define ssd1306_text_max (ssd1306_width / ssd1306_font_advance) // Caracteres que cabem numa linha
+
 #define ssd1306_write_mode _u(0xFE)
 #define ssd1306_read_mode _u(0xFF)
 
@@ -56,9 +65,16 @@ struct render_area {
     int buffer_length;
 };
 
+// Rótulo com o layout calculado uma vez (ssd1306_text_layout): glifos já localizados na fonte
+typedef struct {
+    const uint8_t *glyphs[ssd1306_text_max];
+    uint8_t length;
+    uint8_t width; // Em pixels, na escala 1
+} ssd1306_text_t;
+
 typedef struct {
   uint8_t width, height, pages, address;
-  i2c_inst_t * i2c_port;
+  uint i2c_port; // Número do barramento
   bool external_vcc;
   uint8_t *ram_buffer;
   size_t bufsize;
@@ -0,0 +1,131 @@
+#include "hal.h"
+#include "tone.h"
+
+// Melodia em execução; avançada pelo callback do alarme, sem bloquear quem chamou
+static const tone_melody_t *tone_melody;
+static volatile uint8_t tone_index;
+static volatile bool tone_playing = false;
+static uint tone_gpio;
+static hal_alarm_id_t tone_alarm;
+static void (*tone_done_callback)(void);
+
+/**
+ * Converte as notas em divisor/wrap do PWM a partir do clock real do sistema (uma vez por tabela).
+ * O divisor (em 1/16) é o menor que mantém o wrap em 16 bits; o ciclo de trabalho é 50%.
+ */
+void tone_melody_prepare(tone_melody_t *melody, const tone_note_t *notes, uint count) {
+    uint64_t sys_hz16 = (uint64_t)hal_sys_clock_hz() * 16;
+
+    if (count > TONE_MAX_NOTES) {
+        count = TONE_MAX_NOTES;
+    }
+    melody->count = count;
+
+    for (uint i = 0; i < count; i++) {
+        tone_step_t *step = &melody->steps[i];
+        uint32_t freq = notes[i].freq_hz;
+
+        step->duration_ms = notes[i].duration_ms;
+        if (freq == 0) {
+            step->wrap = 0;
+            step->level = 0;
+            step->div_int = 1;
+            step->div_frac = 0;
+            continue;
+        }
+
+        uint64_t div16 = (sys_hz16 + freq * 65536ull - 1) / (freq * 65536ull);
+        if (div16 < 16) div16 = 16;
+        if (div16 > 255 * 16 + 15) div16 = 255 * 16 + 15;
+
+        uint64_t top = (sys_hz16 + div16 * freq / 2) / (div16 * freq);
+        if (top > 65536) top = 65536;
+
+        step->div_int = div16 / 16;
+        step->div_frac = div16 % 16;
+        step->wrap = top - 1;
+        step->level = top / 2;
+    }
+}
+
+// Programa o PWM para a nota atual
+static void tone_apply(const tone_step_t *step) {
+    hal_pwm_start(tone_gpio, step->div_int, step->div_frac, step->wrap, step->level);
+}
+
+// Encerra a melodia e desliga o PWM
+static void tone_finish(void) {
+    hal_pwm_stop(tone_gpio);
+    tone_playing = false;
+    tone_alarm = 0;
+
+    if (tone_done_callback) {
+        tone_done_callback();
+    }
+}
+
+// Fim de uma nota: passa para a próxima e reagenda o alarme relativo ao disparo anterior
+static int64_t tone_alarm_callback(hal_alarm_id_t id, void *user_data) {
+    (void)id;
+    (void)user_data;
+    uint8_t next = tone_index + 1;
+
+    if (!tone_playing || next >= tone_melody->count) {
+        tone_finish();
+        return 0;
+    }
+
+    tone_index = next;
+    tone_apply(&tone_melody->steps[next]);
+    return (int64_t)tone_melody->steps[next].duration_ms * 1000;
+}
+
+/**
+ * Começa a tocar a melodia no pino do buzzer e retorna imediatamente.
+ * Uma melodia em execução é interrompida.
+ */
+bool tone_play(uint gpio, const tone_melody_t *melody) {
+    if (melody->count == 0) {
+        return false;
+    }
+
+    tone_stop();
+
+    tone_melody = melody;
+    tone_index = 0;
+    tone_gpio = gpio;
+
+    tone_apply(&melody->steps[0]);
+    tone_playing = true;
+
+    tone_alarm = hal_alarm_in_us((uint64_t)melody->steps[0].duration_ms * 1000, tone_alarm_callback, NULL);
+    return tone_alarm >= 0;
+}
+
+/**
+ * Interrompe a melodia, se houver uma tocando.
+ */
+void tone_stop(void) {
+    if (!tone_playing) {
+        return;
+    }
+
+    if (tone_alarm > 0) {
+        hal_alarm_cancel(tone_alarm);
+    }
+    tone_finish();
+}
+
+/**
+ * Indica se ainda há uma melodia tocando.
+ */
+bool tone_is_playing(void) {
+    return tone_playing;
+}
+
+/**
+ * Define uma função chamada (em contexto de interrupção) quando a melodia termina.
+ */
+void tone_set_done_callback(void (*callback)(void)) {
+    tone_done_callback = callback;
+}
@@ -0,0 +1,34 @@
+#include "hal.h"
+
+#ifndef tone_inc_h
+#define tone_inc_h
+
+#define TONE_MAX_NOTES 16 // Notas por melodia
+
+// Nota da melodia (freq_hz = 0 é pausa)
+typedef struct {
+    uint16_t freq_hz;
+    uint16_t duration_ms;
+} tone_note_t;
+
+// Nota já convertida em registradores do PWM
+typedef struct {
+    uint16_t wrap;
+    uint16_t level; // 0 em pausas
+    uint8_t div_int;
+    uint8_t div_frac;
+    uint16_t duration_ms;
+} tone_step_t;
+
+typedef struct {
+    uint8_t count;
+    tone_step_t steps[TONE_MAX_NOTES];
+} tone_melody_t;
+
+void tone_melody_prepare(tone_melody_t *melody, const tone_note_t *notes, uint count);
+bool tone_play(uint gpio, const tone_melody_t *melody);
+void tone_stop(void);
+bool tone_is_playing(void);
+void tone_set_done_callback(void (*callback)(void));
+
+#endif
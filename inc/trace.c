@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdatomic.h>
+#include "trace.h"
+
+// Um anel por core: os produtores de um core (laço e interrupções) se excluem desligando as
+// interrupções, e o único consumidor é trace_drain() no core0, então nada é disputado entre
+// os cores. Anel cheio descarta o registro novo (o consumidor pode estar lendo o antigo).
+typedef struct {
+    trace_record_t records[TRACE_CAPACITY];
+    _Atomic uint32_t head; // Escrito pelo core dono do anel
+    _Atomic uint32_t tail; // Escrito por trace_drain()
+    uint32_t dropped;
+} trace_ring_t;
+
+static trace_ring_t trace_rings[2];
+
+/**
+ * Acrescenta um registro ao anel do core atual; seguro em interrupções. Use as macros TRACE_*.
+ */
+void trace_record(uint8_t id, uint8_t phase, uint16_t arg, uint32_t value) {
+    uint core = hal_core_num();
+    trace_ring_t *ring = &trace_rings[core];
+    uint32_t irq = hal_irq_save();
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+    if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) < TRACE_CAPACITY) {
+        trace_record_t *r = &ring->records[head % TRACE_CAPACITY];
+        r->timestamp_us = hal_time_us();
+        r->id = id;
+        r->phase = phase | (core ? TRACE_PH_CORE1 : 0);
+        r->arg = arg;
+        r->value = value;
+        atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    }
+    else {
+        ring->dropped++;
+    }
+
+    hal_irq_restore(irq);
+}
+
+// Escreve até TRACE_DRAIN_BATCH registros de um anel numa linha "#T" seguida de hexadecimal
+static uint trace_drain_ring(trace_ring_t *ring, uint max_records) {
+    static const char hex[] = "0123456789abcdef";
+    char line[3 + TRACE_DRAIN_BATCH * sizeof(trace_record_t) * 2 + 2];
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t available = atomic_load_explicit(&ring->head, memory_order_acquire) - tail;
+    uint n = available < max_records ? available : max_records;
+    char *out = line;
+
+    if (n > TRACE_DRAIN_BATCH) {
+        n = TRACE_DRAIN_BATCH;
+    }
+    if (n == 0) {
+        return 0;
+    }
+
+    *out++ = '#';
+    *out++ = 'T';
+    for (uint i = 0; i < n; i++) {
+        const trace_record_t *r = &ring->records[(tail + i) % TRACE_CAPACITY];
+        uint8_t bytes[sizeof(trace_record_t)] = {
+            r->timestamp_us, r->timestamp_us >> 8, r->timestamp_us >> 16, r->timestamp_us >> 24,
+            r->id, r->phase, r->arg, r->arg >> 8,
+            r->value, r->value >> 8, r->value >> 16, r->value >> 24,
+        };
+        for (uint j = 0; j < sizeof(bytes); j++) {
+            *out++ = hex[bytes[j] >> 4];
+            *out++ = hex[bytes[j] & 0xF];
+        }
+    }
+    atomic_store_explicit(&ring->tail, tail + n, memory_order_release);
+
+    *out++ = '\n';
+    fwrite(line, 1, out - line, stdout);
+    return n;
+}
+
+/**
+ * Envia pela stdio até max_records registros pendentes dos dois cores; retorna quantos enviou.
+ * Chamada no core0 fora do caminho quente (p. ex. antes de dormir).
+ */
+uint trace_drain(uint max_records) {
+    uint sent = 0;
+
+    for (uint core = 0; core < 2 && sent < max_records; core++) {
+        uint n;
+        while (sent < max_records && (n = trace_drain_ring(&trace_rings[core], max_records - sent)) > 0) {
+            sent += n;
+        }
+    }
+    return sent;
+}
+
+/**
+ * Registros descartados por anel cheio, nos dois cores.
+ */
+uint32_t trace_dropped(void) {
+    return trace_rings[0].dropped + trace_rings[1].dropped;
+}
@@ -0,0 +1,61 @@
+#include "hal.h"
+
+#ifndef trace_inc_h
+#define trace_inc_h
+
+#ifndef TRACE_ENABLED
+#define TRACE_ENABLED 1 // 0 remove todos os pontos de rastreio
+#endif
+
+#define TRACE_CAPACITY 256 // Registros por core (potência de 2)
+#define TRACE_DRAIN_BATCH 8 // Registros por linha de saída
+
+// Pontos de rastreio (manter em sincronia com tools/trace_decode.py)
+typedef enum {
+    TRACE_ADC_BLOCK = 1, // Bloco do ADC completo (arg = metade, value = número do bloco)
+    TRACE_AUDIO_BLOCK, // Processamento de um bloco de áudio
+    TRACE_RMS, // Janela de RMS (value = RMS em Q4)
+    TRACE_WHISTLE, // Detector de apito (value = detectado)
+    TRACE_DISPATCH, // Tratamento de um evento (arg = tipo do evento)
+    TRACE_LED_WRITE, // npWrite()
+    TRACE_LED_DONE, // Quadro aceito pelos LEDs
+    TRACE_OLED_FLUSH, // ssd1306_flush() (value = bytes enviados)
+    TRACE_OLED_DONE, // Fim do envio ao display (arg = 1 se o display respondeu)
+    TRACE_SOUND_LEVEL, // Nível usado pelos LEDs (value = RMS em Q4)
+    TRACE_INTENSITY, // Intensidade mostrada nos LEDs
+    TRACE_FFT, // FFT e barras do espectro de um bloco
+} trace_id_t;
+
+// Fase do registro
+#define TRACE_PH_BEGIN 0
+#define TRACE_PH_END 1
+#define TRACE_PH_INSTANT 2
+#define TRACE_PH_COUNTER 3
+#define TRACE_PH_CORE1 0x80 // Registro gerado no core1
+
+// Registro binário compacto (12 bytes, little-endian no fio)
+typedef struct {
+    uint32_t timestamp_us;
+    uint8_t id;
+    uint8_t phase;
+    uint16_t arg;
+    uint32_t value;
+} trace_record_t;
+
+void trace_record(uint8_t id, uint8_t phase, uint16_t arg, uint32_t value);
+uint trace_drain(uint max_records);
+uint32_t trace_dropped(void);
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(id, arg) trace_record((id), TRACE_PH_BEGIN, (arg), 0)
+#define TRACE_END(id, value) trace_record((id), TRACE_PH_END, 0, (value))
+#define TRACE_INSTANT(id, arg, value) trace_record((id), TRACE_PH_INSTANT, (arg), (value))
+#define TRACE_COUNTER(id, value) trace_record((id), TRACE_PH_COUNTER, 0, (value))
+#else
+#define TRACE_BEGIN(id, arg) ((void)0)
+#define TRACE_END(id, value) ((void)0)
+#define TRACE_INSTANT(id, arg, value) ((void)0)
+#define TRACE_COUNTER(id, value) ((void)0)
+#endif
+
+#endif
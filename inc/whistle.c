@@ -0,0 +1,116 @@
+#include <math.h>
+#include "whistle.h"
+
+static const uint16_t whistle_frequencies[WHISTLE_N_BINS] = WHISTLE_FREQUENCIES;
+
+// Calcula os coeficientes do banco uma única vez (o único uso de ponto flutuante)
+void whistle_init(whistle_detector_t *det, uint32_t sample_rate) {
+    for (int i = 0; i < WHISTLE_N_BINS; i++) {
+        float w = 2.f * (float)M_PI * whistle_frequencies[i] / sample_rate;
+        det->coeff[i] = (int32_t)lroundf(2.f * cosf(w) * 4096.f);
+    }
+
+    det->min_energy = WHISTLE_MIN_ENERGY;
+    whistle_reset(det);
+}
+
+// Esquece o histórico de persistência (p. ex. ao entrar no modo de monitoramento)
+void whistle_reset(whistle_detector_t *det) {
+    det->tonal_blocks = 0;
+    det->detected = false;
+    det->last_bin = -1;
+    det->last_ratio_q8 = 0;
+}
+
+// Troca a energia mínima para considerar um bloco (p. ex. acompanhando o piso de ruído);
+// nunca fica abaixo de WHISTLE_MIN_ENERGY
+void whistle_set_min_energy(whistle_detector_t *det, uint32_t min_energy) {
+    det->min_energy = min_energy > WHISTLE_MIN_ENERGY ? min_energy : WHISTLE_MIN_ENERGY;
+}
+
+// Roda o banco de Goertzel sobre um bloco e atualiza a decisão; retorna se há apito.
+// O bloco é dividido em segmentos de WHISTLE_SEGMENT amostras e a potência de cada filtro é
+// somada sobre os segmentos. Um bloco é tonal quando um filtro concentra ao menos
+// WHISTLE_TONAL_RATIO_Q8 da energia AC (para um seno puro no centro do filtro a razão é 1).
+// O apito é declarado depois de WHISTLE_ON_BLOCKS blocos tonais a mais que não tonais,
+// e esquecido quando o saldo zera.
+bool whistle_process(whistle_detector_t *det, const uint16_t *samples, uint32_t count) {
+    uint32_t segments = count / WHISTLE_SEGMENT;
+
+    if (segments == 0) {
+        return det->detected;
+    }
+    count = segments * WHISTLE_SEGMENT;
+
+    // Média do bloco, removida antes dos filtros
+    uint32_t sum = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    int32_t mean = sum / count;
+
+    // Energia AC do bloco na mesma escala dos filtros
+    uint32_t energy = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t x = ((int32_t)samples[i] - mean) >> WHISTLE_INPUT_SHIFT;
+        energy += x * x;
+    }
+
+    int best_bin = -1;
+    uint32_t best_ratio = 0;
+
+    if (energy >= det->min_energy * count) {
+        for (int b = 0; b < WHISTLE_N_BINS; b++) {
+            int32_t coeff = det->coeff[b];
+            uint64_t power = 0;
+
+            for (uint32_t seg = 0; seg < count; seg += WHISTLE_SEGMENT) {
+                int32_t s1 = 0, s2 = 0;
+
+                // s[n] = x[n] + 2cos(w)·s[n-1] - s[n-2]; com x em ±512 e coeff em Q12, cabe em 32 bits
+                for (uint32_t i = seg; i < seg + WHISTLE_SEGMENT; i++) {
+                    int32_t x = ((int32_t)samples[i] - mean) >> WHISTLE_INPUT_SHIFT;
+                    int32_t s0 = x + ((coeff * s1) >> 12) - s2;
+                    s2 = s1;
+                    s1 = s0;
+                }
+
+                // |X|² = s1² + s2² - 2cos(w)·s1·s2
+                int64_t p = (int64_t)s1 * s1 + (int64_t)s2 * s2 - (((int64_t)coeff * s1 * s2) >> 12);
+                if (p > 0) {
+                    power += p;
+                }
+            }
+
+            uint32_t ratio = (power << 9) / ((uint64_t)WHISTLE_SEGMENT * energy);
+            if (ratio > best_ratio) {
+                best_ratio = ratio;
+                best_bin = b;
+            }
+        }
+    }
+
+    det->last_ratio_q8 = best_ratio > UINT16_MAX ? UINT16_MAX : best_ratio;
+
+    if (best_ratio >= WHISTLE_TONAL_RATIO_Q8) {
+        det->last_bin = best_bin;
+        if (det->tonal_blocks < WHISTLE_MAX_BLOCKS) {
+            det->tonal_blocks++;
+        }
+    }
+    else {
+        det->last_bin = -1;
+        if (det->tonal_blocks > 0) {
+            det->tonal_blocks--;
+        }
+    }
+
+    if (det->tonal_blocks >= WHISTLE_ON_BLOCKS) {
+        det->detected = true;
+    }
+    else if (det->tonal_blocks == 0) {
+        det->detected = false;
+    }
+
+    return det->detected;
+}
@@ -0,0 +1,32 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef whistle_inc_h
+#define whistle_inc_h
+
+#define WHISTLE_N_BINS 13 // Filtros de Goertzel no banco
+#define WHISTLE_SEGMENT 64 // Amostras por segmento; a banda de cada filtro fica larga o bastante para cobrir o espaçamento
+#define WHISTLE_INPUT_SHIFT 2 // Amostras centradas reduzidas a ±512, mantendo o Goertzel em 32 bits
+#define WHISTLE_TONAL_RATIO_Q8 77 // Fração mínima da energia do bloco num só filtro (0.3 em Q8)
+#define WHISTLE_MIN_ENERGY 16 // Energia média mínima por amostra (já reduzida) para considerar o bloco, sem piso de ruído
+#define WHISTLE_ON_BLOCKS 6 // Blocos tonais acumulados para declarar o apito
+#define WHISTLE_MAX_BLOCKS 12 // Teto do contador (tempo máximo para esquecer o apito)
+
+// Frequências típicas do apito da válvula da panela de pressão (Hz)
+#define WHISTLE_FREQUENCIES { 1000, 1250, 1500, 1750, 2000, 2250, 2500, 2750, 3000, 3250, 3500, 3750, 4000 }
+
+typedef struct {
+    int32_t coeff[WHISTLE_N_BINS]; // 2·cos(2πf/fs) em Q12
+    uint8_t tonal_blocks; // Contador de persistência
+    bool detected;
+    int8_t last_bin; // Filtro mais forte no último bloco (-1 se nenhum tonal)
+    uint16_t last_ratio_q8; // Razão tonal do filtro mais forte no último bloco
+    uint32_t min_energy; // Energia média mínima por amostra em vigor (whistle_set_min_energy)
+} whistle_detector_t;
+
+void whistle_init(whistle_detector_t *det, uint32_t sample_rate);
+void whistle_reset(whistle_detector_t *det);
+void whistle_set_min_energy(whistle_detector_t *det, uint32_t min_energy);
+bool whistle_process(whistle_detector_t *det, const uint16_t *samples, uint32_t count);
+
+#endif
@@ -1,30 +1,37 @@
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
-#include "pico/stdlib.h"
-#include "pico/binary_info.h"
-#include "hardware/adc.h"
-#include "hardware/dma.h"
-#include "hardware/i2c.h"
-#include "hardware/pwm.h"
-#include "hardware/clocks.h"
+#include "hal.h"
 #include "neopixel.c"
 #include "ssd1306.h"
+#include "audio.h"
+#include "event_sched.h"
+#include "tone.h"
+#include "trace.h"
+#include "spectrum.h"
+#include "recorder.h"
+#include "anim.h"
+#include "power.h"
+#include "level_meter.h"
+#include "kvstore.h"
+#include "led_anim.h"
+#include "splash_anim.h"
+#include "spinner_anim.h"
 
 // Configurações do ADC e Microfone
 #define MIC_CHANNEL 2
 #define MIC_PIN (26 + MIC_CHANNEL)
-#define ADC_CLOCK_DIV 96.f
-#define SAMPLES 200
-#define ADC_ADJUST(x) (x * 3.3f / (1 << 12u) - 1.65f)
 #define ADC_MAX 3.3f
-#define ADC_STEP (3.3f/5.f)
 
 
 // Configurações LED e Display
 #define LED_PIN 7
 #define LED_COUNT 25
 #define LED_R 11
+#define LED_LEVELS 5 // Um quadro-chave por nível de intensidade do áudio
+#define LED_RINGS 4 // Centro e anéis a 1, 2 e 3 passos dele (os cantos ficam apagados)
+#define LED_FRAME_MS 5 // 200 quadros/s: o pontilhamento dos brilhos baixos não pisca
+#define LED_SLEW_Q8 (256 * LED_FRAME_MS / 100) // Transição de ~100 ms entre dois níveis
 #define I2C_SDA 14
 #define I2C_SCL 15
 
@@ -41,126 +48,253 @@
 #define TIMER_3MIN (3 * 60)
 #define TIMER_10MIN (10 * 60)
 
-// Adicionar no início do arquivo, após os includes existentes
-void sample_mic(void);
-float mic_power(void);
-void joystick_read_axis(uint16_t* vrx, uint16_t* vry);
-void play_tone(uint gpio, uint freq, uint duration_ms);
-uint8_t get_intensity(float v);
+// Nível mínimo do som (dB acima do piso de ruído) para aceitar o apito do feijão
+#define WHISTLE_MIN_LEVEL_DB 20
+
+// Escalonador: período da interface, debounce dos botões e ids dos prazos
+#define UI_TICK_MS 50
+#define BUTTON_DEBOUNCE_MS 200
+#define DEADLINE_REDRAW 0 // Próxima mudança de segundo na tela da contagem (sem tique)
+#define DEADLINE_TIMER(i) (1 + (i)) // Fim de cada timer de cozinha
+#define DEADLINE_LEDS DEADLINE_TIMER(KITCHEN_TIMERS) // Próximo quadro dos LEDs
+
+// Timers de cozinha simultâneos (miojo, feijão, ...), um por linha na tela
+#define KITCHEN_TIMERS 4
+#define TIMERS_FULL_MS 2000 // Aviso de que não há posição livre para mais um timer
+
+// Opções do menu principal
+#define MENU_OPTIONS 5
+#define MENU_SPACING 10
+
+// Abertura (enquanto a USB enumera) e indicador de atividade do monitoramento
+#define SPLASH_MS 3000
+#define SPINNER_X 104
+#define SPINNER_PAGE 3
 
-// Adicionar nas definições no início do arquivo
-#define ADC_STEP (3.3f/5.f) // Intervalo de tensão para cada nível de volume
+// Tamanho dos dígitos da contagem do timer
+#define TIMER_DIGIT_SCALE 3
+
+// Linha de comando recebida pela USB
+#define CONSOLE_LINE 16
+
+// Chaves das configurações e tipos de evento guardados na flash (kvstore.h)
+#define SETTING_BOOTS 0
+#define SETTING_MIOJO_TIMER 1
+#define SETTING_NOISE_FLOOR 2
+#define HISTORY_WHISTLE 1
+
+// Definidas mais abaixo
+void joystick_read_axis(uint16_t* vrx, uint16_t* vry);
+void handle_event(const event_t *event);
 
 // Estados do sistema
 enum SystemState {
     STATE_MENU,
     STATE_MIOJO_SELECT,
-    STATE_MIOJO_TIMER,
     STATE_FEIJAO_MONITOR,
-    STATE_FEIJAO_TIMER
+    STATE_TIMERS,
+    STATE_SPECTRUM,
+    STATE_RECORD
 };
 
 // Variáveis globais
 enum SystemState current_state = STATE_MENU;
-uint dma_channel;
-dma_channel_config dma_cfg;
-uint16_t adc_buffer[SAMPLES];
+audio_report_t audio; // Último relatório recebido do core de áudio
 uint8_t ssd[ssd1306_buffer_length];
-struct render_area frame_area = {
-    .start_column = 0,
-    .end_column = ssd1306_width - 1,
-    .start_page = 0,
-    .end_page = ssd1306_n_pages - 1,
-    .buffer_length = 0  // Será calculado pela função calculate_render_area_buffer_length
-};
 int menu_selection = 0;
-bool timer_active = false;
-absolute_time_t timer_start;
-int remaining_time = 0;
+// Rótulos fixos, com o layout calculado uma vez em setup_hardware()
+const char *const menu_names[MENU_OPTIONS] = { "Modo Miojo", "Modo Feijao", "Espectro", "Gravar", "Timers" };
+ssd1306_text_t menu_labels[MENU_OPTIONS];
+ssd1306_text_t menu_title;
+ssd1306_text_t back_label;
+bool joystick_moved = false; // Eixo fora do centro: espera voltar antes do próximo passo
+spectrum_view_t spectrum_view;
+anim_player_t spinner;
+uint8_t spinner_frame[32]; // Quadro atual do indicador (16x16), mantido entre os tiques
+char console_line[CONSOLE_LINE];
+uint console_length = 0;
+uint32_t last_button_ms = 0;
+
+// Timer de cozinha: contagem regressiva (miojo) ou cronômetro (feijão, desde o apito)
+typedef struct {
+    const char *name;
+    uint64_t start_us;
+    uint32_t duration_s; // 0 = cronômetro
+    bool active;
+} kitchen_timer_t;
+
+kitchen_timer_t kitchen_timers[KITCHEN_TIMERS];
+int timer_selection = 0; // Linha escolhida na tela dos timers
+uint64_t timers_full_until_us = 0; // "Timers cheios" fica na tela até aqui
+
+// Aviso de fim do timer: 1 kHz por 1 s, tocado sem bloquear o laço
+const tone_note_t alarm_notes[] = { { 1000, 1000 } };
+tone_melody_t alarm_melody;
 int selected_timer = TIMER_3MIN;
-bool feijao_timer_started = false;
+
+// Cor de cada anel em cada nível, em brilho percebido (a gama fica por conta de led_anim)
+const uint8_t led_ring_colors[LED_LEVELS][LED_RINGS][3] = {
+    { { 0, 0, 70 } }, // Só o centro, fraco
+    { { 0, 0, 100 } }, // Só o centro
+    { { 0, 0, 137 }, { 0, 0, 100 } }, // Centro mais forte e o primeiro anel
+    { { 100, 100, 0 }, { 0, 0, 137 }, { 0, 0, 100 } }, // Centro amarelo
+    { { 100, 0, 0 }, { 100, 100, 0 }, { 0, 0, 137 }, { 0, 0, 100 } }, // Centro vermelho
+};
+led_anim_frame_t led_keyframes[LED_LEVELS];
+led_anim_t led_anim;
+uint64_t led_frame_us; // Prazo do quadro atual dos LEDs
+bool leds_still = false; // O quadro na matriz só muda com outro nível: nenhum quadro até lá
+_Static_assert(LED_COUNT == LED_ANIM_PIXELS, "as tabelas de inc/led_tables.h são da matriz 5x5");
+_Static_assert(DEADLINE_LEDS < SCHED_MAX_TIMERS, "um prazo para cada timer e um para os LEDs");
+
+// Apito detectado, como fica no histórico da flash
+typedef struct {
+    uint32_t boot; // Número do boot em que aconteceu
+    uint32_t uptime_s; // Segundos desde aquele boot
+    int32_t level_db_q8;
+} whistle_event_t;
+
+uint32_t boot_count = 0;
+bool noise_calibrating = true; // A calibração do boot começa junto com o áudio
 
 // Funções auxiliares
+
+/**
+ * Toca a animação de abertura por 'duration_ms', decodificando cada quadro direto no
+ * framebuffer; cada quadro sai num único envio, só com o que mudou.
+ */
+void play_splash(uint32_t duration_ms) {
+    anim_player_t player;
+    uint32_t end = hal_time_ms() + duration_ms;
+
+    anim_player_init(&player, &splash_anim, ssd, true);
+    while ((int32_t)(hal_time_ms() - end) < 0) {
+        if (anim_player_update(&player, hal_time_ms())) {
+            ssd1306_draw_image(ssd, 0, 0, splash_anim.width, splash_anim.pages, ssd);
+            ssd1306_flush_wait();
+            ssd1306_flush(ssd);
+        }
+
+        // Dorme até o próximo quadro (ou até o fim da abertura)
+        uint32_t now = hal_time_ms();
+        int32_t wait = (int32_t)(player.due_ms - now);
+        if ((int32_t)(end - now) < wait) wait = end - now;
+        hal_sleep_ms(wait > 0 ? wait : 1);
+    }
+}
+
+/**
+ * Lê as configurações salvas na flash e conta mais um boot.
+ */
+void load_settings() {
+    uint32_t floor[2];
+    int timer;
+
+    kv_init();
+    kv_get(SETTING_BOOTS, &boot_count, sizeof(boot_count));
+    boot_count++;
+    kv_set(SETTING_BOOTS, &boot_count, sizeof(boot_count));
+
+    if (kv_get(SETTING_MIOJO_TIMER, &timer, sizeof(timer)) && (timer == TIMER_3MIN || timer == TIMER_10MIN)) {
+        selected_timer = timer;
+    }
+    if (kv_get(SETTING_NOISE_FLOOR, floor, sizeof(floor))) {
+        audio_restore_noise_floor(floor[0], floor[1]);
+    }
+}
+
+/**
+ * Monta os quadros-chave dos LEDs a partir das cores dos anéis (a distância de cada LED ao
+ * centro, andando só na horizontal e na vertical, diz o anel).
+ */
+void build_led_keyframes() {
+    memset(led_keyframes, 0, sizeof(led_keyframes));
+    for (int level = 0; level < LED_LEVELS; level++) {
+        for (int pos = 0; pos < LED_ANIM_PIXELS; pos++) {
+            int ring = abs(pos % LED_TABLE_WIDTH - LED_TABLE_WIDTH / 2) + abs(pos / LED_TABLE_WIDTH - LED_TABLE_HEIGHT / 2);
+            if (ring < LED_RINGS) {
+                memcpy(led_keyframes[level][pos], led_ring_colors[level][ring], 3);
+            }
+        }
+    }
+    led_anim_init(&led_anim, led_keyframes, LED_LEVELS, LED_SLEW_Q8);
+}
+
 void setup_hardware() {
-    stdio_init_all();
-    sleep_ms(3000);
+    hal_stdio_init();
 
     // Inicialização do I2C primeiro
-    i2c_init(i2c1, ssd1306_i2c_clock * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+    hal_i2c_init(ssd1306_i2c_bus, I2C_SDA, I2C_SCL, ssd1306_i2c_clock * 1000);
 
-    // Inicialização do display OLED
+    // Inicialização do display OLED; a abertura cobre a espera pela USB
     ssd1306_init();
-    calculate_render_area_buffer_length(&frame_area);
-    memset(ssd, 0, ssd1306_buffer_length);
-    render_on_display(ssd, &frame_area);
-
-   // Configuração do ADC
-   printf("Preparando ADC...\n");
-   adc_gpio_init(MIC_PIN);
-   adc_init();
-   adc_select_input(MIC_CHANNEL);
-   adc_fifo_setup(
-       true,    // Habilitar FIFO
-       true,    // Habilitar request de dados do DMA
-       1,       // Threshold para ativar request DMA
-       false,   // Não usar bit de erro
-       false    // Manter 12-bits
-   );
-   adc_set_clkdiv(ADC_CLOCK_DIV);
-
-   // Configuração do DMA
-   dma_channel = dma_claim_unused_channel(true);
-   dma_cfg = dma_channel_get_default_config(dma_channel);
-   channel_config_set_transfer_data_size(&dma_cfg, DMA_SIZE_16);
-   channel_config_set_read_increment(&dma_cfg, false);
-   channel_config_set_write_increment(&dma_cfg, true);
-   channel_config_set_dreq(&dma_cfg, DREQ_ADC);
+    play_splash(SPLASH_MS);
+    ssd1306_flush_wait();
+    ssd1306_clear(ssd);
+    ssd1306_flush(ssd);
+
+    ssd1306_text_layout(&menu_title, "Menu Principal");
+    ssd1306_text_layout(&back_label, "Press B Voltar");
+    for (int i = 0; i < MENU_OPTIONS; i++) {
+        ssd1306_text_layout(&menu_labels[i], menu_names[i]);
+    }
+
+    // Configurações da flash antes do áudio, que começa com o piso de ruído salvo
+    load_settings();
+
+    // Captura contínua do ADC e processamento do áudio (no core1)
+    printf("Preparando ADC...\n");
+    audio_init(MIC_CHANNEL);
 
     // Inicialização dos LEDs
     printf("Inicializando matriz de LEDs...\n");
     npInit(LED_PIN, LED_COUNT);
+    build_led_keyframes();
     npClear();
     npWrite();
 
+    // Gravador de áudio na flash
+    recorder_init(AUDIO_SAMPLE_RATE);
+
+    // Divisores do PWM do buzzer calculados uma vez, a partir do clock real
+    tone_melody_prepare(&alarm_melody, alarm_notes, count_of(alarm_notes));
+
     // Inicialização dos botões
-    
-    gpio_init(BUTTON_B);
-    gpio_init(JOYSTICK_SW);
-    
-    gpio_set_dir(BUTTON_B, GPIO_IN);
-    gpio_set_dir(JOYSTICK_SW, GPIO_IN);
-    
-    gpio_pull_up(BUTTON_B);
-    gpio_pull_up(JOYSTICK_SW);
+    hal_gpio_input_pullup(BUTTON_B);
+    hal_gpio_input_pullup(JOYSTICK_SW);
 }
 
 void draw_menu() {
     // Limpa o buffer completamente
-    memset(ssd, 0, ssd1306_buffer_length);
+    ssd1306_clear(ssd);
     
     // Desenha o título
-    ssd1306_draw_string(ssd, 5, 8, "Menu Principal");
+    ssd1306_draw_text(ssd, 5, 0, &menu_title);
     
     // Desenha as opções - separando a seta do texto
-    ssd1306_draw_string(ssd, 5, 24, menu_selection == 0 ? "X" : " ");
-    ssd1306_draw_string(ssd, 20, 24, "Modo Miojo");
-    
-    ssd1306_draw_string(ssd, 5, 40, menu_selection == 1 ? "X" : " ");
-    ssd1306_draw_string(ssd, 20, 40, "Modo Feijao");
+    for (int i = 0; i < MENU_OPTIONS; i++) {
+        ssd1306_draw_string(ssd, 5, 14 + i * MENU_SPACING, menu_selection == i ? "X" : " ");
+        ssd1306_draw_text(ssd, 20, 14 + i * MENU_SPACING, &menu_labels[i]);
+    }
     
-    // Renderiza
-    calculate_render_area_buffer_length(&frame_area);
-    render_on_display(ssd, &frame_area);
+    // Renderiza só o que mudou
+    ssd1306_flush(ssd);
 }
 
 
+/**
+ * Última linha da tela: avisa, por TIMERS_FULL_MS, que um timer não começou porque todas
+ * as posições estão em uso.
+ */
+void draw_timers_full() {
+    if (hal_time_us() < timers_full_until_us) {
+        ssd1306_draw_string(ssd, 5, 56, "Timers cheios");
+    }
+}
+
 void draw_miojo_menu() {
     // Limpa o buffer completamente
-    memset(ssd, 0, ssd1306_buffer_length);
+    ssd1306_clear(ssd);
     
     // Desenha o título
     ssd1306_draw_string(ssd, 5, 8, "Timer Miojo");
@@ -171,343 +305,697 @@ void draw_miojo_menu() {
     
     ssd1306_draw_string(ssd, 5, 40, selected_timer == TIMER_10MIN ? "X" : " ");
     ssd1306_draw_string(ssd, 20, 40, "10 minutos");
+    draw_timers_full();
     
-    // Renderiza
-    calculate_render_area_buffer_length(&frame_area);
-    render_on_display(ssd, &frame_area);
+    // Renderiza só o que mudou
+    ssd1306_flush(ssd);
 }
 
 
 void update_timer_display(int seconds, bool is_countdown) {
     // Limpa o buffer completamente
-    memset(ssd, 0, ssd1306_buffer_length);
+    ssd1306_clear(ssd);
     
     // Prepara a string do timer
-    char time_str[32];
-    snprintf(time_str, sizeof(time_str), "%s: %02d:%02d", 
-             is_countdown ? "Restam" : "Pressao",
-             seconds / 60, seconds % 60);
+    char time_str[16];
+    snprintf(time_str, sizeof(time_str), "%02d:%02d", seconds / 60, seconds % 60);
     
-    // Calcula a posição central
-    int x = (ssd1306_width - strlen(time_str) * 8) / 2;
+    // Calcula a posição central dos dígitos grandes
+    int x = (ssd1306_width - ssd1306_string_width(time_str, TIMER_DIGIT_SCALE)) / 2;
     
     // Desenha as strings
-    ssd1306_draw_string(ssd, 5, 10, "Press B Voltar");
-    ssd1306_draw_string(ssd, x, 24, time_str);
+    ssd1306_draw_text(ssd, 5, 0, &back_label);
+    ssd1306_draw_string(ssd, 5, 14, is_countdown ? "Restam" : "Pressao");
+    ssd1306_draw_string_scaled(ssd, x, 30, time_str, TIMER_DIGIT_SCALE);
     
-    // Calcula o tamanho do buffer e renderiza
-    calculate_render_area_buffer_length(&frame_area);
-    render_on_display(ssd, &frame_area);
+    // Envia só o que mudou (nada, se o texto for o mesmo)
+    ssd1306_flush(ssd);
 }
 
 
-float get_sound_level() {
-    sample_mic();
-    float avg = mic_power();
-    float adjusted = 3.3 * abs(ADC_ADJUST(avg));
-    
-    printf("Media ADC ajustada: %8.4f\n", adjusted);
-    return adjusted;
+/**
+ * Inicia um timer de cozinha numa posição livre (duration_s = 0 para cronômetro) e arma o
+ * prazo dele; retorna a posição, ou -1 se todos estão em uso.
+ */
+int kitchen_timer_add(const char *name, uint32_t duration_s) {
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        kitchen_timer_t *timer = &kitchen_timers[i];
+        if (timer->active) {
+            continue;
+        }
+        timer->name = name;
+        timer->start_us = hal_time_us();
+        timer->duration_s = duration_s;
+        timer->active = true;
+        if (duration_s > 0) {
+            sched_timer_start_at(DEADLINE_TIMER(i), timer->start_us + (uint64_t)duration_s * 1000000);
+        }
+        return i;
+    }
+    return -1;
 }
 
-int get_matrix_index(int pos) {
-    // A matriz é 5x5, pos vai de 0 a 24
-    int x = pos % 5;
-    int y = pos / 5;
-    
-    // Se a linha é ímpar, inverte a direção
-    if (y % 2 == 1) {
-        x = 4 - x;
+/**
+ * Encerra um timer de cozinha (vencido ou cancelado pelo usuário).
+ */
+void kitchen_timer_remove(int index) {
+    sched_timer_cancel(DEADLINE_TIMER(index));
+    kitchen_timers[index].active = false;
+}
+
+int kitchen_timer_count() {
+    int count = 0;
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        count += kitchen_timers[i].active;
     }
-    
-    return y * 5 + x;
+    return count;
+}
+
+/**
+ * Segundos mostrados na tela: o que falta na contagem regressiva, o que passou no cronômetro.
+ */
+int kitchen_timer_seconds(const kitchen_timer_t *timer) {
+    int elapsed = (hal_time_us() - timer->start_us) / 1000000;
+    if (timer->duration_s == 0) {
+        return elapsed;
+    }
+    return elapsed < (int)timer->duration_s ? (int)timer->duration_s - elapsed : 0;
+}
+
+/**
+ * Há um cronômetro de feijão rodando? Enquanto houver, os LEDs seguem mostrando o som.
+ */
+bool kitchen_timer_listening() {
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        if (kitchen_timers[i].active && kitchen_timers[i].duration_s == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Instante da próxima troca de segundo em algum timer ativo (0 se não há nenhum).
+ */
+uint64_t kitchen_timer_next_change() {
+    uint64_t now = hal_time_us();
+    uint64_t next = 0;
+
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        const kitchen_timer_t *timer = &kitchen_timers[i];
+        if (!timer->active) {
+            continue;
+        }
+        uint64_t change = timer->start_us + ((now - timer->start_us) / 1000000 + 1) * 1000000;
+        if (next == 0 || change < next) {
+            next = change;
+        }
+    }
+    return next;
+}
+
+/**
+ * Tela dos timers: um só aparece grande, como sempre; com mais de um, uma linha por timer,
+ * e o joystick escolhe qual o botão do joystick cancela.
+ */
+void draw_timers() {
+    int count = kitchen_timer_count();
+    int row = 0;
+
+    if (count == 1) {
+        for (int i = 0; i < KITCHEN_TIMERS; i++) {
+            if (kitchen_timers[i].active) {
+                update_timer_display(kitchen_timer_seconds(&kitchen_timers[i]), kitchen_timers[i].duration_s > 0);
+            }
+        }
+        return;
+    }
+
+    ssd1306_clear(ssd);
+    ssd1306_draw_text(ssd, 5, 0, &back_label);
+    if (count == 0) {
+        ssd1306_draw_string(ssd, 5, 24, "Nenhum timer");
+    }
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        const kitchen_timer_t *timer = &kitchen_timers[i];
+        if (!timer->active) {
+            continue;
+        }
+
+        char time_str[8];
+        int seconds = kitchen_timer_seconds(timer);
+        snprintf(time_str, sizeof(time_str), "%02d:%02d", seconds / 60 % 100, seconds % 60);
+
+        int y = 16 + row * 12;
+        ssd1306_draw_string(ssd, 5, y, timer_selection == row ? "X" : " ");
+        ssd1306_draw_string(ssd, 20, y, timer->name);
+        ssd1306_draw_string(ssd, ssd1306_width - 5 - ssd1306_string_width(time_str, 1), y, time_str);
+        row++;
+    }
+    ssd1306_flush(ssd);
+}
+
+/**
+ * Posição do timer na linha 'row' da tela (a lista pula as posições livres), ou -1.
+ */
+int kitchen_timer_at_row(int row) {
+    for (int i = 0; i < KITCHEN_TIMERS; i++) {
+        if (kitchen_timers[i].active && row-- == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Quadro do analisador de espectro: título na primeira página e barras com pico nas demais.
+ */
+void draw_spectrum() {
+    ssd1306_clear(ssd);
+    ssd1306_draw_string(ssd, 5, 0, "Espectro");
+    spectrum_render(&spectrum_view, ssd);
+    ssd1306_flush(ssd);
+}
+
+/**
+ * Tela do gravador: etapa atual, duração e espaço usado na flash.
+ */
+void draw_recorder() {
+    uint32_t bytes = recorder_bytes();
+    int seconds = bytes * 2 / AUDIO_SAMPLE_RATE; // Duas amostras por byte
+    char line[32];
+
+    ssd1306_clear(ssd);
+    switch (recorder_state()) {
+        case RECORDER_ERASING:
+            ssd1306_draw_string(ssd, 5, 8, "Apagando flash");
+            break;
+        case RECORDER_RECORDING:
+            ssd1306_draw_string(ssd, 5, 8, "Gravando");
+            break;
+        default:
+            ssd1306_draw_string(ssd, 5, 8, "Gravacao salva");
+            break;
+    }
+
+    snprintf(line, sizeof(line), "%02d:%02d %luKB", seconds / 60, seconds % 60, (unsigned long)(bytes / 1024));
+    ssd1306_draw_string(ssd, 5, 28, line);
+    ssd1306_draw_string(ssd, 5, 48, "B Parar");
+    ssd1306_flush(ssd);
+}
+
+uint8_t get_sound_intensity() {
+    // Registro binário em vez de printf com float: a formatação custava mais que o resto do tique
+    TRACE_COUNTER(TRACE_SOUND_LEVEL, audio.rms_q4);
+    return audio.intensity; // Já quantizado pelo medidor de nível no core de áudio
+}
+
+/**
+ * Próximo quadro dos LEDs, andando até o desenho da intensidade atual; retorna false se o
+ * quadro não vai mais mudar sozinho. A transição e o pontilhamento precisam de quadros
+ * frequentes e regulares (on_led_frame).
+ */
+bool update_leds(uint8_t intensity) {
+    led_anim_set_level(&led_anim, intensity);
+    bool more = led_anim_render(&led_anim, leds);
+    npWrite();
+    TRACE_COUNTER(TRACE_INTENSITY, intensity);
+    return more;
+}
+
+void joystick_read_axis(uint16_t* vrx, uint16_t* vry) {
+    // O ADC pertence ao core de áudio, que lê o joystick junto com cada bloco
+    *vrx = audio.vrx;
+    *vry = audio.vry;
+}
+
+/**
+ * Troca o modo de energia e, com ele, o tique da interface: na contagem não há tique, e a
+ * tela é redesenhada pelo prazo DEADLINE_REDRAW só quando um número muda.
+ */
+void set_power_mode(power_mode_t mode) {
+    if (mode == power_mode()) {
+        return;
+    }
+    power_set_mode(mode);
+    sched_tick_start(mode == POWER_COUNTDOWN ? 0 : UI_TICK_MS);
+    if (mode != POWER_COUNTDOWN) {
+        sched_timer_cancel(DEADLINE_REDRAW);
+    }
+}
+
+/**
+ * Escolhe o modo de energia pelo que a tela precisa: o monitor e os cronômetros de feijão
+ * ouvem o microfone; uma contagem regressiva sozinha na tela não precisa nem do ADC. O alarme
+ * toca sempre no clock cheio, para o qual a melodia foi calculada.
+ */
+void update_power_mode() {
+    power_mode_t mode = POWER_ACTIVE;
+
+    if (tone_is_playing()) {
+        // Fica no clock cheio até a melodia acabar
+    } else if (current_state == STATE_FEIJAO_MONITOR) {
+        mode = POWER_LISTEN;
+    } else if (current_state == STATE_TIMERS && kitchen_timer_count() > 0) {
+        // Com mais de um timer, o joystick (que vem do ADC) escolhe a linha
+        mode = kitchen_timer_count() == 1 && !kitchen_timer_listening() ? POWER_COUNTDOWN : POWER_LISTEN;
+    }
+    set_power_mode(mode);
+}
+
+/**
+ * Um passo por movimento do joystick: -1 (cima), 1 (baixo) ou 0; espera voltar ao centro.
+ */
+int joystick_step(uint16_t vrx) {
+    int step = 0;
+
+    if (vrx > 3000 || vrx < 1000) {
+        if (!joystick_moved) {
+            step = vrx > 3000 ? -1 : 1;
+        }
+        joystick_moved = true;
+    }
+    else if (vrx > 1500 && vrx < 2500) {
+        joystick_moved = false;
+    }
+    return step;
 }
 
-void update_leds(float sound_level) {
+/**
+ * Volta ao menu e apaga a matriz de LEDs; os timers de cozinha continuam correndo.
+ */
+void go_to_menu() {
+    current_state = STATE_MENU;
+    audio_set_spectrum(false);
     npClear();
-    uint8_t intensity = get_intensity(sound_level);
-
-    // Definir os anéis uma única vez no início da função
-    const int anel1[] = {7, 11, 13, 17};
-    const int anel2[] = {2, 6, 8, 10, 14, 16, 18, 22};
-    const int anel3[] = {1, 3, 5, 9, 15, 19, 21, 23};
-
-    // A depender da intensidade do som, acende LEDs específicos
-    switch (intensity) {
-        case 0:
-            npSetLED(get_matrix_index(12), 0, 0, 1); // Acende apenas o centro 
-            break; // Se o som for muito baixo, não acende nada
-            
-        case 1:
-            npSetLED(get_matrix_index(12), 0, 0, 1); // Acende apenas o centro
+    npWrite();
+    leds_still = false;
+}
+
+/**
+ * Os LEDs mostram o som enquanto ele é escutado: no monitor e com um cronômetro de feijão.
+ */
+bool leds_listening() {
+    return current_state == STATE_FEIJAO_MONITOR || (current_state == STATE_TIMERS && kitchen_timer_listening());
+}
+
+/**
+ * Quadro dos LEDs enquanto se escuta o som. A transição anda no prazo DEADLINE_LEDS, a cada
+ * LED_FRAME_MS; um nível parado e pontilhado também, exceto na escuta, onde os quadros vêm
+ * com os despertares que já existem (blocos de áudio e tique, start_led_frames), mais devagar
+ * mas sem acordar o core0 200 vezes por segundo; um quadro parado sem pontilhamento não pede
+ * mais nenhum. Um atraso não é compensado com quadros seguidos: o próximo sai um período
+ * depois deste.
+ */
+void on_led_frame() {
+    uint64_t now = hal_time_us();
+
+    if (!leds_listening()) {
+        return;
+    }
+    leds_still = !update_leds(get_sound_intensity());
+    if (leds_still || (led_anim.position_q8 == led_anim.target_q8 && power_mode() == POWER_LISTEN)) {
+        return;
+    }
+    led_frame_us += LED_FRAME_MS * 1000;
+    if ((int64_t)(led_frame_us - now) <= 0) {
+        led_frame_us = now + LED_FRAME_MS * 1000;
+    }
+    sched_timer_start_at(DEADLINE_LEDS, led_frame_us);
+}
+
+/**
+ * Mostra um quadro dos LEDs fora do prazo DEADLINE_LEDS, se há o que mostrar: ao começar a
+ * escutar, com um nível novo vindo do áudio, ou com o pontilhamento da escuta.
+ */
+void start_led_frames() {
+    if (!leds_listening() || sched_timer_active(DEADLINE_LEDS)) {
+        return;
+    }
+    if (leds_still && led_anim.target_q8 == audio.intensity << 8) {
+        return;
+    }
+    led_frame_us = hal_time_us();
+    on_led_frame();
+}
+
+/**
+ * Tique da interface: lê o joystick, redesenha o estado atual e põe os LEDs para andar.
+ */
+void on_ui_tick() {
+    uint16_t vrx, vry;
+
+    update_power_mode();
+    joystick_read_axis(&vrx, &vry);
+    start_led_frames();
+
+    switch (current_state) {
+        case STATE_MENU:
+            // Um passo por movimento (com várias opções não dá para usar a posição)
+            menu_selection = (menu_selection + MENU_OPTIONS + joystick_step(vrx)) % MENU_OPTIONS;
+            draw_menu();
             break;
-            
-        case 2:
-            npSetLED(get_matrix_index(12), 0, 0, 2); // Centro mais brilhante
-            // Primeiro anel
-            for (int i = 0; i < 4; i++) {
-                int pos = get_matrix_index(7 + i*2);
-                npSetLED(pos, 0, 0, 1);
-            }
+
+        case STATE_MIOJO_SELECT:
+            if (vrx > 3000) selected_timer = TIMER_3MIN;
+            else if (vrx < 1000) selected_timer = TIMER_10MIN;
+            draw_miojo_menu();
             break;
-            
-        case 3:
-            npSetLED(get_matrix_index(12), 1, 1, 0); // Centro amarelo
-            // Primeiro anel azul
-            for (int i = 0; i < 4; i++) {
-                int pos = get_matrix_index(7 + i*2);
-                npSetLED(pos, 0, 0, 2);
-            }
-            // Segundo anel
-            for (int i = 0; i < 8; i++) {
-                npSetLED(get_matrix_index(anel2[i]), 0, 0, 1);
-            }
+
+        case STATE_FEIJAO_MONITOR:
+            // Os LEDs acompanham o som em on_led_frame
+            ssd1306_clear(ssd);
+            ssd1306_draw_string(ssd, 5, 24, "Monitorando...");
+            anim_player_update(&spinner, hal_time_ms());
+            ssd1306_draw_image(ssd, SPINNER_X, SPINNER_PAGE, spinner_anim.width, spinner_anim.pages, spinner_frame);
+            draw_timers_full();
+            ssd1306_flush(ssd);
             break;
-            
-        default: // Intensidade 4 ou maior
-            npSetLED(get_matrix_index(12), 1, 0, 0); // Centro vermelho
-            
-            // Primeiro anel amarelo
-            for (int i = 0; i < 4; i++) {
-                npSetLED(get_matrix_index(anel1[i]), 1, 1, 0);
+
+        case STATE_TIMERS: {
+            // Os fins são tratados pelos prazos DEADLINE_TIMER; aqui só se mostra o tempo
+            int count = kitchen_timer_count();
+
+            if (count > 1) {
+                timer_selection = (timer_selection + count + joystick_step(vrx)) % count;
             }
-            // Segundo anel azul
-            for (int i = 0; i < 8; i++) {
-                npSetLED(get_matrix_index(anel2[i]), 0, 0, 2);
+            if (timer_selection >= count) {
+                timer_selection = count > 0 ? count - 1 : 0;
             }
-            // Terceiro anel azul fraco
-            for (int i = 0; i < 8; i++) {
-                npSetLED(get_matrix_index(anel3[i]), 0, 0, 1);
+            draw_timers();
+            if (power_mode() == POWER_COUNTDOWN) {
+                sched_timer_start_at(DEADLINE_REDRAW, kitchen_timer_next_change());
             }
             break;
+        }
+
+        case STATE_SPECTRUM:
+            // O tique de 50 ms dá os 20 quadros por segundo
+            draw_spectrum();
+            break;
+
+        case STATE_RECORD:
+            draw_recorder();
+            break;
     }
-    
-    npWrite();
-    printf("Intensidade: %d\n", intensity);
 }
 
-void joystick_read_axis(uint16_t* vrx, uint16_t* vry) {
-    adc_select_input(0); // Canal do VRX
-    *vrx = adc_read();
-    
-    adc_select_input(1); // Canal do VRY
-    *vry = adc_read();
-    
-    // Retorna para o canal do microfone
-    adc_select_input(MIC_CHANNEL);
-}
+/**
+ * Novos blocos de áudio: atualiza o último relatório e reage ao apito.
+ */
+void on_audio_block() {
+    if (!audio_update(&audio)) {
+        return;
+    }
 
-void play_tone(uint gpio, uint freq, uint duration_ms) {
-    // Configura PWM para o buzzer
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice_num = pwm_gpio_to_slice_num(gpio);
-    uint chan = pwm_gpio_to_channel(gpio);
-    
-    // Configura frequência
-    uint32_t clock = 125000000;
-    uint32_t divider = clock / 1000000;
-    pwm_set_clkdiv(slice_num, divider);
-    pwm_set_wrap(slice_num, 1000000/freq);
-    pwm_set_chan_level(slice_num, chan, 1000000/(2*freq));
-    
-    // Ativa o PWM
-    pwm_set_enabled(slice_num, true);
-    sleep_ms(duration_ms);
-    pwm_set_enabled(slice_num, false);
+    if (current_state == STATE_SPECTRUM && audio.has_spectrum) {
+        spectrum_view_push(&spectrum_view, audio.spectrum);
+    }
+    start_led_frames();
+
+    // Calibração terminada: o piso fica salvo para o próximo boot
+    if (noise_calibrating && !audio.calibrating) {
+        uint32_t floor[2] = { audio.floor_q4, audio.dc_q4 };
+        kv_set(SETTING_NOISE_FLOOR, floor, sizeof(floor));
+    }
+    noise_calibrating = audio.calibrating;
+
+    // Inicia o cronômetro se detectar o apito da panela (tom persistente, não só volume, e bem
+    // acima do ruído de fundo)
+    if (current_state == STATE_FEIJAO_MONITOR && audio.whistle && audio.level_db_q8 >= LEVEL_METER_DB(WHISTLE_MIN_LEVEL_DB)) {
+        // Sem posição livre o monitor continua e avisa; o apito só vai ao histórico se o
+        // cronômetro começou
+        if (kitchen_timer_add("Feijao", 0) < 0) {
+            timers_full_until_us = hal_time_us() + TIMERS_FULL_MS * 1000;
+            return;
+        }
+        whistle_event_t event = { boot_count, hal_time_ms() / 1000, audio.level_db_q8 };
+        kv_log_event(HISTORY_WHISTLE, &event, sizeof(event));
+        current_state = STATE_TIMERS;
+        on_ui_tick();
+    }
 }
 
-int main() {
-    setup_hardware();
-    
-    while (true) {
-        uint16_t vrx, vry;
-        joystick_read_axis(&vrx, &vry);
-        
-        switch (current_state) {
-            case STATE_MENU:
-                draw_menu();
-                if (vrx > 3000) menu_selection = 0;
-                else if (vrx < 1000) menu_selection = 1;
-                
-                if (!gpio_get(BUTTON_B)) {
-                    if (menu_selection == 0) {
-                        current_state = STATE_MIOJO_SELECT;
-                    } else {
-                        current_state = STATE_FEIJAO_MONITOR;
-                    }
-                    sleep_ms(200);
-                }
-                break;
+/**
+ * Botão pressionado. B escolhe no menu, inicia o timer, ou volta ao menu; o botão do
+ * joystick cancela o timer escolhido na tela dos timers.
+ */
+void on_button(uint gpio) {
+    if (gpio == JOYSTICK_SW) {
+        int index = kitchen_timer_at_row(timer_selection);
+        if (current_state != STATE_TIMERS || index < 0) {
+            return;
+        }
+        kitchen_timer_remove(index);
+        if (kitchen_timer_count() == 0) {
+            go_to_menu();
+        }
+        on_ui_tick();
+        return;
+    }
+    if (gpio != BUTTON_B) {
+        return;
+    }
 
-            case STATE_MIOJO_SELECT:
-                draw_miojo_menu();
-                if (vrx > 3000) selected_timer = TIMER_3MIN;
-                else if (vrx < 1000) selected_timer = TIMER_10MIN;
-                
-                if (!gpio_get(BUTTON_B)) {
-                    timer_active = true;
-                    remaining_time = selected_timer;
-                    timer_start = get_absolute_time();
-                    current_state = STATE_MIOJO_TIMER;
-                    sleep_ms(200);
+    switch (current_state) {
+        case STATE_MENU:
+            if (menu_selection == 0) {
+                current_state = STATE_MIOJO_SELECT;
+            } else if (menu_selection == 1) {
+                current_state = STATE_FEIJAO_MONITOR;
+                audio_reset_detector();
+                audio_calibrate(); // O ruído da cozinha muda de uma vez para outra
+                anim_player_init(&spinner, &spinner_anim, spinner_frame, true);
+            } else if (menu_selection == 2) {
+                current_state = STATE_SPECTRUM;
+                spectrum_view_init(&spectrum_view);
+                audio_set_spectrum(true);
+            } else if (menu_selection == 3) {
+                if (recorder_start()) {
+                    current_state = STATE_RECORD;
                 }
-                break;
+            } else {
+                current_state = STATE_TIMERS;
+            }
+            break;
 
-            case STATE_MIOJO_TIMER:
-                if (timer_active) {
-                    int elapsed = to_ms_since_boot(get_absolute_time()) - 
-                                to_ms_since_boot(timer_start);
-                    remaining_time = selected_timer - (elapsed / 1000);
-                    
-                    if (remaining_time <= 0) {
-                        // Timer acabou
-                        play_tone(BUZZER_A, 1000, 1000);
-                        timer_active = false;
-                        current_state = STATE_MENU;
-                    } else {
-                        update_timer_display(remaining_time, true);
-                    }
-                }
+        case STATE_MIOJO_SELECT:
+            kv_set(SETTING_MIOJO_TIMER, &selected_timer, sizeof(selected_timer));
+            // Sem posição livre fica na escolha, com o aviso
+            if (kitchen_timer_add(selected_timer == TIMER_3MIN ? "Miojo 3min" : "Miojo 10min", selected_timer) < 0) {
+                timers_full_until_us = hal_time_us() + TIMERS_FULL_MS * 1000;
                 break;
+            }
+            current_state = STATE_TIMERS;
+            break;
 
-                case STATE_FEIJAO_MONITOR:
-                float sound_level;
-                uint8_t intensity;
-                
-                // Continua monitorando o som e atualizando os LEDs
-                sound_level = get_sound_level();
-                intensity = get_intensity(sound_level);
-                update_leds(sound_level);
-                
-                // Inicia o timer se detectar som alto
-                if (intensity > 1 && !feijao_timer_started) { // Reduzido de 2 para 1
-                    feijao_timer_started = true;
-                    timer_start = get_absolute_time();
-                    current_state = STATE_FEIJAO_TIMER;
-                }
-                
-                memset(ssd, 0, ssd1306_buffer_length);
-                ssd1306_draw_string(ssd, 5, 24, "Monitorando...");
-                calculate_render_area_buffer_length(&frame_area);
-                render_on_display(ssd, &frame_area);
-                break;
-            
-            case STATE_FEIJAO_TIMER:
-                // Continua monitorando e atualizando os LEDs mesmo no modo timer
-                sound_level = get_sound_level();
-                update_leds(sound_level);
-                
-                if (feijao_timer_started) {
-                    int elapsed = to_ms_since_boot(get_absolute_time()) - 
-                                to_ms_since_boot(timer_start);
-                    update_timer_display(elapsed / 1000, false);
-                }
-                break;
-        }
-        
-        if (!gpio_get(BUTTON_B) && (current_state != STATE_MENU)) {
-            current_state = STATE_MENU;
-            timer_active = false;
-            feijao_timer_started = false;
-            // Desliga a matriz de LEDs ao sair do modo feijão
-            npClear();
-            npWrite();
-            sleep_ms(200);
-        }
-        
-        sleep_ms(100);
+        case STATE_RECORD:
+            // Primeiro B para a gravação; o segundo, depois de salva, volta ao menu
+            if (recorder_state() == RECORDER_IDLE) {
+                go_to_menu();
+            } else {
+                recorder_stop();
+            }
+            break;
+
+        default:
+            go_to_menu();
+            break;
     }
-    
-    return 0;
+
+    // Redesenha já, sem esperar o próximo tique
+    on_ui_tick();
 }
 
 /**
- * Realiza as leituras do ADC e armazena os valores no buffer.
+ * Prazo vencido: um timer de cozinha acabou, é hora de mudar um número na contagem ou de
+ * mostrar o próximo quadro dos LEDs.
  */
-void sample_mic() {
-    adc_fifo_drain(); // Limpa o FIFO do ADC.
-    adc_run(false); // Desliga o ADC (se estiver ligado) para configurar o DMA.
+void on_deadline(uint id) {
+    if (id == DEADLINE_REDRAW) {
+        on_ui_tick();
+        return;
+    }
+    if (id == DEADLINE_LEDS) {
+        on_led_frame();
+        return;
+    }
 
-    dma_channel_configure(dma_channel, &dma_cfg,
-        adc_buffer, // Escreve no buffer.
-        &(adc_hw->fifo), // Lê do ADC.
-        SAMPLES, // Faz SAMPLES amostras.
-        true // Liga o DMA.
-    );
+    int index = id - DEADLINE_TIMER(0);
+    if (index < 0 || index >= KITCHEN_TIMERS || !kitchen_timers[index].active) {
+        return;
+    }
+    kitchen_timer_remove(index);
+    if (current_state == STATE_TIMERS && kitchen_timer_count() == 0) {
+        go_to_menu();
+    }
+    set_power_mode(POWER_ACTIVE); // A melodia foi calculada para o clock cheio
+    tone_play(BUZZER_A, &alarm_melody);
+    on_ui_tick();
+}
 
-    // Liga o ADC e espera acabar a leitura.
-    adc_run(true);
-    dma_channel_wait_for_finish_blocking(dma_channel);
-    
-    // Acabou a leitura, desliga o ADC de novo.
-    adc_run(false);
+/**
+ * Máquina de estados: cada evento é tratado até o fim, sem esperas.
+ */
+void handle_event(const event_t *event) {
+    switch (event->type) {
+        case EVENT_AUDIO_BLOCK:
+            on_audio_block();
+            break;
+        case EVENT_BUTTON:
+            on_button(event->arg);
+            break;
+        case EVENT_TIMER:
+            on_deadline(event->arg);
+            break;
+        case EVENT_TICK:
+            on_ui_tick();
+            break;
+        case EVENT_FLUSH_DONE:
+            // Envia o que mudou enquanto o display recebia o quadro anterior
+            ssd1306_flush(ssd);
+            break;
+    }
 }
 
 /**
- * Calcula a potência média das leituras do ADC. (Valor RMS)
+ * Interrupção do botão: filtra o repique pelo tempo, sem dormir, e posta o evento.
  */
-float mic_power() {
-    float avg = 0.f;
+void on_button_edge(uint gpio, uint32_t events) {
+    (void)events; // Só a borda de descida está habilitada
+    uint32_t now = sched_now_ms();
 
-    for (uint i = 0; i < SAMPLES; ++i)
-        avg += adc_buffer[i] * adc_buffer[i];
-    
-    avg /= SAMPLES;
-    return sqrt(avg);
+    if (now - last_button_ms < BUTTON_DEBOUNCE_MS) {
+        return;
+    }
+    last_button_ms = now;
+    sched_post(EVENT_BUTTON, gpio);
 }
 
 /**
- * Calcula a intensidade do volume registrado no microfone, de 0 a 4, usando a tensão.
+ * Display livre (contexto de interrupção).
  */
-uint8_t get_intensity(float v) {
-    uint count = 0;
-    while ((v -= ADC_STEP/20) > 0.f)
-        ++count;
-    return count;
+void on_flush_done() {
+    sched_post(EVENT_FLUSH_DONE, 0);
 }
 
 /**
- * Atualiza o display OLED com o tempo decorrido desde que o timer foi iniciado.
+ * Mostra o piso de ruído e o DC do último relatório de áudio, em contagens do ADC, e o nível
+ * do medidor acima do piso.
  */
-void update_oled_timer() {
-    absolute_time_t now = get_absolute_time();
-    int64_t elapsed_us = absolute_time_diff_us(timer_start, now); // Corrigido: usar timer_start em vez de timer_start_time
-    int elapsed_seconds = elapsed_us / 1000000;
+void print_noise_floor() {
+    printf("ruido: piso %lu.%02lu, DC %lu.%02lu contagens%s; nivel %ld dB, pico %ld dB\n",
+           (unsigned long)(audio.floor_q4 >> 4), (unsigned long)((audio.floor_q4 & 15) * 100 / 16),
+           (unsigned long)(audio.dc_q4 >> 4), (unsigned long)((audio.dc_q4 & 15) * 100 / 16),
+           audio.calibrating ? " (calibrando)" : "", (long)(audio.level_db_q8 >> 8), (long)(audio.peak_db_q8 >> 8));
+}
 
-    char timer_str[32]; // Declaração local da string do timer
-    snprintf(timer_str, sizeof(timer_str), "Time: %02d:%02d", elapsed_seconds / 60, elapsed_seconds % 60);
+/**
+ * Mostra o estado do armazenamento na flash e os últimos apitos do histórico.
+ */
+void print_history() {
+    kv_stats_t stats;
+    kv_event_t event;
+    whistle_event_t whistle;
+
+    kv_stats(&stats);
+    printf("boot %lu; flash: setor %d (seq %lu), %lu bytes livres, %u setores em uso, %lu eventos, "
+           "%lu registros interrompidos, %lu paginas e %lu setores apagados neste boot\n",
+           (unsigned long)boot_count, stats.head, (unsigned long)stats.sequence, (unsigned long)stats.free_bytes,
+           stats.sectors_used, (unsigned long)stats.events, (unsigned long)stats.corrupt_records,
+           (unsigned long)stats.page_writes, (unsigned long)stats.sector_erases);
+
+    for (uint i = 0; kv_event(i, &event); i++) {
+        if (event.type != HISTORY_WHISTLE || event.length != sizeof(whistle)) {
+            continue;
+        }
+        memcpy(&whistle, event.data, sizeof(whistle));
+        printf("apito: boot %lu, %lu:%02lu:%02lu depois de ligar, %ld dB\n", (unsigned long)whistle.boot,
+               (unsigned long)(whistle.uptime_s / 3600), (unsigned long)(whistle.uptime_s / 60 % 60),
+               (unsigned long)(whistle.uptime_s % 60), (long)(whistle.level_db_q8 >> 8));
+    }
+}
 
-    // Limpa o buffer do display
-    memset(ssd, 0, ssd1306_buffer_length);
+/**
+ * Lê a linha de comando da USB sem bloquear. Comandos: "dump" envia a última gravação;
+ * "power" mostra o ciclo de trabalho e a latência de despertar desde o último "power";
+ * "noise" mostra o piso de ruído e o DC medidos no microfone; "history" mostra os últimos
+ * apitos guardados na flash.
+ */
+void poll_console() {
+    int c;
 
-    // Desenha o tempo no display
-    ssd1306_draw_string(ssd, 5, 10, "Press B Voltar");
-    ssd1306_draw_string(ssd, 5, 20, timer_str);
+    while ((c = hal_stdio_getchar()) >= 0) {
+        if (c != '\n' && c != '\r') {
+            if (console_length < CONSOLE_LINE - 1) {
+                console_line[console_length++] = c;
+            }
+            continue;
+        }
 
-    // Renderiza o buffer no display
-    render_on_display(ssd, &frame_area);
+        console_line[console_length] = 0;
+        if (strcmp(console_line, "dump") == 0) {
+            recorder_dump_start();
+        } else if (strcmp(console_line, "power") == 0) {
+            power_report(true);
+        } else if (strcmp(console_line, "noise") == 0) {
+            print_noise_floor();
+        } else if (strcmp(console_line, "history") == 0) {
+            print_history();
+        } else if (console_length > 0) {
+            printf("Comando desconhecido: %s\n", console_line);
+        }
+        console_length = 0;
+    }
 }
 
 /**
- * Configura o display OLED.
+ * Apagar um setor pausa a captura por dezenas de ms (poll_audio): só quando ninguém está
+ * escutando nem gravando, e o joystick pode parar por esse tempo.
  */
-void setup_oled() {
-    printf("Inicializando o OLED...\n");
+bool flash_erase_ok() {
+    return recorder_state() == RECORDER_IDLE && current_state != STATE_FEIJAO_MONITOR &&
+           current_state != STATE_SPECTRUM && current_state != STATE_RECORD && !kitchen_timer_listening();
+}
 
-    // Inicialização do I2C
-    i2c_init(i2c1, ssd1306_i2c_clock * 1000);
-    gpio_set_function(I2C_SDA, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA);
-    gpio_pull_up(I2C_SCL);
+/**
+ * Consultada antes de dormir: há relatórios novos do core de áudio?
+ * Aproveita a folga para enviar um lote do rastreio pela USB, ler comandos e
+ * avançar uma etapa do gravador ou, com ele parado, das configurações na flash (o que
+ * mantém o laço acordado enquanto houver trabalho).
+ */
+bool poll_audio() {
+    trace_drain(TRACE_DRAIN_BATCH);
+    poll_console();
+    // O gravador e as configurações apagam a flash com a captura pausada (o apagamento
+    // passaria do anel do ADC)
+    bool recorder_erase = recorder_state() == RECORDER_ERASING;
+    bool kv_erase = kv_erase_pending() && flash_erase_ok();
+    audio_pause_capture(recorder_erase || kv_erase);
+    bool stopped = (recorder_erase || kv_erase) && audio_capture_stopped();
+    bool busy = recorder_poll(recorder_erase && stopped) || kv_poll(kv_erase && stopped);
+    // A latência do bloco conta desde que o core de áudio terminou de processá-lo
+    return (audio_available() && sched_post_since(EVENT_AUDIO_BLOCK, 0, audio_oldest_timestamp())) || busy;
+}
 
-    // Inicialização do display SSD1306
-    ssd1306_init();
+int main() {
+    setup_hardware();
+    
+    // Espera o primeiro bloco para ter uma leitura válida do joystick
+    while (!audio_update(&audio)) {
+        hal_wait_for_event();
+    }
 
-    // Configura a área de renderização
-    calculate_render_area_buffer_length(&frame_area);
+    power_init();
+    sched_init(handle_event);
+    sched_set_idle_hook(poll_audio);
+    ssd1306_set_flush_callback(on_flush_done);
+    hal_gpio_on_falling_edge(BUTTON_B, on_button_edge);
+    hal_gpio_on_falling_edge(JOYSTICK_SW, on_button_edge);
+    sched_tick_start(UI_TICK_MS);
 
-    // Limpa o display
-    memset(ssd, 0, ssd1306_buffer_length);
-    render_on_display(ssd, &frame_area);
-}
\ No newline at end of file
+    // Não retorna: trata eventos e dorme entre eles
+    sched_run();
+    
+    return 0;
+}
@@ -2,96 +2,122 @@
 #define __NEOPIXEL_INC
 
 #include <stdlib.h>
-#include "ws2818b.pio.h"
+#include <string.h>
+#include "hal.h"
+#include "trace.h"
 
-// Definição de pixel GRB
-struct pixel_t {
-  uint8_t G, R, B; // Três valores de 8-bits compõem um pixel.
-};
-typedef struct pixel_t pixel_t;
-typedef pixel_t npLED_t; // Mudança de nome de "struct pixel_t" para "npLED_t" por clareza.
+// Pixel GRB já no formato do fio: G nos bits 31..24, R em 23..16, B em 15..8.
+// A máquina PIO desloca para a esquerda (MSB primeiro) 24 bits por palavra,
+// então não é preciso inverter os bits de cada cor.
+typedef uint32_t npLED_t;
+#define NP_PIXEL(r, g, b) (((uint32_t)(g) << 24) | ((uint32_t)(r) << 16) | ((uint32_t)(b) << 8))
 
 
 // Declaração do buffer de pixels que formam a matriz.
 static npLED_t *leds;
 static uint led_count;
 
-// Variáveis para uso da máquina PIO.
-static PIO np_pio;
-static uint np_sm;
+// Envio por DMA: np_tx é o quadro em transmissão (e o último enviado), np_next o que espera a vez.
+static npLED_t *np_tx;
+static npLED_t *np_next;
+static bool np_tx_valid = false;
+static volatile bool np_busy = false;
+static volatile bool np_pending = false;
+static void (*np_done_callback)(void);
+
+static void npStartTransfer(void);
 
 /**
- * Inicializa a máquina PIO para controle da matriz de LEDs.
+ * Fim do sinal de RESET: o quadro foi aceito pelos LEDs. Envia o quadro pendente, se houver.
  */
-void npInit(uint pin, uint amount) {
+static void npLatchDone(void) {
+  np_busy = false;
+  TRACE_INSTANT(TRACE_LED_DONE, 0, 0);
+
+  if (np_pending) {
+    np_pending = false;
+    if (memcmp(np_tx, np_next, led_count * sizeof(npLED_t)) != 0) {
+      memcpy(np_tx, np_next, led_count * sizeof(npLED_t));
+      npStartTransfer();
+      return;
+    }
+  }
 
-  led_count = amount;
-  leds = (npLED_t *)calloc(led_count, sizeof(npLED_t));
+  if (np_done_callback)
+    np_done_callback();
+}
 
-  // Cria programa PIO.
-  uint offset = pio_add_program(pio0, &ws2818b_program);
-  np_pio = pio0;
+/**
+ * Dispara o DMA sobre np_tx (chamada com np_busy falso).
+ */
+static void npStartTransfer(void) {
+  np_busy = true;
+  np_tx_valid = true;
+  hal_leds_write_async(np_tx, led_count, npLatchDone);
+}
 
-  // Toma posse de uma máquina PIO.
-  np_sm = pio_claim_unused_sm(np_pio, false);
-  if (np_sm < 0) {
-    np_pio = pio1;
-    np_sm = pio_claim_unused_sm(np_pio, true); // Se nenhuma máquina estiver livre, panic!
-  }
+/**
+ * Inicializa a máquina PIO para controle da matriz de LEDs.
+ */
+void npInit(uint pin, uint amount) {
 
-  // Inicia programa na máquina PIO obtida.
-  ws2818b_program_init(np_pio, np_sm, offset, pin, 800000.f);
+  led_count = amount;
+  leds = (npLED_t *)calloc(led_count, sizeof(npLED_t)); // Já começa apagado.
+  np_tx = (npLED_t *)calloc(led_count, sizeof(npLED_t));
+  np_next = (npLED_t *)calloc(led_count, sizeof(npLED_t));
 
-  // Limpa buffer de pixels.
-  for (uint i = 0; i < led_count; ++i) {
-    leds[i].R = 0;
-    leds[i].G = 0;
-    leds[i].B = 0;
-  }
+  // Máquina PIO e canal de DMA que alimenta a sua FIFO, um pixel (palavra de 32 bits) por vez.
+  hal_leds_init(pin, led_count);
 }
 
 /**
  * Atribui uma cor RGB a um LED.
  */
 void npSetLED(const uint index, uint8_t r, uint8_t g, uint8_t b) {
-  
-  r = ((r & 0xF0) >> 4) | ((r & 0x0F) << 4); // Troca os 4 MSB com os 4 LSB
-  r = ((r & 0xCC) >> 2) | ((r & 0x33) << 2); // Troca pares de bits
-  r = ((r & 0xAA) >> 1) | ((r & 0x55) << 1); // Troca bits individuais
-
-  g = ((g & 0xF0) >> 4) | ((g & 0x0F) << 4); // Troca os 4 MSB com os 4 LSB
-  g = ((g & 0xCC) >> 2) | ((g & 0x33) << 2); // Troca pares de bits
-  g = ((g & 0xAA) >> 1) | ((g & 0x55) << 1); // Troca bits individuais
-
-  b = ((b & 0xF0) >> 4) | ((b & 0x0F) << 4); // Troca os 4 MSB com os 4 LSB
-  b = ((b & 0xCC) >> 2) | ((b & 0x33) << 2); // Troca pares de bits
-  b = ((b & 0xAA) >> 1) | ((b & 0x55) << 1); // Troca bits individuais
-
-  
-  leds[index].R = r;
-  leds[index].G = g;
-  leds[index].B = b;
+  leds[index] = NP_PIXEL(r, g, b);
 }
 
 /**
  * Limpa o buffer de pixels.
  */
 void npClear() {
-  for (uint i = 0; i < led_count; ++i)
-    npSetLED(i, 0, 0, 0);
+  memset(leds, 0, led_count * sizeof(npLED_t));
 }
 
 /**
- * Escreve os dados do buffer nos LEDs.
+ * Escreve os dados do buffer nos LEDs sem bloquear.
+ * Um quadro igual ao último enviado é ignorado; se um envio estiver em andamento,
+ * uma cópia do buffer é enviada assim que ele terminar (só o quadro mais recente).
  */
 void npWrite() {
-  // Escreve cada dado de 8-bits dos pixels em sequência no buffer da máquina PIO.
-  for (uint i = 0; i < led_count; ++i) {
-    pio_sm_put_blocking(np_pio, np_sm, leds[i].G);
-    pio_sm_put_blocking(np_pio, np_sm, leds[i].R);
-    pio_sm_put_blocking(np_pio, np_sm, leds[i].B);
+  TRACE_BEGIN(TRACE_LED_WRITE, 0);
+  uint32_t irq = hal_irq_save();
+
+  if (np_busy) {
+    memcpy(np_next, leds, led_count * sizeof(npLED_t));
+    np_pending = true;
+  }
+  else if (!np_tx_valid || memcmp(np_tx, leds, led_count * sizeof(npLED_t)) != 0) {
+    memcpy(np_tx, leds, led_count * sizeof(npLED_t));
+    npStartTransfer();
   }
-  sleep_us(100); // Espera 100us, sinal de RESET do datasheet.
+
+  hal_irq_restore(irq);
+  TRACE_END(TRACE_LED_WRITE, np_busy);
+}
+
+/**
+ * Indica se ainda há um quadro sendo enviado (ou esperando o RESET).
+ */
+bool npIsBusy() {
+  return np_busy;
+}
+
+/**
+ * Define uma função chamada (em contexto de interrupção) quando os LEDs terminam de receber um quadro.
+ */
+void npSetDoneCallback(void (*callback)(void)) {
+  np_done_callback = callback;
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,55 @@
+# Telas do OLED de referência (tests/golden/<nome>.pbm) contra a simulação da aplicação.
+#
+# cmake -DSIM=<microphone_dma_sim> -DOUT=<dir> -DGOLDEN=<dir> -DENV="VAR=valor|..." -DFRAMES="nome:ms|..." -P golden.cmake
+#
+# Roda a simulação com o roteiro de ENV e compara, para cada nome:ms, o quadro que estava na
+# tela no instante ms (o último gravado até ali). Com SACD_GOLDEN_UPDATE=1 no ambiente, grava
+# os quadros como as novas referências em vez de comparar.
+
+string(REPLACE "|" ";" env "${ENV}")
+string(REPLACE "|" ";" frames "${FRAMES}")
+
+file(REMOVE_RECURSE ${OUT})
+file(MAKE_DIRECTORY ${OUT})
+execute_process(COMMAND ${CMAKE_COMMAND} -E env SACD_OUT=${OUT} ${env} ${SIM}
+                RESULT_VARIABLE result OUTPUT_QUIET)
+if (NOT result EQUAL 0)
+    message(FATAL_ERROR "a simulação terminou com ${result}")
+endif()
+
+file(GLOB written RELATIVE ${OUT} ${OUT}/oled_*.pbm)
+list(SORT written)
+
+set(failed "")
+foreach(frame ${frames})
+    string(REPLACE ":" ";" frame ${frame})
+    list(GET frame 0 name)
+    list(GET frame 1 ms)
+
+    set(shown "")
+    foreach(file ${written})
+        string(REGEX REPLACE "^oled_([0-9]+)\\.pbm$" "\\1" t ${file})
+        if (t LESS_EQUAL ms)
+            set(shown ${file})
+        endif()
+    endforeach()
+    if (NOT shown)
+        message(FATAL_ERROR "${name}: nenhum quadro até ${ms} ms")
+    endif()
+
+    if ("$ENV{SACD_GOLDEN_UPDATE}")
+        configure_file(${OUT}/${shown} ${GOLDEN}/${name}.pbm COPYONLY)
+        message(STATUS "${name}: ${shown}")
+        continue()
+    endif()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E compare_files ${GOLDEN}/${name}.pbm ${OUT}/${shown}
+                    RESULT_VARIABLE different)
+    if (different)
+        message(SEND_ERROR "${name}: ${OUT}/${shown} difere de ${GOLDEN}/${name}.pbm")
+        set(failed TRUE)
+    endif()
+endforeach()
+
+if (NOT failed)
+    message("ok")
+endif()
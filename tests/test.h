@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hal.h"
+
+#ifndef test_inc_h
+#define test_inc_h
+
+// Asserções dos testes no host (ctest). A primeira que falha diz onde e encerra com erro; o
+// teste só passa se imprimir "ok" no fim (a HAL do host também encerra o processo com 0,
+// p. ex. quando o tempo virtual acaba, e isso não pode contar como sucesso).
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: falhou: %s\n", __FILE__, __LINE__, #cond); \
+            exit(1); \
+        } \
+    } while (0)
+
+// Com uma mensagem no estilo do printf, para mostrar os valores envolvidos
+#define CHECK_MSG(cond, ...) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: falhou: %s: ", __FILE__, __LINE__, #cond); \
+            fprintf(stderr, __VA_ARGS__); \
+            fputc('\n', stderr); \
+            exit(1); \
+        } \
+    } while (0)
+
+#define TEST_OK() \
+    do { \
+        printf("ok\n"); \
+        return 0; \
+    } while (0)
+
+// Grava um WAV mono de 16 bits para a HAL do host tocar no microfone (SACD_WAV)
+static inline void test_write_wav(const char *path, const int16_t *samples, uint32_t count, uint32_t rate) {
+    FILE *f = fopen(path, "wb");
+    uint8_t header[44];
+    const uint32_t fields[][2] = { // Posição e valor (little-endian) dos campos numéricos
+        { 4, 36 + 2 * count }, { 16, 16 }, { 20, 1 | (1u << 16) }, { 24, rate },
+        { 28, 2 * rate }, { 32, 2 | (16u << 16) }, { 40, 2 * count },
+    };
+
+    CHECK(f != NULL);
+    memcpy(header, "RIFF....WAVEfmt ", 16);
+    memcpy(header + 36, "data", 4);
+    for (uint i = 0; i < sizeof(fields) / sizeof(fields[0]); i++) {
+        for (uint b = 0; b < 4; b++) {
+            header[fields[i][0] + b] = fields[i][1] >> (8 * b);
+        }
+    }
+    fwrite(header, 1, sizeof(header), f);
+    for (uint32_t i = 0; i < count; i++) {
+        uint8_t le[2] = { (uint8_t)samples[i], (uint8_t)((uint16_t)samples[i] >> 8) };
+        fwrite(le, 1, 2, f);
+    }
+    fclose(f);
+}
+
+// Duração em ms de um WAV PCM (p. ex. uma gravação de tests/fixtures), para tocá-lo até o fim
+static inline uint32_t test_wav_ms(const char *path) {
+    FILE *f = fopen(path, "rb");
+    uint8_t chunk[8], fmt[16];
+    uint32_t rate = 0, frame_bytes = 0, ms = 0;
+
+    CHECK_MSG(f != NULL, "%s", path);
+    fseek(f, 12, SEEK_SET); // "RIFF", tamanho, "WAVE"
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = chunk[4] | chunk[5] << 8 | chunk[6] << 16 | (uint32_t)chunk[7] << 24;
+        if (!memcmp(chunk, "fmt ", 4) && size >= 16 && fread(fmt, 1, 16, f) == 16) {
+            rate = fmt[4] | fmt[5] << 8 | fmt[6] << 16 | (uint32_t)fmt[7] << 24;
+            frame_bytes = fmt[12] | fmt[13] << 8;
+            size -= 16;
+        }
+        else if (!memcmp(chunk, "data", 4)) {
+            CHECK_MSG(rate > 0 && frame_bytes > 0, "%s: WAV sem formato", path);
+            ms = (uint64_t)size / frame_bytes * 1000 / rate;
+            break;
+        }
+        fseek(f, size + (size & 1), SEEK_CUR);
+    }
+    fclose(f);
+    CHECK_MSG(ms > 0, "%s: WAV vazio", path);
+    return ms;
+}
+
+#endif
@@ -0,0 +1,217 @@
+#include "test.h"
+#include "neopixel.c"
+#include "ssd1306.h"
+
+// O que sai para o hardware, palavra por palavra, com uma HAL falsa que só guarda o que
+// recebe (este teste não liga inc/hal_host.c).
+//
+// LEDs: o pixel é uma palavra G<<24 | R<<16 | B<<8 que a máquina PIO desloca para a esquerda,
+// 24 bits. O fio tem que ser igual ao do formato antigo (três bytes G, R, B com os bits
+// invertidos, deslocados para a direita com autopull de 8 bits) para todas as 2^24 cores.
+//
+// OLED: a sequência para IC_DATA_CMD tem a transação de comandos (controle 0x00, STOP no
+// último comando) seguida da de dados (controle 0x40, STOP no último byte), uma palavra por
+// byte e nenhum outro bit ligado.
+
+static uint16_t i2c_words[2048];
+static uint i2c_count;
+static void (*i2c_done)(bool ok);
+static uint32_t led_words[32];
+static uint led_count_sent;
+static void (*leds_done)(void);
+
+// ---------------------------------------------------------------------------
+// HAL falsa
+
+uint64_t hal_time_us(void) {
+    return 0;
+}
+
+uint32_t hal_irq_save(void) {
+    return 0;
+}
+
+void hal_irq_restore(uint32_t state) {
+    (void)state;
+}
+
+uint hal_core_num(void) {
+    return 0;
+}
+
+// Os envios terminam quando alguém espera por eles
+void hal_wait_for_event(void) {
+    if (i2c_done) {
+        void (*done)(bool) = i2c_done;
+        i2c_done = NULL;
+        done(true);
+    }
+    if (leds_done) {
+        void (*done)(void) = leds_done;
+        leds_done = NULL;
+        done();
+    }
+}
+
+int hal_i2c_write(uint bus, uint8_t address, const uint8_t *data, size_t length) {
+    (void)bus;
+    (void)address;
+    (void)data;
+    return length;
+}
+
+bool hal_i2c_write_async(uint bus, uint8_t address, const uint16_t *words, uint count, void (*done)(bool ok)) {
+    CHECK(bus == ssd1306_i2c_bus && address == ssd1306_i2c_address);
+    CHECK(count <= count_of(i2c_words));
+    memcpy(i2c_words, words, count * sizeof(words[0]));
+    i2c_count = count;
+    i2c_done = done;
+    return true;
+}
+
+void hal_leds_init(uint gpio, uint count) {
+    (void)gpio;
+    (void)count;
+}
+
+void hal_leds_write_async(const uint32_t *words, uint count, void (*done)(void)) {
+    CHECK(count <= count_of(led_words));
+    memcpy(led_words, words, count * sizeof(words[0]));
+    led_count_sent = count;
+    leds_done = done;
+}
+
+// ---------------------------------------------------------------------------
+// LEDs
+
+static uint8_t reverse_bits(uint8_t v) {
+    v = ((v & 0xF0) >> 4) | ((v & 0x0F) << 4);
+    v = ((v & 0xCC) >> 2) | ((v & 0x33) << 2);
+    v = ((v & 0xAA) >> 1) | ((v & 0x55) << 1);
+    return v;
+}
+
+// Fio do formato antigo: 24 bits na ordem de envio (o primeiro no bit 23)
+static uint32_t wire_legacy(uint8_t r, uint8_t g, uint8_t b) {
+    const uint8_t bytes[3] = { reverse_bits(g), reverse_bits(r), reverse_bits(b) };
+    uint32_t bits = 0;
+
+    for (uint i = 0; i < 3; i++) {
+        uint8_t osr = bytes[i];
+        for (uint bit = 0; bit < 8; bit++) {
+            bits = (bits << 1) | (osr & 1); // Deslocamento para a direita: sai o LSB
+            osr >>= 1;
+        }
+    }
+    return bits;
+}
+
+// Fio do formato atual: a máquina desloca a palavra para a esquerda, 24 bits
+static uint32_t wire_word(uint32_t word) {
+    uint32_t bits = 0;
+
+    for (uint bit = 0; bit < 24; bit++) {
+        bits = (bits << 1) | (word >> 31); // Deslocamento para a esquerda: sai o MSB
+        word <<= 1;
+    }
+    return bits;
+}
+
+static void test_leds(void) {
+    for (uint32_t rgb = 0; rgb < (1u << 24); rgb++) {
+        uint8_t r = rgb >> 16, g = rgb >> 8, b = rgb;
+        uint32_t word = NP_PIXEL(r, g, b);
+
+        CHECK_MSG((word & 0xFF) == 0, "%06x: bits 7..0 ligados", rgb);
+        CHECK_MSG(wire_word(word) == wire_legacy(r, g, b), "%06x: fio %06x, esperava %06x", rgb, wire_word(word), wire_legacy(r, g, b));
+    }
+
+    // As palavras entregues ao DMA são as do buffer, sem conversão
+    npInit(7, 25);
+    for (uint i = 0; i < 25; i++) {
+        npSetLED(i, i, 100 + i, 200 + i);
+    }
+    npWrite();
+    CHECK(led_count_sent == 25);
+    for (uint i = 0; i < 25; i++) {
+        CHECK(led_words[i] == ((100u + i) << 24 | i << 16 | (200u + i) << 8));
+    }
+
+    // npClear zera o quadro inteiro
+    hal_wait_for_event();
+    npClear();
+    npWrite();
+    for (uint i = 0; i < 25; i++) {
+        CHECK(led_words[i] == 0);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// OLED
+
+// Confere a sequência de um envio do retângulo x_0..x_1, page_0..page_1 de 'ssd'
+static void check_flush(const uint8_t *ssd, uint x_0, uint x_1, uint page_0, uint page_1) {
+    const uint16_t commands[] = { 0x21, x_0, x_1, 0x22, page_0, page_1 };
+    uint width = x_1 - x_0 + 1;
+    uint data = 2 + count_of(commands);
+
+    CHECK_MSG(i2c_count == data + width * (page_1 - page_0 + 1), "%u palavras", i2c_count);
+    for (uint i = 0; i < i2c_count; i++) {
+        CHECK_MSG((i2c_words[i] & ~(0xFFu | HAL_I2C_STOP)) == 0, "palavra %u: %03x", i, i2c_words[i]);
+        bool stop = i == count_of(commands) || i == i2c_count - 1;
+        CHECK_MSG(!(i2c_words[i] & HAL_I2C_STOP) == !stop, "STOP na palavra %u", i);
+    }
+
+    CHECK(i2c_words[0] == 0x00); // Co = 0, D/C# = 0: o resto da transação são comandos
+    for (uint i = 0; i < count_of(commands); i++) {
+        CHECK_MSG((i2c_words[1 + i] & 0xFF) == commands[i], "comando %u: %02x", i, i2c_words[1 + i] & 0xFF);
+    }
+    CHECK(i2c_words[data - 1] == 0x40); // Co = 0, D/C# = 1: o resto são dados
+    for (uint page = page_0; page <= page_1; page++) {
+        for (uint x = x_0; x <= x_1; x++) {
+            uint i = data + (page - page_0) * width + x - x_0;
+            CHECK_MSG((i2c_words[i] & 0xFF) == ssd[page * ssd1306_width + x], "página %u, coluna %u", page, x);
+        }
+    }
+}
+
+static void test_oled(void) {
+    static uint8_t ssd[ssd1306_buffer_length];
+
+    ssd1306_init();
+    for (uint i = 0; i < ssd1306_buffer_length; i++) {
+        ssd[i] = i * 7;
+    }
+    ssd1306_invalidate();
+
+    // Tela inteira (o display começa desconhecido)
+    CHECK(ssd1306_flush(ssd));
+    check_flush(ssd, 0, ssd1306_width - 1, 0, ssd1306_n_pages - 1);
+    ssd1306_flush_wait();
+
+    // Um pixel: uma coluna de uma página
+    ssd1306_set_pixel(ssd, 10, 20, !(ssd[2 * ssd1306_width + 10] & (1 << 4)));
+    CHECK(ssd1306_flush(ssd));
+    check_flush(ssd, 10, 10, 2, 2);
+    ssd1306_flush_wait();
+
+    // Dois pixels em páginas e colunas diferentes: o retângulo que cobre os dois
+    ssd1306_set_pixel(ssd, 100, 8, !(ssd[1 * ssd1306_width + 100] & 0x01));
+    ssd1306_set_pixel(ssd, 30, 47, !(ssd[5 * ssd1306_width + 30] & 0x80));
+    CHECK(ssd1306_flush(ssd));
+    check_flush(ssd, 30, 100, 1, 5);
+    ssd1306_flush_wait();
+
+    // Redesenhado igual: marcado, mas descartado pela cópia do que está no display
+    ssd1306_clear(ssd);
+    ssd1306_flush(ssd);
+    ssd1306_flush_wait();
+    ssd1306_clear(ssd);
+    CHECK(!ssd1306_flush(ssd));
+}
+
+int main(void) {
+    test_leds();
+    test_oled();
+    TEST_OK();
+}
@@ -0,0 +1,153 @@
+#include <math.h>
+#include "test.h"
+#include "decimator.h"
+
+// Resposta em frequência do decimador (CIC + FIR) medida com senoides na taxa do ADC,
+// comparada com a do projeto (tools/decimator_design.py) calculada aqui em double: na banda
+// passante o ganho fica em 1 dentro de poucos centésimos de dB e o que dobraria para dentro
+// dela chega atenuado. A amplitude de saída sai do ajuste de seno e cosseno na frequência
+// que a entrada assume depois da decimação, sobre um número inteiro de períodos.
+
+#define RATE 16000
+#define ADC_RATE (RATE * DECIMATOR_RATIO)
+#define AMPLITUDE 1800.0 // Contagens do ADC em torno do meio da escala
+#define SETTLE 64 // Saídas descartadas (transiente do CIC e do FIR)
+#define PASS_HZ 6000 // Banda corrigida do CIC
+#define PASS_TOLERANCE_DB 0.05
+#define STOP_MIN_DB 45.0 // Rejeição mínima do que cai dentro da banda passante
+
+// Coeficientes em Q15 de inc/decimator.c, para o cálculo do ganho esperado
+#if DECIMATOR_CIC_RATIO == 4
+static const int16_t fir[DECIMATOR_FIR_TAPS] = {
+    -19, 15, 92, -37, -258, 64, 583, -82, -1165, 56, 2204, 131,
+    -4326, -1159, 11082, 18414, 11082, -1159, -4326, 131, 2204, 56, -1165, -82,
+    583, 64, -258, -37, 92, 15, -19,
+};
+#else
+static const int16_t fir[DECIMATOR_FIR_TAPS] = {
+    -19, 15, 93, -37, -263, 64, 594, -82, -1186, 51, 2243, 150,
+    -4393, -1235, 11123, 18537, 11123, -1235, -4393, 150, 2243, 51, -1186, -82,
+    594, 64, -263, -37, 93, 15, -19,
+};
+#endif
+
+static uint16_t input[(RATE + SETTLE) * DECIMATOR_RATIO];
+static uint16_t output[RATE + SETTLE];
+
+// Ganho do CIC e do FIR, como em tools/decimator_design.py
+static double expected_gain(double f) {
+    double x = M_PI * f / ADC_RATE;
+    double cic = x == 0 ? 1 : pow(fabs(sin(DECIMATOR_CIC_RATIO * x) / (DECIMATOR_CIC_RATIO * sin(x))), DECIMATOR_CIC_ORDER);
+    double w = 2 * M_PI * f / (2 * RATE);
+    double h = fir[DECIMATOR_FIR_TAPS / 2];
+
+    for (uint k = 1; k <= DECIMATOR_FIR_TAPS / 2; k++) {
+        h += 2 * fir[DECIMATOR_FIR_TAPS / 2 + k] * cos(k * w);
+    }
+    return cic * fabs(h) / 32768;
+}
+
+// Frequência que 'f' assume na saída, entre 0 e RATE / 2
+static uint32_t alias_hz(uint32_t f) {
+    f %= RATE;
+    return f > RATE / 2 ? RATE - f : f;
+}
+
+// Decima uma senoide de 'f' Hz em pedaços de 'chunk' amostras e devolve o ganho medido
+static double measure(uint32_t f, uint32_t chunk) {
+    decimator_t dec;
+    uint32_t count = count_of(input), produced = 0;
+
+    for (uint32_t n = 0; n < count; n++) {
+        input[n] = (uint16_t)lround(2048 + AMPLITUDE * sin(2 * M_PI * (double)((uint64_t)f * n % ADC_RATE) / ADC_RATE));
+    }
+    decimator_init(&dec);
+    for (uint32_t n = 0; n < count; n += chunk) {
+        uint32_t length = count - n < chunk ? count - n : chunk;
+        produced += decimator_process(&dec, input + n, length, 1, output + produced);
+    }
+    CHECK_MSG(produced == count_of(output), "%u saídas para %u entradas", produced, count);
+
+    // Um segundo de saída: período inteiro para qualquer frequência inteira
+    double fa = alias_hz(f), re = 0, im = 0;
+    for (uint32_t n = 0; n < RATE; n++) {
+        double v = output[SETTLE + n] - 2048.0;
+        re += v * cos(2 * M_PI * fa * n / RATE);
+        im += v * sin(2 * M_PI * fa * n / RATE);
+    }
+    double amplitude = (fa == 0 || fa == RATE / 2 ? 1.0 : 2.0) * hypot(re, im) / RATE;
+    return amplitude / AMPLITUDE;
+}
+
+static double db(double gain) {
+    return 20 * log10(gain);
+}
+
+static void test_passband(void) {
+    for (uint32_t f = 100; f <= PASS_HZ; f += 100) {
+        double gain = measure(f, 4096);
+        CHECK_MSG(fabs(db(gain)) <= PASS_TOLERANCE_DB, "%u Hz: %+.3f dB", f, db(gain));
+        CHECK_MSG(fabs(db(gain) - db(expected_gain(f))) <= 0.02, "%u Hz: %+.3f dB, projeto %+.3f dB", f, db(gain), db(expected_gain(f)));
+    }
+}
+
+static void test_stopband(void) {
+    // Tudo o que cai em 0..PASS_HZ depois da decimação, até a metade da taxa do ADC
+    for (uint32_t f = RATE - PASS_HZ; f < ADC_RATE / 2; f += 250) {
+        if (alias_hz(f) > PASS_HZ || alias_hz(f) == 0) {
+            continue;
+        }
+        double gain = measure(f, 4096);
+        CHECK_MSG(db(gain) <= -STOP_MIN_DB, "%u Hz (em %u Hz): %.1f dB", f, alias_hz(f), db(gain));
+    }
+}
+
+// O estado passa de um pedaço para o outro, qualquer que seja o tamanho; o passo tira um
+// canal de uma captura intercalada
+static void test_chunks_and_stride(void) {
+    static uint16_t whole[count_of(output)];
+    static uint16_t interleaved[3 * count_of(input)];
+    decimator_t dec;
+
+    measure(1000, count_of(input));
+    memcpy(whole, output, sizeof(whole));
+    for (uint32_t chunk = 1; chunk <= 777; chunk = chunk * 3 + 1) {
+        measure(1000, chunk);
+        CHECK_MSG(memcmp(whole, output, sizeof(whole)) == 0, "pedaços de %u amostras", chunk);
+    }
+
+    for (uint32_t n = 0; n < count_of(input); n++) {
+        interleaved[3 * n] = 0;
+        interleaved[3 * n + 1] = input[n];
+        interleaved[3 * n + 2] = 4095;
+    }
+    decimator_init(&dec);
+    CHECK(decimator_process(&dec, interleaved + 1, count_of(input), 3, output) == count_of(output));
+    CHECK(memcmp(whole, output, sizeof(whole)) == 0);
+}
+
+// Entrada constante sai igual, inclusive nos extremos da escala
+static void test_dc(void) {
+    static const uint16_t levels[] = { 0, 1, 2047, 2048, 3000, 4094, 4095 };
+
+    for (uint i = 0; i < count_of(levels); i++) {
+        decimator_t dec;
+
+        for (uint32_t n = 0; n < count_of(input); n++) {
+            input[n] = levels[i];
+        }
+        decimator_init(&dec);
+        decimator_process(&dec, input, count_of(input), 1, output);
+        for (uint32_t n = SETTLE; n < count_of(output); n++) {
+            CHECK_MSG(abs((int)output[n] - levels[i]) <= 1, "nível %u: saída %u", levels[i], output[n]);
+        }
+    }
+}
+
+int main(void) {
+    test_passband();
+    test_stopband();
+    test_chunks_and_stride();
+    test_dc();
+    TEST_OK();
+}
@@ -0,0 +1,125 @@
+#include <math.h>
+#include "test.h"
+#include "fft.h"
+
+// FFT em ponto fixo contra uma DFT em double. fft_q15 devolve X[k] / N; o erro de cada ponto
+// vem do arredondamento das tabelas e do deslocamento de cada estágio, e cresce com o número
+// de estágios, não com a amplitude. Confere também a janela e o log2 em Q4.
+
+#define TOLERANCE_LSB(log2n) (1.0 + (log2n)) // Erro máximo por ponto, em LSB de Q15: ~1 por estágio
+
+static uint32_t rand_state = 2463534242u;
+
+static int16_t rand_q15(int32_t amplitude) {
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return (int16_t)((int32_t)(rand_state % (2 * amplitude + 1)) - amplitude);
+}
+
+// DFT direta, já dividida por N como a fft_q15
+static void dft_reference(const fft_complex_t *in, double *re, double *im, uint32_t n) {
+    for (uint32_t k = 0; k < n; k++) {
+        double sr = 0, si = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            double a = -2 * M_PI * (double)((uint64_t)k * i % n) / n;
+            sr += in[i].re * cos(a) - in[i].im * sin(a);
+            si += in[i].re * sin(a) + in[i].im * cos(a);
+        }
+        re[k] = sr / n;
+        im[k] = si / n;
+    }
+}
+
+// Transforma 'in' e devolve o maior erro contra a referência, em LSB
+static double fft_error(const fft_complex_t *in, uint32_t log2n) {
+    static fft_complex_t data[FFT_SIZE];
+    static double re[FFT_SIZE], im[FFT_SIZE];
+    uint32_t n = 1u << log2n;
+    double worst = 0;
+
+    memcpy(data, in, n * sizeof(data[0]));
+    fft_q15(data, log2n);
+    dft_reference(in, re, im, n);
+    for (uint32_t k = 0; k < n; k++) {
+        double e = hypot(data[k].re - re[k], data[k].im - im[k]);
+        if (e > worst) {
+            worst = e;
+        }
+    }
+    return worst;
+}
+
+static void test_transform(void) {
+    static fft_complex_t in[FFT_SIZE];
+
+    for (uint32_t log2n = 1; log2n <= FFT_LOG2_SIZE; log2n++) {
+        uint32_t n = 1u << log2n;
+
+        // Ruído em escala cheia, complexo
+        for (uint trial = 0; trial < 8; trial++) {
+            for (uint32_t i = 0; i < n; i++) {
+                in[i].re = rand_q15(32767);
+                in[i].im = rand_q15(32767);
+            }
+            double e = fft_error(in, log2n);
+            CHECK_MSG(e <= TOLERANCE_LSB(log2n), "N = %u, ruído: erro de %.2f LSB", n, e);
+        }
+
+        // Tom real no centro de um ponto e entre dois pontos
+        for (uint half_bins = 2; half_bins <= 3; half_bins++) {
+            for (uint32_t i = 0; i < n; i++) {
+                in[i].re = (int16_t)lround(30000 * cos(M_PI * half_bins * i / n));
+                in[i].im = 0;
+            }
+            double e = fft_error(in, log2n);
+            CHECK_MSG(e <= TOLERANCE_LSB(log2n), "N = %u, tom em %u/2: erro de %.2f LSB", n, half_bins, e);
+        }
+
+        // Impulso e constante: resultados exatos conhecidos
+        memset(in, 0, sizeof(in));
+        in[0].re = 32767;
+        double e = fft_error(in, log2n);
+        CHECK_MSG(e <= TOLERANCE_LSB(log2n), "N = %u, impulso: erro de %.2f LSB", n, e);
+        for (uint32_t i = 0; i < n; i++) {
+            in[i].re = -20000;
+        }
+        e = fft_error(in, log2n);
+        CHECK_MSG(e <= TOLERANCE_LSB(log2n), "N = %u, constante: erro de %.2f LSB", n, e);
+    }
+}
+
+static void test_window(void) {
+    static uint16_t samples[FFT_SIZE];
+    static fft_complex_t out[FFT_SIZE];
+    const uint32_t dc = 2048;
+
+    for (uint i = 0; i < FFT_SIZE; i++) {
+        samples[i] = (uint16_t)(dc + rand_q15(2047));
+    }
+    fft_load_hann(out, samples, dc);
+    for (uint i = 0; i < FFT_SIZE; i++) {
+        double w = 0.5 * (1 - cos(2 * M_PI * i / (FFT_SIZE - 1)));
+        double expected = ((int32_t)samples[i] - (int32_t)dc) * 16 * w;
+        CHECK_MSG(fabs(out[i].re - expected) <= 2 && out[i].im == 0, "amostra %u: %d, esperava %.1f", i, out[i].re, expected);
+    }
+}
+
+static void test_log2(void) {
+    CHECK(fft_log2_q4(0) == 0 && fft_log2_q4(1) == 0);
+    for (uint32_t e = 1; e < 32; e++) {
+        CHECK(fft_log2_q4(1u << e) == e << 4); // Potências de 2 são exatas
+    }
+    // A mantissa linear erra no máximo 0,086 oitava, mais 1/16 do truncamento
+    for (uint32_t x = 2; x < 0x7FFFFFFFu; x += x / 97 + 1) {
+        double e = fft_log2_q4(x) / 16.0 - log2(x);
+        CHECK_MSG(e <= 0 && e > -(0.087 + 1 / 16.0), "log2(%u): %.3f", x, fft_log2_q4(x) / 16.0);
+    }
+}
+
+int main(void) {
+    test_transform();
+    test_window();
+    test_log2();
+    TEST_OK();
+}
@@ -0,0 +1,295 @@
+#include <sys/wait.h>
+#include <unistd.h>
+#include "test.h"
+#include "kvstore.h"
+
+// Falta de energia ao acaso sobre a flash simulada da HAL do host. Cada rodada é um boot: um
+// processo escreve valores e eventos, chamando kv_poll com e sem permissão de apagar, até
+// SACD_FLASH_CUT interromper uma operação da flash no meio; outro processo sobe sobre o mesmo
+// SACD_FLASH e confere o que ficou. O escritor anota num log o que fez: "C" quando nada está
+// pendente (o que está ali tem de sobreviver), "S" a cada valor e "E" a cada evento depois
+// disso (podem ou não ter chegado à flash). A flash passa de uma rodada para a seguinte.
+//
+// Depois, um caso dirigido que o acaso quase nunca monta: a cabeça terminou num registro
+// interrompido, não recebe mais nada, e o setor seguinte tem a única cópia de uma chave.
+// Preparar esse setor não pode apagá-lo, com a energia caindo em qualquer ponto.
+
+#define ROUNDS 300
+#define KEYS 6 // A última muda só de vez em quando e fica num setor antigo
+#define RARE_ROUNDS 50 // Rodadas entre duas mudanças da última chave
+#define LISTEN_ROUNDS 4 // Uma rodada em quantas não deixa apagar nada (escuta)
+#define SHORT_CUT 8 // Metade das rodadas corta logo depois do boot, na recuperação
+#define EVENT_TYPE 1
+#define MAX_OPS 1200 // Operações de um escritor
+#define MAX_CUT 900 // Operação da flash interrompida, ao acaso até aqui
+#define FLASH_PATH "test_kvstore.bin"
+#define LOG_PATH "test_kvstore.log"
+#define FULL_PATH "test_kvstore_full.bin" // Caso dirigido: antes da recuperação
+#define RECOVERY_PATH "test_kvstore_recovery.bin"
+#define FULL_CUTS 6 // Operações da recuperação em que a energia cai
+#define FULL_KEY 3
+#define FULL_VALUE 0x600dbeefu
+#define FULL_SEED 8 // Semente de SACD_FLASH_CUT que deixa o registro interrompido inválido
+
+static uint32_t rand_state;
+
+static uint32_t rand_next(void) {
+    rand_state ^= rand_state << 13;
+    rand_state ^= rand_state >> 17;
+    rand_state ^= rand_state << 5;
+    return rand_state;
+}
+
+// Eventos carregam um contador que só cresce; 0 se o histórico está vazio
+static uint32_t newest_event(void) {
+    kv_event_t event;
+    uint32_t count = 0;
+
+    if (kv_event(0, &event)) {
+        memcpy(&count, event.data, sizeof(count));
+    }
+    return count;
+}
+
+static void log_commit(FILE *log, const uint32_t *values, uint32_t events) {
+    fprintf(log, "C");
+    for (uint k = 0; k < KEYS; k++) {
+        fprintf(log, " %u", values[k]);
+    }
+    fprintf(log, " %u\n", events);
+    fflush(log);
+}
+
+static void writer(uint32_t round) {
+    FILE *log = fopen(LOG_PATH, "w");
+    uint32_t values[KEYS];
+
+    CHECK(log != NULL);
+    hal_stdio_init();
+    kv_init();
+    for (uint k = 0; k < KEYS; k++) {
+        if (!kv_get(k, &values[k], sizeof(values[k]))) {
+            values[k] = 0;
+        }
+    }
+    uint32_t events = newest_event();
+    log_commit(log, values, events);
+
+    uint32_t ops = MAX_OPS / 3 + rand_next() % MAX_OPS;
+    for (uint32_t i = 0; i < ops; i++) {
+        uint32_t op = rand_next() % 10;
+        if (op < 4) {
+            uint k = i == 0 && round % RARE_ROUNDS == 1 ? KEYS - 1 : rand_next() % (KEYS - 1);
+            values[k] = round << 16 | i;
+            kv_set(k, &values[k], sizeof(values[k]));
+            fprintf(log, "S %u %u\n", k, values[k]);
+        }
+        else if (op < 8) {
+            uint32_t next = events + 1;
+            if (kv_log_event(EVENT_TYPE, &next, sizeof(next))) {
+                events = next;
+                fprintf(log, "E %u\n", events);
+            }
+        }
+        fflush(log);
+
+        // Às vezes a aplicação não deixa apagar, às vezes deixa o laço rodar mais
+        bool erase_ok = round % LISTEN_ROUNDS != 0 && rand_next() % 10 < 7;
+        for (uint polls = 1 + rand_next() % 3; polls > 0; polls--) {
+            kv_poll(erase_ok);
+        }
+        if (!kv_pending()) {
+            log_commit(log, values, events);
+        }
+    }
+    while (kv_poll(true)) {
+    }
+    CHECK(!kv_pending());
+    log_commit(log, values, events);
+    fclose(log);
+    exit(0);
+}
+
+static void verify(uint32_t round) {
+    static uint32_t later[KEYS][MAX_OPS]; // Valores escritos depois do último "C"
+    uint32_t committed[KEYS] = { 0 }, later_count[KEYS] = { 0 };
+    uint32_t committed_events = 0, last_event = 0;
+    FILE *log = fopen(LOG_PATH, "r");
+    char line[128];
+
+    CHECK(log != NULL);
+    while (fgets(line, sizeof(line), log)) {
+        if (line[0] == 'C') {
+            char *p = line + 1;
+            for (uint k = 0; k < KEYS; k++) {
+                committed[k] = strtoul(p, &p, 10);
+                later_count[k] = 0;
+            }
+            committed_events = last_event = strtoul(p, NULL, 10);
+        }
+        else if (line[0] == 'S') {
+            uint k;
+            uint32_t value;
+            CHECK(sscanf(line + 1, "%u %u", &k, &value) == 2 && k < KEYS);
+            later[k][later_count[k]++] = value;
+        }
+        else if (line[0] == 'E') {
+            last_event = strtoul(line + 1, NULL, 10);
+        }
+    }
+    fclose(log);
+
+    hal_stdio_init();
+    kv_init();
+    for (uint k = 0; k < KEYS; k++) {
+        uint32_t value;
+        if (!kv_get(k, &value, sizeof(value))) {
+            value = 0;
+        }
+        bool known = value == committed[k];
+        for (uint32_t i = 0; i < later_count[k]; i++) {
+            known |= value == later[k][i];
+        }
+        CHECK_MSG(known, "rodada %u, chave %u: %u, gravado %u", round, k, value, committed[k]);
+    }
+
+    // O histórico tem tudo até o último "C" e está em ordem
+    uint32_t newest = newest_event();
+    CHECK_MSG(newest >= committed_events && newest <= last_event, "rodada %u: último evento %u, gravado %u, escrito %u",
+              round, newest, committed_events, last_event);
+    kv_event_t event;
+    uint32_t previous = UINT32_MAX;
+    for (uint i = 0; kv_event(i, &event); i++) {
+        uint32_t count;
+        CHECK(event.type == EVENT_TYPE && event.length == sizeof(count));
+        memcpy(&count, event.data, sizeof(count));
+        CHECK_MSG(count < previous, "rodada %u: evento %u depois do %u", round, count, previous);
+        previous = count;
+    }
+    exit(0);
+}
+
+// Enche o anel até a cabeça chegar ao último setor e continua nela sem apagar: o primeiro
+// setor, o seguinte à cabeça, fica com a única cópia de FULL_KEY
+static void fill_ring(uint32_t unused) {
+    uint32_t value = FULL_VALUE, count = 0;
+    kv_stats_t stats;
+
+    (void)unused;
+    hal_stdio_init();
+    kv_init();
+    kv_set(FULL_KEY, &value, sizeof(value));
+    do {
+        count++;
+        CHECK(kv_log_event(EVENT_TYPE, &count, sizeof(count)));
+        do {
+            kv_stats(&stats);
+        } while (kv_poll(stats.head != KV_SECTORS - 1));
+    } while (stats.head != KV_SECTORS - 1 || stats.free_bytes > HAL_FLASH_SECTOR_SIZE / 2);
+    exit(0);
+}
+
+// Um evento a mais, com a energia caindo no meio da gravação dele
+static void cut_head(uint32_t unused) {
+    uint32_t count = UINT32_MAX;
+
+    (void)unused;
+    hal_stdio_init();
+    kv_init();
+    CHECK(kv_log_event(EVENT_TYPE, &count, sizeof(count)));
+    kv_poll(false);
+    CHECK_MSG(false, "a gravação não foi interrompida");
+}
+
+// Boot sobre a cabeça interrompida, com apagamento permitido, até a energia cair
+static void recover(uint32_t cut) {
+    kv_stats_t stats;
+    uint32_t value;
+
+    hal_stdio_init();
+    kv_init();
+    kv_stats(&stats);
+    CHECK_MSG(stats.head == KV_SECTORS - 1 && stats.free_bytes == 0 && stats.corrupt_records == 1, "head %d free %u corrupt %u", stats.head, stats.free_bytes, stats.corrupt_records);
+    CHECK(kv_get(FULL_KEY, &value, sizeof(value)) && value == FULL_VALUE);
+    CHECK(kv_erase_pending());
+    for (uint i = 0; i < 2 * FULL_CUTS; i++) {
+        kv_poll(true);
+    }
+    CHECK_MSG(!kv_erase_pending(), "recuperação sem corte %u", cut);
+    exit(0);
+}
+
+static void verify_full_key(uint32_t cut) {
+    uint32_t value;
+
+    hal_stdio_init();
+    kv_init();
+    CHECK_MSG(kv_get(FULL_KEY, &value, sizeof(value)) && value == FULL_VALUE, "energia cortada na operação %u: chave perdida", cut);
+    exit(0);
+}
+
+static void copy_file(const char *from, const char *to) {
+    static uint8_t data[HAL_FLASH_DATA_SIZE];
+    FILE *in = fopen(from, "rb"), *out = fopen(to, "wb");
+
+    CHECK(in != NULL && out != NULL);
+    size_t length = fread(data, 1, sizeof(data), in);
+    CHECK(fwrite(data, 1, length, out) == length);
+    fclose(in);
+    fclose(out);
+}
+
+// Roda 'child' num processo novo (a HAL do host lê o ambiente uma vez por processo)
+static void run(void (*child)(uint32_t), uint32_t round, bool quiet) {
+    pid_t pid = fork();
+    int status;
+
+    CHECK(pid >= 0);
+    if (pid == 0) {
+        if (quiet) {
+            CHECK(freopen("/dev/null", "w", stderr) != NULL); // O aviso do corte de energia
+        }
+        child(round);
+    }
+    CHECK(waitpid(pid, &status, 0) == pid);
+    CHECK_MSG(WIFEXITED(status) && WEXITSTATUS(status) == 0, "rodada %u: processo terminou com %d", round, status);
+}
+
+static void test_full_head(void) {
+    char cut[32];
+
+    unlink(FULL_PATH);
+    setenv("SACD_FLASH", FULL_PATH, 1);
+    run(fill_ring, 0, false);
+    snprintf(cut, sizeof(cut), "1:%u", FULL_SEED);
+    setenv("SACD_FLASH_CUT", cut, 1);
+    run(cut_head, 0, true);
+
+    // Cada corte sobre uma cópia do mesmo ponto de partida; sem corte, a recuperação termina
+    for (uint32_t n = 1; n <= FULL_CUTS + 1; n++) {
+        copy_file(FULL_PATH, RECOVERY_PATH);
+        setenv("SACD_FLASH", RECOVERY_PATH, 1);
+        snprintf(cut, sizeof(cut), "%u:%u", n <= FULL_CUTS ? n : 0, n);
+        setenv("SACD_FLASH_CUT", cut, 1);
+        run(recover, n, true);
+        unsetenv("SACD_FLASH_CUT");
+        run(verify_full_key, n, false);
+    }
+}
+
+int main(void) {
+    char cut[32];
+
+    unlink(FLASH_PATH);
+    setenv("SACD_FLASH", FLASH_PATH, 1);
+    for (uint32_t round = 1; round <= ROUNDS; round++) {
+        rand_state = round * 2654435761u;
+        snprintf(cut, sizeof(cut), "%u:%u", 1 + rand_next() % (rand_next() % 2 ? SHORT_CUT : MAX_CUT), round);
+        setenv("SACD_FLASH_CUT", cut, 1);
+        run(writer, round, true);
+        unsetenv("SACD_FLASH_CUT");
+        run(verify, round, false);
+    }
+    test_full_head();
+    TEST_OK();
+}
@@ -0,0 +1,155 @@
+#include <math.h>
+#include "test.h"
+#include "level_meter.h"
+
+// Medidor de nível em ponto fixo contra o mesmo medidor em double: log2 e dB por ponto, a
+// balística (VU e PPM) sobre degraus e sobre uma sequência ao acaso, com a retenção e a queda
+// do pico, e a quantização com histerese.
+
+#define BLOCK_MS 16
+#define LOG2_TOLERANCE 0.012 // Oitavas: o erro da tabela mais o truncamento em Q8
+#define DB_TOLERANCE 0.08
+#define BALLISTICS_TOLERANCE_DB 0.1
+
+typedef struct {
+    double level;
+    double peak;
+    uint32_t peak_age;
+} reference_meter_t;
+
+static double reference_db(uint32_t rms_q4) {
+    return rms_q4 <= 16 ? 0 : 20 * log10(rms_q4 / 16.0);
+}
+
+static void reference_update(reference_meter_t *ref, const level_meter_config_t *config, uint32_t rms_q4) {
+    double diff = reference_db(rms_q4) - ref->level;
+
+    ref->level += diff * (diff > 0 ? config->attack_q8 : config->release_q8) / 256;
+    if (ref->level >= ref->peak) {
+        ref->peak = ref->level;
+        ref->peak_age = 0;
+    }
+    else if (ref->peak_age < config->peak_hold_blocks) {
+        ref->peak_age++;
+    }
+    else {
+        ref->peak = fmax(ref->peak - config->peak_fall_db_q8 / 256.0, ref->level);
+    }
+}
+
+static double q8(int32_t v) {
+    return v / 256.0;
+}
+
+static void test_log2_and_db(void) {
+    int32_t previous = 0;
+
+    for (uint64_t x = 1; x <= UINT32_MAX; x += x / 211 + 1) {
+        int32_t v = level_meter_log2_q8(x);
+        CHECK_MSG(fabs(q8(v) - log2(x)) <= LOG2_TOLERANCE, "log2(%llu): %.4f", (unsigned long long)x, q8(v));
+        CHECK_MSG(v >= previous, "log2 não é monótono em %llu", (unsigned long long)x);
+        previous = v;
+    }
+    CHECK(level_meter_log2_q8(0) == 0);
+
+    for (uint32_t rms_q4 = 0; rms_q4 < (4096u << 4); rms_q4 += rms_q4 / 97 + 1) {
+        double db = q8(level_meter_db_q8(rms_q4));
+        CHECK_MSG(fabs(db - reference_db(rms_q4)) <= DB_TOLERANCE, "RMS %u/16: %.3f dB, esperava %.3f", rms_q4, db, reference_db(rms_q4));
+    }
+}
+
+// Roda o medidor e a referência juntos sobre 'count' blocos de rms(i)
+static void run_ballistics(const char *name, const level_meter_config_t *config, uint32_t (*rms)(uint32_t), uint32_t count) {
+    level_meter_t meter;
+    reference_meter_t ref = { 0, 0, 0 };
+
+    level_meter_init(&meter, config);
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t rms_q4 = rms(i);
+        level_meter_update(&meter, rms_q4);
+        reference_update(&ref, config, rms_q4);
+        CHECK_MSG(fabs(q8(meter.level_db_q8) - ref.level) <= BALLISTICS_TOLERANCE_DB, "%s, bloco %u: nível %.3f dB, esperava %.3f",
+                  name, i, q8(meter.level_db_q8), ref.level);
+        CHECK_MSG(fabs(q8(meter.peak_db_q8) - ref.peak) <= BALLISTICS_TOLERANCE_DB, "%s, bloco %u: pico %.3f dB, esperava %.3f",
+                  name, i, q8(meter.peak_db_q8), ref.peak);
+    }
+}
+
+// 60 dB por 1 s, depois silêncio
+static uint32_t step(uint32_t i) {
+    return i < 1000 / BLOCK_MS ? 16000 : 0;
+}
+
+static uint32_t random_rms(uint32_t i) {
+    static uint32_t state = 99;
+    (void)i;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return (state >> 8) % (3000u << 4);
+}
+
+// Tempos da balística com blocos de 16 ms, como documentados em level_meter.h
+static void test_time_constants(void) {
+    const level_meter_config_t vu = LEVEL_METER_VU, ppm = LEVEL_METER_PPM;
+    level_meter_t meter;
+    int32_t full = level_meter_db_q8(16000);
+    uint32_t blocks;
+
+    // VU: ~300 ms até 99% na subida e na descida
+    level_meter_init(&meter, &vu);
+    for (blocks = 1; level_meter_update(&meter, 16000) < full * 99 / 100; blocks++) {
+    }
+    CHECK_MSG(blocks * BLOCK_MS >= 250 && blocks * BLOCK_MS <= 350, "VU sobe em %u ms", blocks * BLOCK_MS);
+    for (blocks = 1; level_meter_update(&meter, 0) > full / 100; blocks++) {
+    }
+    CHECK_MSG(blocks * BLOCK_MS >= 250 && blocks * BLOCK_MS <= 350, "VU desce em %u ms", blocks * BLOCK_MS);
+
+    // PPM: 80% da subida no primeiro bloco, 1/e da descida em ~250 ms, pico retido por ~1 s
+    level_meter_init(&meter, &ppm);
+    CHECK(level_meter_update(&meter, 16000) >= full * 8 / 10);
+    for (uint i = 0; i < 10; i++) {
+        level_meter_update(&meter, 16000);
+    }
+    int32_t peak = meter.peak_db_q8;
+    for (blocks = 1; level_meter_update(&meter, 0) > full * 368 / 1000; blocks++) {
+        if (blocks < ppm.peak_hold_blocks) {
+            CHECK(meter.peak_db_q8 == peak);
+        }
+    }
+    CHECK_MSG(blocks * BLOCK_MS >= 200 && blocks * BLOCK_MS <= 300, "PPM cai a 1/e em %u ms", blocks * BLOCK_MS);
+}
+
+static void test_hysteresis(void) {
+    const int32_t min = LEVEL_METER_DB(6), step_db = LEVEL_METER_DB(6), hysteresis = LEVEL_METER_DB(1);
+    uint8_t level = 0;
+
+    // Rampa de subida e de descida, em passos de 1/8 dB
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i <= 40 * 8; i++) {
+            double db = pass == 0 ? i / 8.0 : 40 - i / 8.0;
+            uint8_t next = level_meter_quantize_hysteresis(LEVEL_METER_DB(db), min, step_db, 5, level, hysteresis);
+            // Degrau sem histerese para o nível deslocado na direção do movimento
+            double shifted = pass == 0 ? db - 1 : db + 1;
+            int expected = shifted < 6 ? 0 : 1 + (int)floor((shifted - 6) / 6);
+            expected = expected > 4 ? 4 : expected;
+            CHECK_MSG(next == (pass == 0 ? (expected > level ? expected : level) : (expected < level ? expected : level)),
+                      "%.3f dB: degrau %u depois do %u", db, next, level);
+            level = next;
+        }
+        CHECK(level == (pass == 0 ? 4 : 0));
+    }
+}
+
+int main(void) {
+    const level_meter_config_t vu = LEVEL_METER_VU, ppm = LEVEL_METER_PPM;
+
+    test_log2_and_db();
+    run_ballistics("VU, degrau", &vu, step, 200);
+    run_ballistics("PPM, degrau", &ppm, step, 200);
+    run_ballistics("VU, ao acaso", &vu, random_rms, 5000);
+    run_ballistics("PPM, ao acaso", &ppm, random_rms, 5000);
+    test_time_constants();
+    test_hysteresis();
+    TEST_OK();
+}
@@ -0,0 +1,173 @@
+#include <math.h>
+#include "test.h"
+#include "audio.h"
+#include "noise_floor.h"
+
+// Piso de ruído acompanhado pelo core de áudio sobre um WAV tocado pela HAL do host: a
+// calibração mede o ruído inicial, o piso sobe devagar com um ruído mais alto e volta rápido
+// com o silêncio, ignora o apito (blocos tonais) e para no teto com um ruído muito alto.
+// O WAV é gerado aqui; o piso é comparado com o RMS médio medido no mesmo trecho (o ruído
+// branco perde a parte acima da banda do decimador, então o RMS fica abaixo do desvio do WAV).
+//
+// Com um argumento, toca uma gravação de fundo da cozinha (tests/fixtures/background_*.wav,
+// ver tests/test_whistle.c): o piso termina perto do RMS médio da segunda metade (ou no teto,
+// se ele passar do teto) e nenhum relatório declara apito.
+
+#define MIC_CHANNEL 2
+#define RATE 16000
+
+typedef struct {
+    uint32_t ms;
+    float noise_rms; // Ruído gaussiano (unidades do WAV)
+    float tone_hz; // Apito por cima do ruído (0 = sem)
+} segment_t;
+
+static const segment_t segments[] = {
+    { 3000, 200, 0 }, // Calibração
+    { 12000, 600, 0 }, // Exaustor ligado: o piso sobe
+    { 6000, 600, 2000 }, // Apito: o piso não se mexe
+    { 6000, 200, 0 }, // Exaustor desligado: o piso desce
+    { 10000, 3000, 0 }, // Ruído muito alto: o piso para no teto
+};
+
+static uint32_t rand_state = 777;
+
+// Gaussiana aproximada pela soma de 12 uniformes (média 0, desvio 1)
+static float gauss(void) {
+    float sum = -6;
+    for (uint i = 0; i < 12; i++) {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 17;
+        rand_state ^= rand_state << 5;
+        sum += (rand_state >> 8) / 16777216.f;
+    }
+    return sum;
+}
+
+static void check_recording(const char *path) {
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    uint32_t length_ms = test_wav_ms(path);
+
+    setenv("SACD_WAV", path, 1);
+    hal_stdio_init();
+    audio_init(MIC_CHANNEL);
+
+    uint64_t start = hal_time_us();
+    uint64_t rms_sum = 0;
+    uint32_t rms_count = 0;
+    audio_report_t report = { 0 };
+    for (;;) {
+        audio_report_t next;
+        hal_wait_for_event();
+        if (!audio_update(&next)) {
+            continue;
+        }
+        uint32_t ms = (hal_time_us() - start) / 1000;
+        if (ms >= length_ms) {
+            break;
+        }
+        report = next;
+        CHECK_MSG(!report.whistle, "%s: apito falso em %u ms", name, ms);
+        CHECK(report.floor_q4 <= NOISE_FLOOR_MAX_Q4);
+        if (ms >= length_ms / 2) {
+            rms_sum += report.rms_q4;
+            rms_count++;
+        }
+    }
+
+    CHECK(rms_count > 0 && !report.calibrating);
+    float expected = fminf((float)rms_sum / rms_count, NOISE_FLOOR_MAX_Q4);
+    CHECK_MSG(report.floor_q4 >= 0.5f * expected && report.floor_q4 <= 1.1f * expected, "%s: piso %u, RMS %.0f", name,
+              report.floor_q4, expected);
+    printf("%s: piso %u, RMS %.0f\n", name, report.floor_q4, expected);
+}
+
+int main(int argc, char **argv) {
+    uint32_t total = 0;
+
+    if (argc > 1) {
+        check_recording(argv[1]);
+        TEST_OK();
+    }
+
+    for (uint s = 0; s < count_of(segments); s++) {
+        total += segments[s].ms * RATE / 1000;
+    }
+    int16_t *wav = malloc(total * sizeof(int16_t));
+    uint32_t n = 0;
+    for (uint s = 0; s < count_of(segments); s++) {
+        const segment_t *seg = &segments[s];
+        for (uint32_t i = 0; i < seg->ms * RATE / 1000; i++) {
+            float v = seg->noise_rms * gauss() + (seg->tone_hz ? 5000 * sinf(2 * (float)M_PI * seg->tone_hz * i / RATE) : 0);
+            wav[n++] = v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v;
+        }
+    }
+    test_write_wav("test_noise_floor.wav", wav, total, RATE);
+    free(wav);
+
+    setenv("SACD_WAV", "test_noise_floor.wav", 1);
+    hal_stdio_init();
+    audio_init(MIC_CHANNEL);
+
+    uint64_t start = hal_time_us();
+    uint32_t seg_start = 0;
+    uint32_t floor_before = 0; // Piso no fim do trecho anterior
+    for (uint s = 0; s < count_of(segments); s++) {
+        const segment_t *seg = &segments[s];
+        uint32_t seg_end = seg_start + seg->ms;
+        uint32_t floor_min = UINT32_MAX, floor_max = 0;
+        uint64_t rms_sum = 0;
+        uint32_t rms_count = 0;
+        audio_report_t report = { 0 };
+
+        for (;;) {
+            audio_report_t next;
+            hal_wait_for_event();
+            if (!audio_update(&next)) {
+                continue;
+            }
+            uint32_t ms = (hal_time_us() - start) / 1000;
+            if (ms >= seg_end) {
+                break;
+            }
+            report = next;
+            if (ms >= seg_start + 200 && !report.calibrating) { // Depois da janela do RMS
+                if (report.floor_q4 < floor_min) floor_min = report.floor_q4;
+                if (report.floor_q4 > floor_max) floor_max = report.floor_q4;
+            }
+            if (ms >= seg_start + seg->ms / 2) {
+                rms_sum += report.rms_q4;
+                rms_count++;
+            }
+        }
+
+        // RMS médio da segunda metade do trecho
+        CHECK(rms_count > 0);
+        float expected = (float)rms_sum / rms_count;
+        switch (s) {
+            case 0:
+                CHECK(!report.calibrating);
+                CHECK_MSG(fabsf(report.floor_q4 - expected) <= 0.1f * expected, "calibração: piso %u, RMS %.0f", report.floor_q4, expected);
+                CHECK_MSG(abs((int)report.dc_q4 - (2048 << 4)) <= 2 << 4, "DC %u", report.dc_q4); // Meio da escala, com os arredondamentos
+                break;
+            case 1:
+            case 3:
+                CHECK_MSG(fabsf(report.floor_q4 - 0.98f * expected) <= 0.1f * expected, "trecho %u: piso %u, RMS %.0f", s, report.floor_q4, expected);
+                break;
+            case 2:
+                CHECK_MSG(report.whistle, "apito não detectado");
+                CHECK_MSG(floor_min >= floor_before * 95 / 100 && floor_max <= floor_before * 105 / 100,
+                          "piso entre %u e %u durante o apito, era %u", floor_min, floor_max, floor_before);
+                break;
+            case 4:
+                CHECK_MSG(report.floor_q4 == NOISE_FLOOR_MAX_Q4, "piso %u, teto %u", report.floor_q4, NOISE_FLOOR_MAX_Q4);
+                CHECK(floor_max <= NOISE_FLOOR_MAX_Q4);
+                break;
+        }
+        printf("trecho %u: piso %u (entre %u e %u), RMS %.0f\n", s, report.floor_q4, floor_min, floor_max, expected);
+        floor_before = report.floor_q4;
+        seg_start = seg_end;
+    }
+
+    TEST_OK();
+}
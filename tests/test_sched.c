@@ -0,0 +1,161 @@
+#include "test.h"
+#include "event_sched.h"
+
+// Prazos do escalonador sobre o relógio virtual da HAL do host. O laço daqui faz o mesmo que
+// sched_run, mas volta quando não há mais prazo armado. Cada EVENT_TIMER tratado anota o id, o
+// instante do tratamento e o do disparo, que têm de seguir a ordem dos prazos e cair logo
+// depois deles (o alarme do heap é armado em us, não no tique de 1 ms).
+
+#define MAX_FIRED 64
+#define MAX_LATENCY_US 1000 // Do prazo até o tratamento, com o laço ocioso
+#define STEP_US 1300 // Entre dois prazos seguidos; não é múltiplo de 1 ms
+
+typedef struct {
+    uint id;
+    uint64_t handled_us;
+    uint32_t posted_us;
+} fired_t;
+
+static fired_t fired[MAX_FIRED];
+static uint fired_count;
+static uint buttons;
+
+static void handler(const event_t *event) {
+    if (event->type == EVENT_TIMER) {
+        CHECK(fired_count < MAX_FIRED);
+        fired[fired_count++] = (fired_t){ .id = event->arg, .handled_us = hal_time_us(), .posted_us = event->posted_us };
+    }
+    else if (event->type == EVENT_BUTTON) {
+        buttons++;
+    }
+}
+
+static bool any_active(void) {
+    for (uint id = 0; id < SCHED_MAX_TIMERS; id++) {
+        if (sched_timer_active(id)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Trata os eventos e dorme até o próximo alarme, até não sobrar prazo armado
+static void run_timers(void) {
+    while (true) {
+        if (sched_dispatch()) {
+            continue;
+        }
+        if (!any_active()) {
+            return;
+        }
+        hal_wait_for_event();
+    }
+}
+
+// Confere os disparos anotados contra os ids e prazos esperados, na ordem, e zera a lista
+static void expect_fired(const char *name, const uint *ids, const uint64_t *deadlines, uint count) {
+    CHECK_MSG(fired_count == count, "%s: %u disparos, esperados %u", name, fired_count, count);
+    for (uint i = 0; i < count; i++) {
+        const fired_t *f = &fired[i];
+        CHECK_MSG(f->id == ids[i], "%s: disparo %u foi o prazo %u, esperado %u", name, i, f->id, ids[i]);
+        CHECK_MSG(f->posted_us == (uint32_t)deadlines[i], "%s: prazo %u disparou em %u us, não em %llu",
+                  name, f->id, f->posted_us, (unsigned long long)deadlines[i]);
+        CHECK_MSG(f->handled_us >= deadlines[i] && f->handled_us - deadlines[i] < MAX_LATENCY_US,
+                  "%s: prazo %u tratado %lld us depois de vencer", name, f->id,
+                  (long long)(f->handled_us - deadlines[i]));
+    }
+    fired_count = 0;
+}
+
+// Todos os ids armados fora de ordem disparam na ordem dos prazos
+static void test_heap_order(void) {
+    static const uint rank[SCHED_MAX_TIMERS] = { 5, 2, 7, 0, 3, 6, 1, 4 };
+    uint ids[SCHED_MAX_TIMERS];
+    uint64_t deadlines[SCHED_MAX_TIMERS];
+    uint64_t now = hal_time_us();
+
+    for (uint id = 0; id < SCHED_MAX_TIMERS; id++) {
+        uint64_t deadline = now + STEP_US * (rank[id] + 1);
+        CHECK(sched_timer_start_at(id, deadline));
+        ids[rank[id]] = id;
+        deadlines[rank[id]] = deadline;
+    }
+    run_timers();
+    expect_fired("ordem", ids, deadlines, SCHED_MAX_TIMERS);
+}
+
+// Cancelar some com o prazo; rearmar um prazo pendente o move para a frente ou para trás
+static void test_cancel_restart(void) {
+    uint64_t now = hal_time_us();
+
+    for (uint id = 0; id < 6; id++) {
+        CHECK(sched_timer_start_at(id, now + STEP_US * (id + 1)));
+    }
+    sched_timer_cancel(2);
+    CHECK(!sched_timer_active(2));
+    CHECK(sched_timer_start_at(1, now + STEP_US * 10)); // Para depois de todos
+    CHECK(sched_timer_start_at(5, now + STEP_US / 2)); // Para antes de todos
+    sched_timer_cancel(0);
+    CHECK(sched_timer_start_at(0, now + STEP_US * 4 + 100)); // Cancelado e rearmado
+
+    // 3 (4 passos) vem antes de 0 (4 passos e 100 us), que vem antes de 4 (5 passos)
+    static const uint ids[] = { 5, 3, 0, 4, 1 };
+    const uint64_t deadlines[] = { now + STEP_US / 2, now + STEP_US * 4, now + STEP_US * 4 + 100, now + STEP_US * 5,
+                                   now + STEP_US * 10 };
+    run_timers();
+    expect_fired("cancelar e rearmar", ids, deadlines, 5);
+}
+
+// Um EVENT_TIMER que já estava na fila quando o prazo foi cancelado ou rearmado é descartado
+static void test_stale_generation(void) {
+    uint64_t now = hal_time_us();
+
+    CHECK(sched_timer_start_at(1, now + 500));
+    CHECK(sched_timer_start_at(2, now + 700));
+    hal_sleep_ms(1); // Os dois alarmes disparam, mas o laço ainda não tratou os eventos
+    CHECK(fired_count == 0);
+    CHECK(sched_timer_active(1) && sched_timer_active(2));
+
+    sched_timer_cancel(1);
+    uint64_t restart = hal_time_us() + STEP_US;
+    CHECK(sched_timer_start_at(2, restart));
+    run_timers();
+
+    const uint ids[] = { 2 };
+    const uint64_t deadlines[] = { restart };
+    expect_fired("geração", ids, deadlines, 1);
+}
+
+// Um prazo que vence com a fila cheia é tratado depois, uma vez, e não fica armado para sempre
+static void test_full_queue(void) {
+    uint64_t now = hal_time_us();
+    uint64_t deadline = now + 300;
+
+    CHECK(sched_timer_start_at(3, deadline));
+    for (uint i = 0; i < SCHED_QUEUE_LENGTH; i++) {
+        CHECK(sched_post(EVENT_BUTTON, 0));
+    }
+    hal_sleep_ms(1);
+    CHECK(sched_timer_active(3));
+    while (sched_dispatch()) {
+    }
+    CHECK_MSG(buttons == SCHED_QUEUE_LENGTH, "%u botões", buttons);
+    CHECK_MSG(fired_count == 1 && fired[0].id == 3, "%u disparos", fired_count);
+    CHECK_MSG(fired[0].posted_us == (uint32_t)deadline, "disparou em %u us, não em %llu", fired[0].posted_us,
+              (unsigned long long)deadline);
+    CHECK(!sched_timer_active(3));
+    fired_count = 0;
+}
+
+int main(void) {
+    hal_stdio_init();
+    sched_init(handler);
+    hal_sleep_ms(10);
+
+    test_heap_order();
+    test_cancel_restart();
+    test_stale_generation();
+    test_full_queue();
+    test_heap_order(); // Depois de tudo, o heap continua íntegro
+    TEST_OK();
+}
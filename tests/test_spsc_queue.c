@@ -0,0 +1,108 @@
+#include <pthread.h>
+#include <sched.h>
+#include "test.h"
+#include "spsc_queue.h"
+
+// Fila SPSC com um produtor e um consumidor em threads de verdade (o papel do core1 e do
+// core0). Cada item tem várias palavras derivadas do número de sequência: um item lido antes
+// de estar completo, fora de ordem ou repetido aparece como palavra errada ou salto na
+// sequência. A primeira fase espera quando a fila enche (nada se perde); a segunda descarta,
+// como o core de áudio, e confere que recebidos + descartados = enviados.
+
+#define QUEUE_LENGTH 16
+#define ITEMS 1000000u
+#define WORDS 7
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t words[WORDS];
+} item_t;
+
+SPSC_QUEUE_DEFINE(test_queue, item_t, QUEUE_LENGTH)
+
+static test_queue_t queue;
+static bool lossy;
+static uint32_t dropped;
+
+static void item_fill(item_t *item, uint32_t sequence) {
+    item->sequence = sequence;
+    for (uint i = 0; i < WORDS; i++) {
+        item->words[i] = sequence * 2654435761u + i;
+    }
+}
+
+static void item_check(const item_t *item) {
+    for (uint i = 0; i < WORDS; i++) {
+        CHECK_MSG(item->words[i] == item->sequence * 2654435761u + i, "item %u, palavra %u incompleta", item->sequence, i);
+    }
+}
+
+static void *producer(void *arg) {
+    (void)arg;
+    for (uint32_t n = 1; n <= ITEMS; n++) {
+        item_t item;
+        item_fill(&item, n);
+        while (!test_queue_push(&queue, &item)) {
+            if (lossy && n != ITEMS) { // O último sempre chega: marca o fim para o consumidor
+                dropped++;
+                break;
+            }
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Consome até o último item; retorna quantos chegaram
+static uint32_t consume(void) {
+    uint32_t received = 0, last = 0;
+
+    while (last != ITEMS) {
+        item_t item;
+        const item_t *front = test_queue_front(&queue);
+
+        if (!front) {
+            sched_yield(); // Com poucos processadores, dá a vez ao produtor
+            continue;
+        }
+        // front() e pop() veem o mesmo item
+        uint32_t sequence = front->sequence;
+        CHECK(test_queue_pop(&queue, &item));
+        CHECK(item.sequence == sequence);
+        item_check(&item);
+
+        if (lossy) {
+            CHECK_MSG(item.sequence > last, "item %u depois do %u", item.sequence, last);
+        }
+        else {
+            CHECK_MSG(item.sequence == last + 1, "item %u depois do %u", item.sequence, last);
+        }
+        CHECK(test_queue_count(&queue) <= QUEUE_LENGTH);
+        last = item.sequence;
+        received++;
+    }
+    return received;
+}
+
+static uint32_t run(bool drop) {
+    pthread_t thread;
+
+    test_queue_init(&queue);
+    lossy = drop;
+    dropped = 0;
+    CHECK(pthread_create(&thread, NULL, producer, NULL) == 0);
+    uint32_t received = consume();
+    CHECK(pthread_join(thread, NULL) == 0);
+    CHECK(test_queue_front(&queue) == NULL && test_queue_count(&queue) == 0);
+    return received;
+}
+
+int main(void) {
+    CHECK(run(false) == ITEMS);
+
+    uint32_t received = run(true);
+    printf("%u itens, %u descartados com a fila cheia\n", ITEMS, dropped);
+    CHECK(received + dropped == ITEMS);
+
+    TEST_OK();
+}
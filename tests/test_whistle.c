@@ -0,0 +1,165 @@
+#include <math.h>
+#include "test.h"
+#include "mic_dma.h"
+#include "whistle.h"
+
+// Detector de apito sobre um WAV tocado pela HAL do host, pelo mesmo caminho da placa
+// (captura sobreamostrada, decimação, um whistle_process por bloco). O WAV é gerado aqui,
+// trecho a trecho, e cada trecho diz se o apito deve aparecer nele.
+//
+// Com um argumento, toca uma gravação de verdade em vez do WAV gerado: o CMakeLists.txt cria um
+// teste whistle_<nome> para cada tests/fixtures/<nome>.wav. Uma whistle_*.wav tem de declarar
+// o apito por RECORDED_WHISTLE_MS seguidos; uma background_*.wav (exaustor, conversa, louça)
+// não pode declarar nunca. Para gravar na cozinha: "Gravar" no menu da placa, "dump" na USB
+// salvo em captura.txt, e tools/adpcm_dump.py captura.txt tests/fixtures/<nome>.wav.
+
+#define MIC_CHANNEL 2
+#define RATE 16000
+#define BLOCK_MS (MIC_DMA_BLOCK_SAMPLES * 1000 / RATE)
+#define DETECT_MS ((WHISTLE_ON_BLOCKS + 2) * BLOCK_MS) // Persistência mais o transiente do decimador
+#define FORGET_MS ((WHISTLE_MAX_BLOCKS + 2) * BLOCK_MS)
+#define RECORDED_WHISTLE_MS 1000 // Apito seguido que uma gravação com apito tem de declarar
+
+typedef struct {
+    uint32_t ms; // Duração
+    float tone_hz; // 0 = sem tom
+    float tone_amplitude;
+    float noise_rms; // Ruído gaussiano
+    bool whistle; // O apito deve ser detectado neste trecho
+} segment_t;
+
+static const segment_t segments[] = {
+    { 1000, 0, 0, 0, false }, // Silêncio
+    { 2000, 2000, 5000, 0, true }, // Tom no centro de um filtro
+    { 1000, 0, 0, 0, false },
+    { 2000, 2125, 5000, 0, true }, // Entre dois filtros
+    { 1000, 0, 0, 0, false },
+    { 2000, 0, 0, 1600, false }, // Ruído branco forte (exaustor)
+    { 1000, 0, 0, 0, false },
+    { 2000, 1500, 5000, 700, true }, // Apito sobre ruído
+    { 1000, 0, 0, 0, false },
+    { 2000, 400, 5000, 0, false }, // Tom grave, fora do banco
+    { 1000, 0, 0, 0, false },
+};
+
+static uint32_t rand_state = 12345;
+
+// Gaussiana aproximada pela soma de 12 uniformes (média 0, desvio 1)
+static float gauss(void) {
+    float sum = -6;
+    for (uint i = 0; i < 12; i++) {
+        rand_state ^= rand_state << 13;
+        rand_state ^= rand_state >> 17;
+        rand_state ^= rand_state << 5;
+        sum += (rand_state >> 8) / 16777216.f;
+    }
+    return sum;
+}
+
+// Toca o WAV no microfone pela HAL do host e liga a captura
+static void start_capture(const char *wav, whistle_detector_t *det) {
+    setenv("SACD_WAV", wav, 1);
+    hal_stdio_init();
+    whistle_init(det, RATE);
+    mic_dma_init(MIC_CHANNEL, RATE);
+    mic_dma_start();
+}
+
+static void check_recording(const char *path) {
+    const char *name = strrchr(path, '/') ? strrchr(path, '/') + 1 : path;
+    bool expected = strncmp(name, "whistle_", 8) == 0;
+    CHECK_MSG(expected || strncmp(name, "background_", 11) == 0, "%s: o nome começa com whistle_ ou background_", name);
+
+    uint32_t length_ms = test_wav_ms(path);
+    whistle_detector_t det;
+    start_capture(path, &det);
+
+    uint64_t start = hal_time_us();
+    uint32_t run_ms = 0, longest_ms = 0; // Apito declarado sem interrupção
+    for (;;) {
+        hal_wait_for_event();
+        const uint16_t *block = mic_dma_get_block();
+        if (!block) {
+            continue;
+        }
+        bool whistle = whistle_process(&det, block, MIC_DMA_BLOCK_SAMPLES);
+        uint32_t ms = (hal_time_us() - start) / 1000;
+        if (ms >= length_ms) {
+            break;
+        }
+        CHECK_MSG(expected || !whistle, "%s: apito falso em %u ms (filtro %d, razão %u/256)", name, ms, det.last_bin, det.last_ratio_q8);
+        run_ms = whistle ? run_ms + BLOCK_MS : 0;
+        if (run_ms > longest_ms) longest_ms = run_ms;
+    }
+    CHECK_MSG(!expected || longest_ms >= RECORDED_WHISTLE_MS, "%s: apito por no máximo %u ms seguidos", name, longest_ms);
+    printf("%s: %u ms, apito por até %u ms seguidos\n", name, length_ms, longest_ms);
+}
+
+int main(int argc, char **argv) {
+    uint32_t total = 0;
+
+    if (argc > 1) {
+        check_recording(argv[1]);
+        TEST_OK();
+    }
+
+    for (uint s = 0; s < count_of(segments); s++) {
+        total += segments[s].ms * RATE / 1000;
+    }
+
+    int16_t *wav = malloc(total * sizeof(int16_t));
+    uint32_t n = 0;
+    for (uint s = 0; s < count_of(segments); s++) {
+        const segment_t *seg = &segments[s];
+        for (uint32_t i = 0; i < seg->ms * RATE / 1000; i++) {
+            float v = seg->tone_amplitude * sinf(2 * (float)M_PI * seg->tone_hz * i / RATE) + seg->noise_rms * gauss();
+            wav[n++] = v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v;
+        }
+    }
+    test_write_wav("test_whistle.wav", wav, total, RATE);
+    free(wav);
+
+    whistle_detector_t det;
+    start_capture("test_whistle.wav", &det);
+
+    uint64_t start = hal_time_us();
+    uint32_t seg_start = 0;
+    for (uint s = 0; s < count_of(segments); s++) {
+        const segment_t *seg = &segments[s];
+        uint32_t seg_end = seg_start + seg->ms;
+        uint32_t detected_ms = 0; // Tempo com apito no trecho, fora das bordas
+
+        for (;;) {
+            hal_wait_for_event();
+            const uint16_t *block = mic_dma_get_block();
+            if (!block) {
+                continue;
+            }
+            bool whistle = whistle_process(&det, block, MIC_DMA_BLOCK_SAMPLES);
+            uint32_t ms = (hal_time_us() - start) / 1000;
+            if (ms >= seg_end) {
+                break;
+            }
+
+            // Dá tempo para declarar (trechos com apito) ou esquecer (os seguintes)
+            bool settled = ms >= seg_start + (seg->whistle ? DETECT_MS : FORGET_MS);
+            if (!settled) {
+                continue;
+            }
+            if (!seg->whistle) {
+                CHECK_MSG(!whistle, "apito falso em %u ms (trecho %u, filtro %d, razão %u/256)", ms, s, det.last_bin, det.last_ratio_q8);
+            }
+            else if (whistle) {
+                detected_ms += BLOCK_MS;
+            }
+        }
+
+        if (seg->whistle) {
+            // O apito contínuo fica declarado o trecho todo
+            CHECK_MSG(detected_ms >= seg->ms - DETECT_MS - BLOCK_MS, "trecho %u: apito em %u de %u ms", s, detected_ms, seg->ms - DETECT_MS);
+        }
+        seg_start = seg_end;
+    }
+
+    TEST_OK();
+}
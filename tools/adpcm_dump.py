@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""Converte uma gravação do gravador de áudio (IMA-ADPCM) em WAV.
+
+Uso: adpcm_dump.py captura.txt saida.wav
+     adpcm_dump.py --flash flash.bin saida.wav
+
+A captura é a saída da USB depois do comando "dump" (linhas "#R<hex>"; as demais são
+ignoradas); com --flash, lê direto a imagem da área de dados gravada pelo simulador
+(SACD_FLASH). O WAV sai em PCM de 16 bits na escala que o simulador usa para o ADC,
+então pode ser passado de volta em SACD_WAV.
+"""
+import argparse
+import struct
+import sys
+import wave
+
+# Mantido em sincronia com inc/recorder.h e inc/hal.h
+MAGIC = 0x31434441
+HEADER = struct.Struct('<IIII')
+SECTOR_SIZE = 4096
+RECORDER_FLASH_OFFSET = 0
+RECORDER_DATA_OFFSET = RECORDER_FLASH_OFFSET + SECTOR_SIZE
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+    34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+    724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+    3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+INDEX_CHANGE = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def decode(data):
+    """Decodifica IMA-ADPCM (nibble de baixo primeiro) a partir do estado zerado."""
+    predictor, index = 0, 0
+    out = []
+    for byte in data:
+        for code in (byte & 0xF, byte >> 4):
+            step = STEPS[index]
+            diff = step >> 3
+            if code & 4:
+                diff += step
+            if code & 2:
+                diff += step >> 1
+            if code & 1:
+                diff += step >> 2
+            predictor += -diff if code & 8 else diff
+            predictor = max(-32768, min(32767, predictor))
+            index = max(0, min(88, index + INDEX_CHANGE[code & 7]))
+            out.append(predictor)
+    return out
+
+
+def read_capture(path):
+    """Junta os bytes das linhas "#R" até o marcador de fim "#R-"."""
+    data = bytearray()
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith('#R'):
+                continue
+            if line == '#R-':
+                break
+            try:
+                data += bytes.fromhex(line[2:])
+            except ValueError:
+                print(f'aviso: linha inválida ignorada: {line[:40]}', file=sys.stderr)
+    return bytes(data[:HEADER.size]), bytes(data[HEADER.size:])
+
+
+def read_flash(path):
+    with open(path, 'rb') as f:
+        image = f.read()
+    header = image[RECORDER_FLASH_OFFSET:RECORDER_FLASH_OFFSET + HEADER.size]
+    return header, image[RECORDER_DATA_OFFSET:]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('input', help='captura da USB (ou imagem da flash, com --flash)')
+    parser.add_argument('output', help='arquivo WAV a gravar')
+    parser.add_argument('--flash', action='store_true', help='a entrada é a imagem da flash do simulador')
+    args = parser.parse_args()
+
+    header, data = read_flash(args.input) if args.flash else read_capture(args.input)
+    if len(header) < HEADER.size:
+        print('nenhuma gravação na entrada', file=sys.stderr)
+        return 1
+    magic, rate, length, dropped = HEADER.unpack(header)
+    if magic != MAGIC:
+        print('cabeçalho inválido (gravação interrompida ou flash apagada)', file=sys.stderr)
+        return 1
+    if len(data) < length:
+        print(f'aviso: faltam {length - len(data)} bytes; convertendo o que chegou', file=sys.stderr)
+    samples = decode(data[:length])
+
+    with wave.open(args.output, 'wb') as w:
+        w.setnchannels(1)
+        w.setsampwidth(2)
+        w.setframerate(rate)
+        w.writeframes(struct.pack(f'<{len(samples)}h', *samples))
+
+    print(f'{len(samples)} amostras a {rate} Hz ({len(samples) / rate:.1f} s), '
+          f'{dropped} blocos descartados -> {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
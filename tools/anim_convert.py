@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+"""Converte uma sequência de PNG numa animação comprimida para o OLED (inc/anim.h).
+
+Uso: anim_convert.py quadro_00.png quadro_01.png ... -o inc/nome_anim.h --name nome [--frame-ms 100]
+
+Cada quadro vira 1 bit por pixel (aceso acima de metade do brilho; transparente é apagado)
+no formato de páginas do SSD1306 (cada byte é uma coluna de 8 pixels, bit 0 em cima) e é
+codificado com RLE, inteiro (quadro-chave) ou como XOR com o anterior (delta), o que for
+menor; o primeiro é sempre chave, para a animação poder recomeçar. Sai um header com a
+tabela e o anim_t prontos para incluir no firmware. Só usa a biblioteca padrão.
+"""
+import argparse
+import struct
+import sys
+import zlib
+
+# Mantido em sincronia com inc/anim.h
+FRAME_KEY = 0x00
+FRAME_DELTA = 0x01
+MAX_RUN = 128  # Repetições (e literais) por código
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    """Retorna (largura, altura, linhas de pixels aceso/apagado). PNG de 8 bits ou 1 bit cinza."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'\x89PNG\r\n\x1a\n':
+        raise ValueError(f'{path}: não é PNG')
+
+    pos, idat, palette, trns = 8, b'', None, None
+    while pos < len(data):
+        length, kind = struct.unpack('>I4s', data[pos:pos + 8])
+        body = data[pos + 8:pos + 8 + length]
+        if kind == b'IHDR':
+            width, height, depth, color, _, _, interlace = struct.unpack('>IIBBBBB', body)
+        elif kind == b'PLTE':
+            palette = [tuple(body[i:i + 3]) for i in range(0, len(body), 3)]
+        elif kind == b'tRNS':
+            trns = body
+        elif kind == b'IDAT':
+            idat += body
+        pos += 12 + length
+
+    if interlace:
+        raise ValueError(f'{path}: PNG entrelaçado não suportado')
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color]
+    if depth != 8 and not (depth == 1 and color in (0, 3)):
+        raise ValueError(f'{path}: use PNG de 8 bits por canal (ou 1 bit)')
+
+    bits_per_pixel = channels * depth
+    stride = (width * bits_per_pixel + 7) // 8
+    bpp = max(1, bits_per_pixel // 8)
+    raw = zlib.decompress(idat)
+    rows, prev = [], bytearray(stride)
+    for y in range(height):
+        kind = raw[y * (stride + 1)]
+        line = bytearray(raw[y * (stride + 1) + 1:(y + 1) * (stride + 1)])
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            line[i] = (line[i] + (0, a, b, (a + b) // 2, paeth(a, b, c))[kind]) & 0xFF
+        prev = line
+
+        pixels = []
+        for x in range(width):
+            if depth == 1:
+                v = (line[x // 8] >> (7 - x % 8)) & 1
+            else:
+                v = line[x]
+            if color == 3:
+                samples = palette[v] + ((trns[v] if trns and v < len(trns) else 255),)
+            elif depth == 1:
+                samples = (v * 255,)
+            else:
+                samples = tuple(line[x * channels:(x + 1) * channels])
+            if color in (0, 4):
+                lum, alpha = samples[0], samples[1] if len(samples) > 1 else 255
+            else:
+                lum = (299 * samples[0] + 587 * samples[1] + 114 * samples[2]) // 1000
+                alpha = samples[3] if len(samples) > 3 else 255
+            pixels.append(lum >= 128 and alpha >= 128)
+        rows.append(pixels)
+    return width, height, rows
+
+
+def to_pages(width, height, rows):
+    """Pixels em bytes de página: página 0 inteira, depois a 1, e assim por diante."""
+    out = bytearray()
+    for page in range(height // 8):
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                if rows[page * 8 + bit][x]:
+                    byte |= 1 << bit
+            out.append(byte)
+    return bytes(out)
+
+
+def rle(data):
+    """0x00-0x7F: n + 1 bytes literais a seguir; 0x80-0xFF: o byte seguinte (n & 0x7F) + 1 vezes."""
+    out = bytearray()
+    literal = bytearray()
+    i = 0
+
+    def flush_literal():
+        while literal:
+            chunk = literal[:MAX_RUN]
+            out.append(len(chunk) - 1)
+            out.extend(chunk)
+            del literal[:MAX_RUN]
+
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < MAX_RUN:
+            run += 1
+        if run >= 3:
+            flush_literal()
+            out.append(0x80 | (run - 1))
+            out.append(data[i])
+            i += run
+        else:
+            literal.extend(data[i:i + run])
+            i += run
+    flush_literal()
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('frames', nargs='+', help='quadros PNG, em ordem')
+    parser.add_argument('-o', '--output', required=True, help='header C a gravar')
+    parser.add_argument('--name', required=True, help='prefixo dos símbolos (nome_anim)')
+    parser.add_argument('--frame-ms', type=int, default=100, help='intervalo entre quadros (ms)')
+    args = parser.parse_args()
+
+    size = None
+    encoded = []
+    previous = None
+    for path in args.frames:
+        width, height, rows = read_png(path)
+        if size and size != (width, height):
+            print(f'{path}: {width}x{height}, os outros quadros são {size[0]}x{size[1]}', file=sys.stderr)
+            return 1
+        if width > 128 or height > 64 or height % 8:
+            print(f'{path}: {width}x{height} não cabe no display ou não é múltiplo de 8 na altura', file=sys.stderr)
+            return 1
+        size = (width, height)
+
+        pages = to_pages(width, height, rows)
+        frame = bytes([FRAME_KEY]) + rle(pages)
+        if previous is not None:
+            delta = bytes([FRAME_DELTA]) + rle(bytes(a ^ b for a, b in zip(pages, previous)))
+            if len(delta) < len(frame):
+                frame = delta
+        encoded.append(frame)
+        previous = pages
+
+    data = b''.join(encoded)
+    raw_size = len(encoded) * size[0] * size[1] // 8
+    guard = f'{args.name}_anim_inc_h'
+    with open(args.output, 'w') as f:
+        f.write('#include "anim.h"\n\n')
+        f.write(f'#ifndef {guard}\n#define {guard}\n\n')
+        f.write(f'// Gerado por tools/anim_convert.py a partir de {len(encoded)} quadros {size[0]}x{size[1]}: '
+                f'{len(data)} bytes ({raw_size} sem compressão)\n')
+        f.write(f'static const uint8_t {args.name}_anim_data[] = {{\n')
+        for i in range(0, len(data), 16):
+            f.write('    ' + ' '.join(f'0x{b:02x},' for b in data[i:i + 16]) + '\n')
+        f.write('};\n\n')
+        f.write(f'static const anim_t {args.name}_anim = {{\n')
+        f.write(f'    .data = {args.name}_anim_data,\n')
+        f.write(f'    .frame_count = {len(encoded)},\n')
+        f.write(f'    .frame_ms = {args.frame_ms},\n')
+        f.write(f'    .width = {size[0]},\n')
+        f.write(f'    .pages = {size[1] // 8},\n')
+        f.write('};\n\n#endif\n')
+
+    kinds = ''.join('K' if e[0] == FRAME_KEY else 'D' for e in encoded)
+    print(f'{len(encoded)} quadros ({kinds}), {len(data)} bytes de {raw_size} -> {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
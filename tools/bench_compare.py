@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Compara duas tabelas do microphone_dma_bench (host ou placa).
+
+Uso: bench_compare.py base.tsv novo.tsv [--threshold 10]
+
+Para cada caso, usa a mediana das medianas de todas as passadas do arquivo e mostra a
+variação do novo em relação à base. Sai com código 1 se algum caso ficou mais lento que
+o limite (em %), para uso em CI.
+"""
+import argparse
+import statistics
+import sys
+
+
+def load(path):
+    results = {}
+    platform = None
+    with open(path) as f:
+        for line in f:
+            line = line.rstrip('\n')
+            if line.startswith('# sacd-bench'):
+                for field in line.split()[2:]:
+                    key, _, value = field.partition('=')
+                    if key == 'platform':
+                        platform = value
+                continue
+            if not line or line.startswith('#') or line.startswith('name\t'):
+                continue
+            cols = line.split('\t')
+            results.setdefault(cols[0], []).append(int(cols[3]))
+    return platform, {name: statistics.median(v) for name, v in results.items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('base')
+    parser.add_argument('new')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='regressão máxima aceita, em %% (padrão 10)')
+    args = parser.parse_args()
+
+    base_platform, base = load(args.base)
+    new_platform, new = load(args.new)
+    if base_platform != new_platform:
+        print(f'aviso: plataformas diferentes ({base_platform} x {new_platform})', file=sys.stderr)
+
+    regressions = 0
+    print(f'{"caso":28} {"base_ns":>10} {"novo_ns":>10} {"var":>8}')
+    for name in sorted(set(base) | set(new)):
+        if name not in base or name not in new:
+            print(f'{name:28} {"-" if name not in base else base[name]:>10} '
+                  f'{"-" if name not in new else new[name]:>10}')
+            continue
+        b, n = base[name], new[name]
+        change = (n - b) * 100.0 / b if b else 0.0
+        mark = ''
+        if change > args.threshold:
+            mark = '  REGRESSAO'
+            regressions += 1
+        print(f'{name:28} {b:>10.0f} {n:>10.0f} {change:>+7.1f}%{mark}')
+
+    return 1 if regressions else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
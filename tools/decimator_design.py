@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""Projeta o FIR de compensação do decimador do ADC e mostra a resposta em frequência.
+
+Uso: decimator_design.py [--ratio 4] [--order 4] [--taps 31] [--rate 16000]
+
+O ADC amostra a rate * ratio * 2; o CIC (ordem --order) decima por --ratio e o FIR,
+que decima por 2, corrige a queda do CIC na banda passante e corta o que dobraria
+para dentro dela. Imprime a tabela em Q15 para inc/decimator.c e a resposta do
+conjunto (CIC + FIR) em alguns pontos, incluindo a rejeição das frequências que
+aparecem como alias depois da decimação. Só usa a biblioteca padrão.
+"""
+import argparse
+import math
+
+
+def cic_gain(f, fs_in, ratio, order):
+    """Ganho normalizado (1 em DC) do CIC na frequência f."""
+    x = math.pi * f / fs_in
+    if x == 0:
+        return 1.0
+    return abs(math.sin(ratio * x) / (ratio * math.sin(x))) ** order
+
+
+def fir_gain(h, f, fs):
+    """Resposta de um FIR simétrico de fase linear (número ímpar de taps)."""
+    m = len(h) // 2
+    w = 2 * math.pi * f / fs
+    return abs(h[m] + 2 * sum(h[m + k] * math.cos(k * w) for k in range(1, m + 1)))
+
+
+def solve(a, b):
+    """Eliminação de Gauss com pivoteamento parcial (sistemas pequenos)."""
+    n = len(b)
+    a = [row[:] + [b[i]] for i, row in enumerate(a)]
+    for c in range(n):
+        p = max(range(c, n), key=lambda r: abs(a[r][c]))
+        a[c], a[p] = a[p], a[c]
+        for r in range(c + 1, n):
+            k = a[r][c] / a[c][c]
+            for j in range(c, n + 1):
+                a[r][j] -= k * a[c][j]
+    x = [0.0] * n
+    for r in range(n - 1, -1, -1):
+        x[r] = (a[r][n] - sum(a[r][j] * x[j] for j in range(r + 1, n))) / a[r][r]
+    return x
+
+
+def design(taps, fs, fs_in, ratio, order, f_pass, f_stop, stop_weight):
+    """Mínimos quadrados ponderados: 1/CIC na banda passante, 0 na de rejeição."""
+    m = taps // 2
+    grid = []
+    for i in range(400):
+        f = f_pass * i / 399
+        grid.append((f, 1.0 / cic_gain(f, fs_in, ratio, order), 1.0))
+    for i in range(400):
+        f = f_stop + (fs / 2 - f_stop) * i / 399
+        grid.append((f, 0.0, stop_weight))
+
+    # Incógnitas: a_0 = h[m], a_k = 2 h[m + k]; H(w) = sum a_k cos(k w)
+    ata = [[0.0] * (m + 1) for _ in range(m + 1)]
+    atb = [0.0] * (m + 1)
+    for f, d, wgt in grid:
+        w = 2 * math.pi * f / fs
+        basis = [math.cos(k * w) for k in range(m + 1)]
+        for i in range(m + 1):
+            atb[i] += wgt * basis[i] * d
+            for j in range(m + 1):
+                ata[i][j] += wgt * basis[i] * basis[j]
+    a = solve(ata, atb)
+
+    h = [0.0] * taps
+    h[m] = a[0]
+    for k in range(1, m + 1):
+        h[m + k] = h[m - k] = a[k] / 2
+    return h
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('--ratio', type=int, default=4, help='decimação do CIC')
+    parser.add_argument('--order', type=int, default=4, help='ordem do CIC')
+    parser.add_argument('--taps', type=int, default=31, help='taps do FIR (ímpar)')
+    parser.add_argument('--rate', type=int, default=16000, help='taxa de saída (Hz)')
+    args = parser.parse_args()
+
+    fs = 2 * args.rate  # Taxa do FIR (saída do CIC)
+    fs_in = fs * args.ratio  # Taxa do ADC
+    f_pass = 0.375 * args.rate  # 6 kHz a 16 kHz
+    f_stop = 0.625 * args.rate  # Tudo acima dobra para fora da banda passante
+    h = design(args.taps, fs, fs_in, args.ratio, args.order, f_pass, f_stop, 20.0)
+
+    q15 = [round(c * 32768) for c in h]
+    print(f'// {args.taps} taps, ADC a {fs_in} Hz, CIC ordem {args.order} / {args.ratio}, FIR / 2 -> {args.rate} Hz')
+    for i in range(0, len(q15), 12):
+        print('    ' + ' '.join(f'{c},' for c in q15[i:i + 12]))
+
+    hq = [c / 32768 for c in q15]
+    print('\nResposta (CIC + FIR com os coeficientes em Q15)')
+    print(f'{"Hz":>7} {"dB":>8}')
+    for f in [0, 500, 1000, 2000, 3000, 4000, 5000, 6000, 7000, 8000]:
+        g = cic_gain(f, fs_in, args.ratio, args.order) * fir_gain(hq, f, fs)
+        print(f'{f:>7} {20 * math.log10(max(g, 1e-9)):>8.2f}')
+
+    ripple = [cic_gain(f, fs_in, args.ratio, args.order) * fir_gain(hq, f, fs)
+              for f in [f_pass * i / 100 for i in range(101)]]
+    print(f'\nondulação na banda 0-{f_pass:.0f} Hz: '
+          f'{20 * math.log10(max(ripple)):+.2f} / {20 * math.log10(min(ripple)):+.2f} dB')
+
+    # Pior alias: frequências que caem na banda passante depois de decimar para 'rate'
+    worst = 0.0
+    for i in range(2000):
+        f = f_stop + (fs_in / 2 - f_stop) * i / 1999
+        alias = abs((f + args.rate / 2) % args.rate - args.rate / 2)
+        if alias <= f_pass:
+            g = cic_gain(f, fs_in, args.ratio, args.order) * (fir_gain(hq, f % fs, fs) if f % fs <= fs / 2
+                                                              else fir_gain(hq, fs - f % fs, fs))
+            worst = max(worst, g)
+    print(f'rejeição de alias para a banda passante: {20 * math.log10(max(worst, 1e-9)):.1f} dB')
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+"""Gera as tabelas da matriz de LEDs (inc/led_tables.h): gama e ordem serpentina.
+
+Uso: led_tables.py [-o inc/led_tables.h] [--width 5] [--height 5] [--gamma 2.2] [--max 8] [--snap 0.05]
+
+A tabela de gama leva o brilho percebido (0 a 255) ao nível do PWM dos LEDs em Q8.8, de 0
+a --max: a parte inteira é o nível enviado e a fração é o que o pontilhamento temporal de
+inc/led_anim.c acumula de um quadro para o outro. Com um teto baixo (os LEDs são fortes
+demais de perto) restam poucos níveis inteiros; a fração dá os intermediários. Um brilho a
+menos de --snap de um nível inteiro (a partir de 1) fica exatamente nele: sem fração, um quadro parado não
+precisa ser repetido para o pontilhamento, e os LEDs podem ficar sem quadros novos.
+
+A ordem serpentina leva a posição lógica (linha a linha, da esquerda para a direita) ao
+índice do LED na fita, que volta da direita para a esquerda nas linhas ímpares. Só usa a
+biblioteca padrão.
+"""
+import argparse
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('-o', '--output', default='inc/led_tables.h', help='header C a gravar')
+    parser.add_argument('--width', type=int, default=5, help='colunas da matriz')
+    parser.add_argument('--height', type=int, default=5, help='linhas da matriz')
+    parser.add_argument('--gamma', type=float, default=2.2, help='expoente da curva de gama')
+    parser.add_argument('--max', type=int, default=8, help='nível do PWM no brilho máximo (1 a 255)')
+    parser.add_argument('--snap', type=float, default=0.05, help='distância (em níveis) até um inteiro que vira o inteiro')
+    args = parser.parse_args()
+
+    gamma = [round(args.max * 256 * (v / 255) ** args.gamma) for v in range(256)]
+    gamma = [round(g / 256) * 256 if g >= 128 and abs(g / 256 - round(g / 256)) < args.snap else g for g in gamma]
+    serpentine = []
+    for y in range(args.height):
+        for x in range(args.width):
+            serpentine.append(y * args.width + (args.width - 1 - x if y % 2 else x))
+
+    with open(args.output, 'w') as f:
+        f.write('#include <stdint.h>\n\n')
+        f.write('#ifndef led_tables_inc_h\n#define led_tables_inc_h\n\n')
+        f.write(f'// Gerado por tools/led_tables.py (--width {args.width} --height {args.height} '
+                f'--gamma {args.gamma} --max {args.max} --snap {args.snap})\n')
+        f.write(f'#define LED_TABLE_WIDTH {args.width}\n')
+        f.write(f'#define LED_TABLE_HEIGHT {args.height}\n')
+        f.write(f'#define LED_TABLE_PIXELS {args.width * args.height}\n\n')
+        f.write(f'// Brilho percebido -> nível do PWM em Q8.8 (gama {args.gamma}, teto {args.max}, '
+                f'inteiros a menos de {args.snap})\n')
+        f.write('static const uint16_t led_gamma_q8[256] = {\n')
+        for i in range(0, 256, 16):
+            f.write('    ' + ' '.join(f'{g},' for g in gamma[i:i + 16]) + '\n')
+        f.write('};\n\n')
+        f.write('// Posição lógica (linha a linha) -> índice do LED na fita\n')
+        f.write(f'static const uint8_t led_serpentine[{len(serpentine)}] = {{\n')
+        for i in range(0, len(serpentine), args.width):
+            f.write('    ' + ' '.join(f'{s},' for s in serpentine[i:i + args.width]) + '\n')
+        f.write('};\n\n#endif\n')
+
+    levels = len(set(g >> 8 for g in gamma))
+    print(f'{levels} níveis inteiros, {len(set(gamma))} com o pontilhamento -> {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Decodifica o rastreio binário (linhas "#T<hex>") capturado da USB ou do simulador.
+
+Uso: trace_decode.py captura.txt [-o trace.json]
+
+Mostra um histograma de latência por etapa (pares BEGIN/END) e os intervalos entre
+eventos instantâneos; com -o, grava uma linha do tempo no formato Chrome trace,
+que abre em chrome://tracing ou no Perfetto (ui.perfetto.dev).
+Outras linhas da captura (printf do firmware) são ignoradas.
+"""
+import argparse
+import json
+import struct
+import sys
+
+# Mantido em sincronia com inc/trace.h
+NAMES = {
+    1: 'adc_block',
+    2: 'audio_block',
+    3: 'rms',
+    4: 'whistle',
+    5: 'dispatch',
+    6: 'led_write',
+    7: 'led_done',
+    8: 'oled_flush',
+    9: 'oled_done',
+    10: 'sound_level',
+    11: 'intensity',
+    12: 'fft',
+}
+EVENT_NAMES = {1: 'audio', 2: 'button', 3: 'flush_done', 4: 'timer', 5: 'tick'}
+PH_BEGIN, PH_END, PH_INSTANT, PH_COUNTER = range(4)
+PH_CORE1 = 0x80
+RECORD = struct.Struct('<IBBHI')
+
+
+def read_records(path):
+    """Registros na ordem de chegada, com o tempo de 32 bits desembrulhado por core."""
+    last = {}
+    offset = {}
+    with open(path, errors='replace') as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith('#T'):
+                continue
+            try:
+                data = bytes.fromhex(line[2:])
+            except ValueError:
+                continue  # Linha truncada ou misturada com outra saída
+            for i in range(0, len(data) - RECORD.size + 1, RECORD.size):
+                ts, ident, phase, arg, value = RECORD.unpack_from(data, i)
+                core = 1 if phase & PH_CORE1 else 0
+                if core in last and ts < last[core]:
+                    offset[core] = offset.get(core, 0) + (1 << 32)
+                last[core] = ts
+                yield ts + offset.get(core, 0), core, ident, phase & 3, arg, value
+
+
+def span_name(ident, arg):
+    name = NAMES.get(ident, f'id{ident}')
+    if name == 'dispatch':
+        name += ':' + EVENT_NAMES.get(arg, str(arg))
+    return name
+
+
+def percentile(values, p):
+    return values[min(len(values) - 1, int(len(values) * p / 100))]
+
+
+def histogram(title, values):
+    values.sort()
+    print(f'{title}: n={len(values)} min={values[0]} p50={percentile(values, 50)} '
+          f'p99={percentile(values, 99)} max={values[-1]} us')
+    # Faixas em potências de 2
+    buckets = {}
+    for v in values:
+        b = max(1, v).bit_length()
+        buckets[b] = buckets.get(b, 0) + 1
+    peak = max(buckets.values())
+    for b in sorted(buckets):
+        lo, hi = (1 << (b - 1)) if b > 1 else 0, (1 << b) - 1
+        bar = '#' * max(1, buckets[b] * 40 // peak)
+        print(f'  {lo:>7}-{hi:<7} {buckets[b]:>7} {bar}')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('capture')
+    parser.add_argument('-o', '--output', help='arquivo JSON (Chrome trace) a gravar')
+    args = parser.parse_args()
+
+    records = sorted(read_records(args.capture), key=lambda r: r[0])
+    if not records:
+        print('nenhum registro "#T" na captura', file=sys.stderr)
+        return 1
+
+    open_spans = {}
+    spans = {}
+    last_instant = {}
+    intervals = {}
+    events = []
+    arg_of = {}
+
+    for ts, core, ident, phase, arg, value in records:
+        key = (core, ident)
+        if phase == PH_BEGIN:
+            open_spans.setdefault(key, []).append(ts)
+            arg_of[key] = arg
+            events.append({'name': span_name(ident, arg), 'ph': 'B', 'ts': ts, 'pid': 0, 'tid': core})
+        elif phase == PH_END:
+            stack = open_spans.get(key)
+            if not stack:
+                continue  # BEGIN perdido (anel cheio ou captura iniciada no meio)
+            start = stack.pop()
+            spans.setdefault(span_name(ident, arg_of.get(key, 0)), []).append(ts - start)
+            events.append({'name': span_name(ident, arg_of.get(key, 0)), 'ph': 'E', 'ts': ts,
+                           'pid': 0, 'tid': core, 'args': {'value': value}})
+        elif phase == PH_INSTANT:
+            name = NAMES.get(ident, f'id{ident}')
+            if key in last_instant:
+                intervals.setdefault(name, []).append(ts - last_instant[key])
+            last_instant[key] = ts
+            events.append({'name': name, 'ph': 'i', 's': 't', 'ts': ts, 'pid': 0, 'tid': core,
+                           'args': {'arg': arg, 'value': value}})
+        else:
+            name = NAMES.get(ident, f'id{ident}')
+            events.append({'name': name, 'ph': 'C', 'ts': ts, 'pid': 0, 'args': {name: value}})
+
+    print(f'{len(records)} registros, {(records[-1][0] - records[0][0]) / 1e6:.3f} s\n')
+    print('Duração por etapa')
+    for name in sorted(spans):
+        histogram(name, spans[name])
+    print('\nIntervalo entre eventos')
+    for name in sorted(intervals):
+        histogram(name, intervals[name])
+
+    if args.output:
+        meta = [{'name': 'thread_name', 'ph': 'M', 'pid': 0, 'tid': c, 'args': {'name': f'core{c}'}}
+                for c in (0, 1)]
+        with open(args.output, 'w') as f:
+            json.dump({'traceEvents': meta + events, 'displayTimeUnit': 'ms'}, f)
+        print(f'\nlinha do tempo gravada em {args.output}')
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())